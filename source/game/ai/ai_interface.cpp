@@ -1174,8 +1174,15 @@ namespace Game {
 			} else {
 				const Map *
 					map = world->getMap();
+				int
+					typeIndex = map->getResourceBucketTypeIndex(rt);
 				for (int i = 0; i < map->getW(); ++i) {
 					for (int j = 0; j < map->getH(); ++j) {
+						// skip squares of the map holding none of this resource
+						if (map->hasResourcesInBucket(i, j, typeIndex) == false) {
+							j = Map::getUnitBucketLastCoord(j);
+							continue;
+						}
 						Vec2i
 							resPos = Vec2i(i, j);
 						Vec2i
@@ -0,0 +1,483 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#include "cluster_map.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+#include "map.h"
+#include "platform_common.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Graphics;
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+namespace Game {
+	// =====================================================
+	//      class ClusterMap
+	// =====================================================
+
+	const int ClusterMap::clusterSize = 16;
+	const int ClusterMap::costStraight = 10;
+	const int ClusterMap::costDiagonal = 14;
+	const int ClusterMap::portalSplitLength = 6;
+
+	ClusterMap::ClusterMap() : mutex(new Mutex(CODE_AT_LINE)) {
+		map = NULL;
+		clustersW = 0;
+		clustersH = 0;
+	}
+
+	ClusterMap::~ClusterMap() {
+		clear();
+		map = NULL;
+
+		delete mutex;
+		mutex = NULL;
+	}
+
+	void ClusterMap::init(const Map *map) {
+		clear();
+
+		this->map = map;
+		clustersW = (map->getW() + clusterSize - 1) / clusterSize;
+		clustersH = (map->getH() + clusterSize - 1) / clusterSize;
+	}
+
+	void ClusterMap::clear() {
+		MutexSafeWrapper safeMutex(mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+		for (Layers::iterator iterMap = layers.begin(); iterMap != layers.end(); ++iterMap) {
+			delete iterMap->second;
+		}
+		layers.clear();
+	}
+
+	// Marks every cluster whose portals or costs could depend on the changed
+	// cells, the clusters are rebuilt the next time the layer is used
+	void ClusterMap::staticCellsChanged(const Vec2i &pos, int size) {
+		if (map == NULL || clustersW <= 0 || clustersH <= 0) {
+			return;
+		}
+
+		MutexSafeWrapper safeMutex(mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+		for (Layers::iterator iterMap = layers.begin(); iterMap != layers.end(); ++iterMap) {
+			Layer *layer = iterMap->second;
+
+			Vec2i topLeft(max(pos.x - (layer->size - 1), 0), max(pos.y - (layer->size - 1), 0));
+			Vec2i bottomRight(min(pos.x + size - 1, map->getW() - 1), min(pos.y + size - 1, map->getH() - 1));
+			if (topLeft.x > bottomRight.x || topLeft.y > bottomRight.y) {
+				continue;
+			}
+
+			for (int y = topLeft.y / clusterSize; y <= bottomRight.y / clusterSize; ++y) {
+				for (int x = topLeft.x / clusterSize; x <= bottomRight.x / clusterSize; ++x) {
+					layer->clusters[y * clustersW + x].dirty = true;
+				}
+			}
+			layer->dirty = true;
+		}
+	}
+
+	// Searches the abstract graph, on success waypoints holds the portal
+	// positions to pass through followed by the destination itself
+	bool ClusterMap::findAbstractPath(Field field, int size, const Vec2i &from, const Vec2i &to, vector<Vec2i> &waypoints) {
+		waypoints.clear();
+
+		if (map == NULL || clustersW <= 0 || clustersH <= 0 ||
+			map->isInside(from) == false || map->isInside(to) == false) {
+			return false;
+		}
+
+		int startCluster = getClusterIndex(from);
+		int goalCluster = getClusterIndex(to);
+		if (startCluster == goalCluster) {
+			return false;
+		}
+
+		// The lock is held for the whole search, another thread asking for
+		// the same layer would rebuild the dirty clusters whose portals are
+		// read below
+		MutexSafeWrapper safeMutex(mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+		Layer *layer = getLayer(field, size);
+
+		if (isPassable(layer, from) == false || isPassable(layer, to) == false) {
+			return false;
+		}
+
+		vector<int> startCosts;
+		vector<int> goalCosts;
+		searchCluster(layer, startCluster, from, startCosts);
+		searchCluster(layer, goalCluster, to, goalCosts);
+
+		// number the portals of all clusters, the last node is the destination
+		int clusterCount = (int) layer->clusters.size();
+		vector<int> offsets(clusterCount + 1, 0);
+		for (int index = 0; index < clusterCount; ++index) {
+			offsets[index + 1] = offsets[index] + (int) layer->clusters[index].portals.size();
+		}
+		int nodeCount = offsets[clusterCount];
+		int goalNode = nodeCount;
+
+		vector<int> nodeCluster(nodeCount);
+		for (int index = 0; index < clusterCount; ++index) {
+			for (int nodeIndex = offsets[index]; nodeIndex < offsets[index + 1]; ++nodeIndex) {
+				nodeCluster[nodeIndex] = index;
+			}
+		}
+
+		vector<int> costs(nodeCount + 1, -1);
+		vector<int> parents(nodeCount + 1, -1);
+		vector<bool> closed(nodeCount + 1, false);
+
+		// ties are resolved by the node index so the result is always the same
+		typedef std::pair<int, int> OpenEntry;
+		std::priority_queue<OpenEntry, vector<OpenEntry>, std::greater<OpenEntry> > openList;
+
+		const Cluster &fromCluster = layer->clusters[startCluster];
+		for (unsigned int index = 0; index < fromCluster.portals.size(); ++index) {
+			const Portal &portal = fromCluster.portals[index];
+			int cost = startCosts[getCellIndex(startCluster, portal.pos)];
+			if (cost >= 0) {
+				int node = offsets[startCluster] + index;
+				costs[node] = cost;
+				openList.push(OpenEntry(cost + octileDistance(portal.pos, to), node));
+			}
+		}
+
+		bool pathFound = false;
+		while (openList.empty() == false) {
+			int node = openList.top().second;
+			openList.pop();
+
+			if (closed[node] == true) {
+				continue;
+			}
+			closed[node] = true;
+
+			if (node == goalNode) {
+				pathFound = true;
+				break;
+			}
+
+			int clusterIndex = nodeCluster[node];
+			const Portal &portal = layer->clusters[clusterIndex].portals[node - offsets[clusterIndex]];
+			int nodeCost = costs[node];
+
+			if (clusterIndex == goalCluster) {
+				int cost = goalCosts[getCellIndex(goalCluster, portal.pos)];
+				if (cost >= 0 && closed[goalNode] == false &&
+					(costs[goalNode] < 0 || nodeCost + cost < costs[goalNode])) {
+					costs[goalNode] = nodeCost + cost;
+					parents[goalNode] = node;
+					openList.push(OpenEntry(costs[goalNode], goalNode));
+				}
+			}
+
+			for (unsigned int index = 0; index < portal.edges.size(); ++index) {
+				int nextNode = offsets[clusterIndex] + portal.edges[index].first;
+				int nextCost = nodeCost + portal.edges[index].second;
+				if (closed[nextNode] == false && (costs[nextNode] < 0 || nextCost < costs[nextNode])) {
+					costs[nextNode] = nextCost;
+					parents[nextNode] = node;
+					const Portal &nextPortal = layer->clusters[clusterIndex].portals[portal.edges[index].first];
+					openList.push(OpenEntry(nextCost + octileDistance(nextPortal.pos, to), nextNode));
+				}
+			}
+
+			if (portal.linkPortal >= 0) {
+				int nextNode = offsets[portal.linkCluster] + portal.linkPortal;
+				int nextCost = nodeCost + costStraight;
+				if (closed[nextNode] == false && (costs[nextNode] < 0 || nextCost < costs[nextNode])) {
+					costs[nextNode] = nextCost;
+					parents[nextNode] = node;
+					openList.push(OpenEntry(nextCost + octileDistance(portal.linkPos, to), nextNode));
+				}
+			}
+		}
+
+		if (pathFound == false) {
+			return false;
+		}
+
+		for (int node = parents[goalNode]; node >= 0; node = parents[node]) {
+			int clusterIndex = nodeCluster[node];
+			waypoints.push_back(layer->clusters[clusterIndex].portals[node - offsets[clusterIndex]].pos);
+		}
+		std::reverse(waypoints.begin(), waypoints.end());
+		waypoints.push_back(to);
+
+		return true;
+	}
+
+	// ==================== PRIVATE ====================
+
+	ClusterMap::Layer * ClusterMap::getLayer(Field field, int size) {
+		int key = (static_cast<int>(field) << 8) | size;
+
+		Layer *layer = NULL;
+		Layers::iterator iterFind = layers.find(key);
+		if (iterFind == layers.end()) {
+			layer = new Layer(field, size);
+			layer->clusters.resize(clustersW * clustersH);
+			layers[key] = layer;
+		} else {
+			layer = iterFind->second;
+		}
+
+		if (layer->dirty == true) {
+			rebuildLayer(layer);
+		}
+		return layer;
+	}
+
+	void ClusterMap::rebuildLayer(Layer *layer) {
+		int clusterCount = (int) layer->clusters.size();
+
+		// portals on a shared border belong to both clusters, so the
+		// neighbours of a changed cluster need their portals rebuilt too
+		vector<bool> rebuild(clusterCount, false);
+		for (int index = 0; index < clusterCount; ++index) {
+			if (layer->clusters[index].dirty == true) {
+				int x = index % clustersW;
+				int y = index / clustersW;
+				rebuild[index] = true;
+				if (x > 0) rebuild[index - 1] = true;
+				if (x + 1 < clustersW) rebuild[index + 1] = true;
+				if (y > 0) rebuild[index - clustersW] = true;
+				if (y + 1 < clustersH) rebuild[index + clustersW] = true;
+			}
+		}
+
+		vector<bool> relink(clusterCount, false);
+		for (int index = 0; index < clusterCount; ++index) {
+			if (rebuild[index] == true) {
+				rebuildPortals(layer, index);
+				rebuildEdges(layer, index);
+
+				int x = index % clustersW;
+				int y = index / clustersW;
+				relink[index] = true;
+				if (x > 0) relink[index - 1] = true;
+				if (x + 1 < clustersW) relink[index + 1] = true;
+				if (y > 0) relink[index - clustersW] = true;
+				if (y + 1 < clustersH) relink[index + clustersW] = true;
+			}
+		}
+
+		for (int index = 0; index < clusterCount; ++index) {
+			if (relink[index] == true) {
+				linkPortals(layer, index);
+			}
+			layer->clusters[index].dirty = false;
+		}
+		layer->dirty = false;
+	}
+
+	void ClusterMap::rebuildPortals(Layer *layer, int clusterIndex) {
+		Cluster &cluster = layer->clusters[clusterIndex];
+		cluster.portals.clear();
+
+		Vec2i topLeft;
+		Vec2i bottomRight;
+		getClusterBounds(clusterIndex, topLeft, bottomRight);
+
+		int width = bottomRight.x - topLeft.x + 1;
+		int height = bottomRight.y - topLeft.y + 1;
+		int x = clusterIndex % clustersW;
+		int y = clusterIndex / clustersW;
+
+		if (y > 0) {
+			addBorderPortals(layer, cluster, topLeft, Vec2i(1, 0), Vec2i(0, -1), width);
+		}
+		if (x > 0) {
+			addBorderPortals(layer, cluster, topLeft, Vec2i(0, 1), Vec2i(-1, 0), height);
+		}
+		if (x + 1 < clustersW) {
+			addBorderPortals(layer, cluster, Vec2i(bottomRight.x, topLeft.y), Vec2i(0, 1), Vec2i(1, 0), height);
+		}
+		if (y + 1 < clustersH) {
+			addBorderPortals(layer, cluster, Vec2i(topLeft.x, bottomRight.y), Vec2i(1, 0), Vec2i(0, 1), width);
+		}
+	}
+
+	// Both clusters scan a shared border in the same direction, so they
+	// agree on where the portals of every open stretch are placed
+	void ClusterMap::addBorderPortals(Layer *layer, Cluster &cluster, const Vec2i &start, const Vec2i &step, const Vec2i &outside, int length) {
+		int runStart = -1;
+		for (int index = 0; index <= length; ++index) {
+			bool open = false;
+			if (index < length) {
+				Vec2i pos = start + step * index;
+				open = isPassable(layer, pos) && isPassable(layer, pos + outside);
+			}
+
+			if (open == true && runStart < 0) {
+				runStart = index;
+			} else if (open == false && runStart >= 0) {
+				int runEnd = index - 1;
+				vector<int> portalIndexes;
+				if (runEnd - runStart + 1 >= portalSplitLength) {
+					portalIndexes.push_back(runStart);
+					portalIndexes.push_back(runEnd);
+				} else {
+					portalIndexes.push_back((runStart + runEnd) / 2);
+				}
+
+				for (unsigned int portalIndex = 0; portalIndex < portalIndexes.size(); ++portalIndex) {
+					Portal portal;
+					portal.pos = start + step * portalIndexes[portalIndex];
+					portal.linkPos = portal.pos + outside;
+					cluster.portals.push_back(portal);
+				}
+				runStart = -1;
+			}
+		}
+	}
+
+	void ClusterMap::rebuildEdges(Layer *layer, int clusterIndex) {
+		Cluster &cluster = layer->clusters[clusterIndex];
+
+		vector<int> costs;
+		for (unsigned int index = 0; index < cluster.portals.size(); ++index) {
+			Portal &portal = cluster.portals[index];
+			portal.edges.clear();
+
+			searchCluster(layer, clusterIndex, portal.pos, costs);
+			for (unsigned int otherIndex = 0; otherIndex < cluster.portals.size(); ++otherIndex) {
+				if (otherIndex != index) {
+					int cost = costs[getCellIndex(clusterIndex, cluster.portals[otherIndex].pos)];
+					if (cost >= 0) {
+						portal.edges.push_back(std::make_pair((int) otherIndex, cost));
+					}
+				}
+			}
+		}
+	}
+
+	void ClusterMap::linkPortals(Layer *layer, int clusterIndex) {
+		Cluster &cluster = layer->clusters[clusterIndex];
+		for (unsigned int index = 0; index < cluster.portals.size(); ++index) {
+			Portal &portal = cluster.portals[index];
+			portal.linkCluster = getClusterIndex(portal.linkPos);
+			portal.linkPortal = -1;
+
+			const Cluster &linkCluster = layer->clusters[portal.linkCluster];
+			for (unsigned int linkIndex = 0; linkIndex < linkCluster.portals.size(); ++linkIndex) {
+				if (linkCluster.portals[linkIndex].pos == portal.linkPos) {
+					portal.linkPortal = linkIndex;
+					break;
+				}
+			}
+		}
+	}
+
+	// Dijkstra restricted to one cluster, costs holds the cost to reach each
+	// cell of the cluster or -1 for cells which can't be reached
+	void ClusterMap::searchCluster(const Layer *layer, int clusterIndex, const Vec2i &from, vector<int> &costs) const {
+		costs.assign(clusterSize * clusterSize, -1);
+
+		Vec2i topLeft;
+		Vec2i bottomRight;
+		getClusterBounds(clusterIndex, topLeft, bottomRight);
+
+		vector<char> passable(clusterSize * clusterSize, 0);
+		for (int y = topLeft.y; y <= bottomRight.y; ++y) {
+			for (int x = topLeft.x; x <= bottomRight.x; ++x) {
+				Vec2i pos(x, y);
+				passable[getCellIndex(clusterIndex, pos)] = isPassable(layer, pos);
+			}
+		}
+
+		int fromIndex = getCellIndex(clusterIndex, from);
+		if (passable[fromIndex] == false) {
+			return;
+		}
+
+		typedef std::pair<int, int> OpenEntry;
+		std::priority_queue<OpenEntry, vector<OpenEntry>, std::greater<OpenEntry> > openList;
+		costs[fromIndex] = 0;
+		openList.push(OpenEntry(0, fromIndex));
+
+		while (openList.empty() == false) {
+			int cost = openList.top().first;
+			int cellIndex = openList.top().second;
+			openList.pop();
+			if (cost > costs[cellIndex]) {
+				continue;
+			}
+
+			Vec2i pos(topLeft.x + cellIndex % clusterSize, topLeft.y + cellIndex / clusterSize);
+			for (int i = -1; i <= 1; ++i) {
+				for (int j = -1; j <= 1; ++j) {
+					if (i == 0 && j == 0) {
+						continue;
+					}
+					Vec2i nextPos(pos.x + i, pos.y + j);
+					if (nextPos.x < topLeft.x || nextPos.y < topLeft.y ||
+						nextPos.x > bottomRight.x || nextPos.y > bottomRight.y) {
+						continue;
+					}
+					int nextIndex = getCellIndex(clusterIndex, nextPos);
+					if (passable[nextIndex] == false) {
+						continue;
+					}
+
+					// same rule as Map::aproxCanMove, single cell units can't
+					// cut corners, bigger units only need the cells they end on
+					int nextCost = cost + costStraight;
+					if (i != 0 && j != 0) {
+						if (layer->size == 1 &&
+							(passable[getCellIndex(clusterIndex, Vec2i(pos.x, nextPos.y))] == false ||
+							passable[getCellIndex(clusterIndex, Vec2i(nextPos.x, pos.y))] == false)) {
+							continue;
+						}
+						nextCost = cost + costDiagonal;
+					}
+
+					if (costs[nextIndex] < 0 || nextCost < costs[nextIndex]) {
+						costs[nextIndex] = nextCost;
+						openList.push(OpenEntry(nextCost, nextIndex));
+					}
+				}
+			}
+		}
+	}
+
+	void ClusterMap::getClusterBounds(int clusterIndex, Vec2i &topLeft, Vec2i &bottomRight) const {
+		topLeft.x = (clusterIndex % clustersW) * clusterSize;
+		topLeft.y = (clusterIndex / clustersW) * clusterSize;
+		bottomRight.x = min(topLeft.x + clusterSize, map->getW()) - 1;
+		bottomRight.y = min(topLeft.y + clusterSize, map->getH()) - 1;
+	}
+
+	bool ClusterMap::isPassable(const Layer *layer, const Vec2i &pos) const {
+		return map->isStaticFreeCells(pos, layer->size, layer->field);
+	}
+
+	int ClusterMap::getCellIndex(int clusterIndex, const Vec2i &pos) const {
+		int x = pos.x - (clusterIndex % clustersW) * clusterSize;
+		int y = pos.y - (clusterIndex / clustersW) * clusterSize;
+		return y * clusterSize + x;
+	}
+
+} //end namespace
@@ -0,0 +1,143 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _CLUSTER_MAP_H_
+#define _CLUSTER_MAP_H_
+
+#ifdef WIN32
+#   include <winsock2.h>
+#   include <winsock.h>
+#endif
+
+#include "vec.h"
+#include <vector>
+#include <map>
+#include "skill_type.h"
+#include "thread.h"
+#include "leak_dumper.h"
+
+using std::vector;
+using Shared::Graphics::Vec2i;
+using Shared::Platform::Mutex;
+
+namespace Game {
+	class Map;
+
+	// =====================================================
+	//      class ClusterMap
+	//
+	///     Abstract (HPA*) graph over the map cells. The map is split in
+	///     square clusters, clusters are connected through portals on their
+	///     borders and the cost between the portals of a cluster is cached.
+	///     One graph (layer) is kept per field and unit size, built lazily
+	///     and rebuilt per cluster when the static occupancy changes.
+	// =====================================================
+
+	class ClusterMap {
+	public:
+		static const int clusterSize;
+
+	private:
+		static const int costStraight;
+		static const int costDiagonal;
+		static const int portalSplitLength;
+
+		class Portal {
+		public:
+			Portal() {
+				linkCluster = -1;
+				linkPortal = -1;
+			}
+			Vec2i pos;
+			Vec2i linkPos;
+			int linkCluster;
+			int linkPortal;
+			// portal index in the same cluster and cost to reach it
+			vector<std::pair<int, int> > edges;
+		};
+
+		class Cluster {
+		public:
+			Cluster() {
+				dirty = true;
+			}
+			vector<Portal> portals;
+			bool dirty;
+		};
+
+		class Layer {
+		public:
+			Layer(Field field, int size) {
+				this->field = field;
+				this->size = size;
+				dirty = true;
+			}
+			Field field;
+			int size;
+			vector<Cluster> clusters;
+			bool dirty;
+		};
+
+		typedef std::map<int, Layer *> Layers;
+
+		const Map *map;
+		int clustersW;
+		int clustersH;
+		Layers layers;
+		Mutex *mutex;
+
+	public:
+		ClusterMap();
+		~ClusterMap();
+
+		void init(const Map *map);
+		void clear();
+
+		void staticCellsChanged(const Vec2i &pos, int size);
+		bool findAbstractPath(Field field, int size, const Vec2i &from, const Vec2i &to, vector<Vec2i> &waypoints);
+
+		inline int getClusterIndex(const Vec2i &pos) const {
+			return (pos.y / clusterSize) * clustersW + (pos.x / clusterSize);
+		}
+
+	private:
+		ClusterMap(const ClusterMap &obj);
+		ClusterMap & operator=(const ClusterMap &obj);
+
+		Layer * getLayer(Field field, int size);
+		void rebuildLayer(Layer *layer);
+		void rebuildPortals(Layer *layer, int clusterIndex);
+		void rebuildEdges(Layer *layer, int clusterIndex);
+		void linkPortals(Layer *layer, int clusterIndex);
+		void addBorderPortals(Layer *layer, Cluster &cluster, const Vec2i &start, const Vec2i &step, const Vec2i &outside, int length);
+		void searchCluster(const Layer *layer, int clusterIndex, const Vec2i &from, vector<int> &costs) const;
+		void getClusterBounds(int clusterIndex, Vec2i &topLeft, Vec2i &bottomRight) const;
+		bool isPassable(const Layer *layer, const Vec2i &pos) const;
+		int getCellIndex(int clusterIndex, const Vec2i &pos) const;
+
+		inline static int octileDistance(const Vec2i &pos1, const Vec2i &pos2) {
+			int dx = abs(pos1.x - pos2.x);
+			int dy = abs(pos1.y - pos2.y);
+			return dx < dy ? (costDiagonal * dx + costStraight * (dy - dx)) : (costDiagonal * dy + costStraight * (dx - dy));
+		}
+	};
+
+} //end namespace
+
+#endif
@@ -0,0 +1,249 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#include "flow_field.h"
+
+#include "map.h"
+#include "platform_common.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Graphics;
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+namespace Game {
+
+	// neighbour offsets, the opposite of direction n is always 7 - n
+	static const int flowFieldOffsetX[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+	static const int flowFieldOffsetY[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+	// =====================================================
+	//      class FlowField
+	// =====================================================
+
+	const int FlowField::costStraight = 10;
+	const int FlowField::costDiagonal = 14;
+
+	FlowField::FlowField(const Map *map, Field field, int size, const Vec2i &goal) {
+		this->map = map;
+		this->field = field;
+		this->size = size;
+		this->goal = goal;
+		width = map->getW();
+		height = map->getH();
+
+		int cellCount = width * height;
+		costs.assign(cellCount, -1);
+		directions.assign(cellCount, -1);
+		passable.assign(cellCount, -1);
+		closed.assign(cellCount, false);
+
+		if (map->isInside(goal) == true && isPassable(goal.x, goal.y) == true) {
+			int goalIndex = goal.y * width + goal.x;
+			costs[goalIndex] = 0;
+			openList.push(OpenEntry(0, goalIndex));
+		}
+	}
+
+	// Follows the direction grid from a cell towards the goal, route holds
+	// at most maxSteps positions and doesn't include the starting cell
+	bool FlowField::findRoute(const Vec2i &from, int maxSteps, vector<Vec2i> &route) {
+		route.clear();
+
+		if (map->isInside(from) == false || from == goal) {
+			return false;
+		}
+
+		int cellIndex = from.y * width + from.x;
+		if (expandTo(cellIndex) == false) {
+			return false;
+		}
+
+		Vec2i pos = from;
+		for (int step = 0; step < maxSteps && pos != goal; ++step) {
+			int direction = directions[cellIndex];
+			pos = Vec2i(pos.x + flowFieldOffsetX[direction], pos.y + flowFieldOffsetY[direction]);
+			cellIndex = pos.y * width + pos.x;
+			route.push_back(pos);
+		}
+		return route.empty() == false;
+	}
+
+	// Resumes the search until the cell is settled or nothing is left to
+	// expand. Ties are resolved by the cell index, so the settled costs and
+	// directions don't depend on the order in which routes are requested.
+	bool FlowField::expandTo(int cellIndex) {
+		while (closed[cellIndex] == false && openList.empty() == false) {
+			int cost = openList.top().first;
+			int currentIndex = openList.top().second;
+			openList.pop();
+			if (closed[currentIndex] == true || cost > costs[currentIndex]) {
+				continue;
+			}
+			closed[currentIndex] = true;
+
+			int x = currentIndex % width;
+			int y = currentIndex / width;
+			for (int direction = 0; direction < 8; ++direction) {
+				int nextX = x + flowFieldOffsetX[direction];
+				int nextY = y + flowFieldOffsetY[direction];
+				if (nextX < 0 || nextY < 0 || nextX >= width || nextY >= height) {
+					continue;
+				}
+				int nextIndex = nextY * width + nextX;
+				if (closed[nextIndex] == true || isPassable(nextX, nextY) == false) {
+					continue;
+				}
+
+				// same rule as Map::aproxCanMove, no cutting corners
+				int nextCost = cost + costStraight;
+				if (nextX != x && nextY != y) {
+					if (isPassable(x, nextY) == false || isPassable(nextX, y) == false) {
+						continue;
+					}
+					nextCost = cost + costDiagonal;
+				}
+
+				if (costs[nextIndex] < 0 || nextCost < costs[nextIndex]) {
+					costs[nextIndex] = nextCost;
+					directions[nextIndex] = static_cast<signed char>(7 - direction);
+					openList.push(OpenEntry(nextCost, nextIndex));
+				}
+			}
+		}
+		return closed[cellIndex];
+	}
+
+	// The passable grid is filled as the search goes, only a field that has
+	// looked at one of the cells whose occupancy depends on the changed ones
+	// can hold a stale route. Cells not looked at yet are read when needed.
+	bool FlowField::hasReadCells(const Vec2i &pos, int size) const {
+		int firstX = max(pos.x - (this->size - 1), 0);
+		int firstY = max(pos.y - (this->size - 1), 0);
+		int lastX = min(pos.x + size - 1, width - 1);
+		int lastY = min(pos.y + size - 1, height - 1);
+		for (int y = firstY; y <= lastY; ++y) {
+			for (int x = firstX; x <= lastX; ++x) {
+				if (passable[y * width + x] >= 0) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	bool FlowField::isPassable(int x, int y) {
+		signed char &value = passable[y * width + x];
+		if (value < 0) {
+			value = map->isStaticFreeCells(Vec2i(x, y), size, field) ? 1 : 0;
+		}
+		return value == 1;
+	}
+
+	// =====================================================
+	//      class FlowFieldCache
+	// =====================================================
+
+	const int FlowFieldCache::maxFields = 8;
+
+	FlowFieldCache::FlowFieldCache() : mutex(new Mutex(CODE_AT_LINE)) {
+		map = NULL;
+		useCount = 0;
+	}
+
+	FlowFieldCache::~FlowFieldCache() {
+		clear();
+		map = NULL;
+
+		delete mutex;
+		mutex = NULL;
+	}
+
+	void FlowFieldCache::init(const Map *map) {
+		clear();
+		this->map = map;
+	}
+
+	void FlowFieldCache::clear() {
+		MutexSafeWrapper safeMutex(mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+		clearFields();
+		useCount = 0;
+	}
+
+	void FlowFieldCache::staticCellsChanged(const Vec2i &pos, int size) {
+		MutexSafeWrapper safeMutex(mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+		for (Fields::iterator iterMap = fields.begin(); iterMap != fields.end();) {
+			if (iterMap->second.flowField->hasReadCells(pos, size) == true) {
+				delete iterMap->second.flowField;
+				fields.erase(iterMap++);
+			} else {
+				++iterMap;
+			}
+		}
+	}
+
+	bool FlowFieldCache::findRoute(Field field, int size, const Vec2i &goal, const Vec2i &from, int maxSteps, vector<Vec2i> &route) {
+		route.clear();
+		if (map == NULL || map->isInside(goal) == false) {
+			return false;
+		}
+
+		MutexSafeWrapper safeMutex(mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+
+		FieldKey key(goal, (static_cast<int>(field) << 8) | size);
+		Fields::iterator iterFind = fields.find(key);
+		if (iterFind == fields.end()) {
+			if ((int) fields.size() >= maxFields) {
+				evictLeastRecentlyUsed();
+			}
+			Entry entry;
+			entry.flowField = new FlowField(map, field, size, goal);
+			iterFind = fields.insert(make_pair(key, entry)).first;
+		}
+		iterFind->second.lastUsed = ++useCount;
+
+		return iterFind->second.flowField->findRoute(from, maxSteps, route);
+	}
+
+	// ==================== PRIVATE ====================
+
+	void FlowFieldCache::clearFields() {
+		for (Fields::iterator iterMap = fields.begin(); iterMap != fields.end(); ++iterMap) {
+			delete iterMap->second.flowField;
+		}
+		fields.clear();
+	}
+
+	// ties can't happen as every use gets its own count, the faction's units
+	// use the cache in the same order on every peer
+	void FlowFieldCache::evictLeastRecentlyUsed() {
+		Fields::iterator iterOldest = fields.end();
+		for (Fields::iterator iterMap = fields.begin(); iterMap != fields.end(); ++iterMap) {
+			if (iterOldest == fields.end() || iterMap->second.lastUsed < iterOldest->second.lastUsed) {
+				iterOldest = iterMap;
+			}
+		}
+		if (iterOldest != fields.end()) {
+			delete iterOldest->second.flowField;
+			fields.erase(iterOldest);
+		}
+	}
+
+} //end namespace
@@ -0,0 +1,141 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _FLOW_FIELD_H_
+#define _FLOW_FIELD_H_
+
+#ifdef WIN32
+#   include <winsock2.h>
+#   include <winsock.h>
+#endif
+
+#include "vec.h"
+#include <vector>
+#include <map>
+#include <queue>
+#include <functional>
+#include "skill_type.h"
+#include "thread.h"
+#include "leak_dumper.h"
+
+using std::vector;
+using Shared::Graphics::Vec2i;
+using Shared::Platform::Mutex;
+using Shared::Platform::uint32;
+
+namespace Game {
+	class Map;
+
+	// =====================================================
+	//      class FlowField
+	//
+	///     Integration field and direction grid towards one goal cell for
+	///     one field and unit size. The field is a Dijkstra search started
+	///     at the goal which is only expanded as far as the cells asking
+	///     for a route need, so later requests resume the same search.
+	// =====================================================
+
+	class FlowField {
+	public:
+		static const int costStraight;
+		static const int costDiagonal;
+
+	private:
+		typedef std::pair<int, int> OpenEntry;
+		typedef std::priority_queue<OpenEntry, vector<OpenEntry>, std::greater<OpenEntry> > OpenList;
+
+		const Map *map;
+		Field field;
+		int size;
+		Vec2i goal;
+		int width;
+		int height;
+
+		vector<int> costs;
+		vector<signed char> directions;
+		vector<signed char> passable;
+		vector<bool> closed;
+		OpenList openList;
+
+	public:
+		FlowField(const Map *map, Field field, int size, const Vec2i &goal);
+
+		bool findRoute(const Vec2i &from, int maxSteps, vector<Vec2i> &route);
+		bool hasReadCells(const Vec2i &pos, int size) const;
+
+	private:
+		FlowField(const FlowField &obj);
+		FlowField & operator=(const FlowField &obj);
+
+		bool expandTo(int cellIndex);
+		bool isPassable(int x, int y);
+	};
+
+	// =====================================================
+	//      class FlowFieldCache
+	//
+	///     Keeps the most recently used flow fields, keyed by goal, field
+	///     and unit size. There is one cache per faction so the fields are
+	///     used and evicted in the faction's unit order on every peer. A
+	///     field is dropped when static cells it has looked at change.
+	// =====================================================
+
+	class FlowFieldCache {
+	private:
+		static const int maxFields;
+
+		class Entry {
+		public:
+			Entry() {
+				flowField = NULL;
+				lastUsed = 0;
+			}
+			FlowField *flowField;
+			uint32 lastUsed;
+		};
+
+		typedef std::pair<Vec2i, int> FieldKey;
+		typedef std::map<FieldKey, Entry> Fields;
+
+		const Map *map;
+		Fields fields;
+		uint32 useCount;
+		Mutex *mutex;
+
+	public:
+		FlowFieldCache();
+		~FlowFieldCache();
+
+		void init(const Map *map);
+		void clear();
+
+		void staticCellsChanged(const Vec2i &pos, int size);
+		bool findRoute(Field field, int size, const Vec2i &goal, const Vec2i &from, int maxSteps, vector<Vec2i> &route);
+
+	private:
+		FlowFieldCache(const FlowFieldCache &obj);
+		FlowFieldCache & operator=(const FlowFieldCache &obj);
+
+		void clearFields();
+		void evictLeastRecentlyUsed();
+	};
+
+} //end namespace
+
+#endif
@@ -61,6 +61,14 @@ namespace Game {
 		PathFinder::pathFindExtendRefreshNodeCountMin = 40;
 	const int
 		PathFinder::pathFindExtendRefreshNodeCountMax = 40;
+	const int
+		PathFinder::pathFindHierarchicalMinDistance = ClusterMap::clusterSize + ClusterMap::clusterSize / 2;
+	const int
+		PathFinder::pathFindHierarchicalWaypointMinDistance = ClusterMap::clusterSize / 2;
+	const int
+		PathFinder::pathFindFlowFieldMinDistance = 8;
+	const int
+		PathFinder::pathFindReachableSearchRadius = 32;
 
 	PathFinder::PathFinder() {
 		minorDebugPathfinder = false;
@@ -88,9 +96,16 @@ namespace Game {
 			FactionState & faction = factions.getFactionState(factionIndex);
 
 			faction.nodePool.resize(pathFindNodesAbsoluteMax);
+			faction.openNodesHeap.reserve(pathFindNodesAbsoluteMax);
 			faction.useMaxNodeCount = PathFinder::pathFindNodesMax;
 		}
 		this->map = map;
+		clusterMap.init(map);
+		for (int factionIndex = 0; factionIndex < GameConstants::maxPlayers;
+			++factionIndex) {
+			flowFields[factionIndex].init(map);
+		}
+		reachabilityMap.init(map);
 	}
 
 	void
@@ -126,6 +141,16 @@ namespace Game {
 		}
 	}
 
+	void
+		PathFinder::staticCellsChanged(const Vec2i & pos, int size) {
+		clusterMap.staticCellsChanged(pos, size);
+		for (int factionIndex = 0; factionIndex < GameConstants::maxPlayers;
+			++factionIndex) {
+			flowFields[factionIndex].staticCellsChanged(pos, size);
+		}
+		reachabilityMap.staticCellsChanged(pos, size);
+	}
+
 	void
 		PathFinder::clearUnitPrecache(Unit * unit) {
 		if (unit != NULL && factions.size() > unit->getFactionIndex()) {
@@ -168,7 +193,7 @@ namespace Game {
 
 	TravelState
 		PathFinder::findPath(Unit * unit, const Vec2i & finalPos,
-			bool * wasStuck, int frameIndex) {
+			bool * wasStuck, int frameIndex, bool useFlowField) {
 		TravelState
 			ts = tsImpossible;
 
@@ -367,6 +392,31 @@ namespace Game {
 				return tsBlocked;
 			}
 
+			// a target in another component of the map can never be reached,
+			// head for the closest cell which can be reached instead
+			Vec2i
+				searchTargetPos = finalPos;
+			if (reachabilityMap.findReachablePos(unit->getCurrField(),
+				unit->getType()->getSize(), unit->getPos(), finalPos,
+				pathFindReachableSearchRadius, searchTargetPos) == false) {
+				if (SystemFlags::
+					getSystemSettingType(SystemFlags::debugWorldSynch).enabled ==
+					true && frameIndex < 0) {
+					char
+						szBuf[8096] = "";
+					snprintf(szBuf, 8096,
+						"finalPos [%s] can't be reached from [%s]",
+						finalPos.getString().c_str(),
+						unit->getPos().getString().c_str());
+					unit->logSynchData(extractFileFromDirectoryPath(__FILE__).
+						c_str(), __LINE__, szBuf);
+				}
+				return tsImpossible;
+			}
+			if (searchTargetPos == unit->getPos()) {
+				searchTargetPos = finalPos;
+			}
+
 			//route cache miss
 			int
 				maxNodeCount = -1;
@@ -412,8 +462,8 @@ namespace Game {
 			}
 
 			ts =
-				aStar(unit, finalPos, false, frameIndex, maxNodeCount,
-					&searched_node_count);
+				aStar(unit, searchTargetPos, false, frameIndex, maxNodeCount,
+					&searched_node_count, useFlowField);
 			//post actions
 			switch (ts) {
 				case tsBlocked:
@@ -825,7 +875,7 @@ namespace Game {
 	TravelState
 		PathFinder::aStar(Unit * unit, const Vec2i & targetPos, bool inBailout,
 			int frameIndex, int maxNodeCount,
-			uint32 * searched_node_count) {
+			uint32 * searched_node_count, bool useFlowField) {
 		TravelState
 			ts = tsImpossible;
 
@@ -875,9 +925,7 @@ namespace Game {
 				path = unit->getPath();
 
 			faction.nodePoolCount = 0;
-			faction.openNodesList.clear();
-			faction.openPosList.clear();
-			faction.closedNodesList.clear();
+			faction.beginSearch(map->getW(), map->getH());
 
 			// check the pre-cache to see if we can re-use a cached path
 			if (frameIndex < 0) {
@@ -1047,6 +1095,20 @@ namespace Game {
 					c_str(), __FUNCTION__, __LINE__,
 					chrono.getMillis());
 
+			// units of a group move share one flow field towards the command
+			// position, following it replaces the search until they get close
+			bool
+				tryFlowField = useFlowField == true && inBailout == false &&
+				dist >= pathFindFlowFieldMinDistance;
+
+			// long routes are planned on the cluster graph, the cell search
+			// only has to reach the next portal on the way
+			Vec2i
+				searchPos = finalPos;
+			if (inBailout == false && tryFlowField == false) {
+				searchPos = computeHierarchicalWaypoint(unit, unitPos, finalPos);
+			}
+
 			//path find algorithm
 
 			//a) push starting pos into openNodes
@@ -1060,14 +1122,10 @@ namespace Game {
 			firstNode->next = NULL;
 			firstNode->prev = NULL;
 			firstNode->pos = unitPos;
-			firstNode->heuristic = heuristic(unitPos, finalPos);
+			firstNode->heuristic = heuristic(unitPos, searchPos);
 			firstNode->exploredCell = true;
-			if (faction.openNodesList.find(firstNode->heuristic) ==
-				faction.openNodesList.end()) {
-				faction.openNodesList[firstNode->heuristic].clear();
-			}
-			faction.openNodesList[firstNode->heuristic].push_back(firstNode);
-			faction.openPosList[firstNode->pos] = true;
+			faction.pushOpenNode(firstNode);
+			faction.markPos(firstNode->pos);
 
 			//b) loop
 			bool
@@ -1211,10 +1269,30 @@ namespace Game {
 			std::map < Vec2i, Vec2i > cameFrom;
 			cameFrom[unitPos] = Vec2i(-1, -1);
 
-			// Do the a-star base pathfind work if required
 			int
 				whileLoopCount = 0;
-			if (nodeLimitReached == false) {
+			bool
+				followedFlowField = false;
+			if (nodeLimitReached == false && tryFlowField == true) {
+				followedFlowField =
+					followFlowField(unit, targetPos, firstNode, maxNodeCount,
+						node, whileLoopCount);
+
+				if (followedFlowField == true) {
+					unit->resetPathfindFailedConsecutiveFrameCount();
+					if (searched_node_count != NULL) {
+						*searched_node_count = whileLoopCount;
+					}
+				} else {
+					searchPos = computeHierarchicalWaypoint(unit, unitPos, finalPos);
+					faction.openNodesHeap.clear();
+					firstNode->heuristic = heuristic(unitPos, searchPos);
+					faction.pushOpenNode(firstNode);
+				}
+			}
+
+			// Do the a-star base pathfind work if required
+			if (nodeLimitReached == false && followedFlowField == false) {
 
 				if (SystemFlags::
 					getSystemSettingType(SystemFlags::debugWorldSynch).enabled ==
@@ -1231,7 +1309,7 @@ namespace Game {
 				}
 
 				doAStarPathSearch(nodeLimitReached, whileLoopCount,
-					unitFactionIndex, pathFound, node, finalPos,
+					unitFactionIndex, pathFound, node, searchPos,
 					closedNodes, cameFrom, canAddNode, unit,
 					maxNodeCount, frameIndex);
 
@@ -1305,14 +1383,13 @@ namespace Game {
 			//if consumed all nodes find best node (to avoid strange behaviour)
 			if (nodeLimitReached == true) {
 
-				if (faction.closedNodesList.empty() == false) {
+				if (faction.bestClosedNode != NULL) {
 					float
 						bestHeuristic =
 						truncateDecimal <
-						float >(faction.closedNodesList.begin()->first, 6);
+						float >(faction.bestClosedNode->heuristic, 6);
 					if (lastNode != NULL && bestHeuristic < lastNode->heuristic) {
-						lastNode =
-							faction.closedNodesList.begin()->second.front();
+						lastNode = faction.bestClosedNode;
 					}
 				}
 			}
@@ -1543,9 +1620,8 @@ namespace Game {
 			}
 
 
-			faction.openNodesList.clear();
-			faction.openPosList.clear();
-			faction.closedNodesList.clear();
+			faction.openNodesHeap.clear();
+			faction.bestClosedNode = NULL;
 
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).
 				enabled == true && chrono.getMillis() > 4)
@@ -1656,6 +1732,80 @@ namespace Game {
 
 	}
 
+	Vec2i
+		PathFinder::computeHierarchicalWaypoint(const Unit * unit,
+			const Vec2i & unitPos,
+			const Vec2i & finalPos) {
+		if (SkillType::toActualField(unit->getCurrField()) == fAir ||
+			unitPos.dist(finalPos) < pathFindHierarchicalMinDistance) {
+			return finalPos;
+		}
+
+		vector < Vec2i > waypoints;
+		if (clusterMap.findAbstractPath(unit->getCurrField(),
+			unit->getType()->getSize(), unitPos, finalPos,
+			waypoints) == false) {
+			return finalPos;
+		}
+
+		for (unsigned int index = 0; index < waypoints.size(); ++index) {
+			if (unitPos.dist(waypoints[index]) >=
+				pathFindHierarchicalWaypointMinDistance) {
+				return waypoints[index];
+			}
+		}
+		return finalPos;
+	}
+
+	// Builds the node chain from the shared flow field, the walk stops at the
+	// first cell the unit can't move to soon or at the first unexplored cell
+	// just like the regular search does
+	bool
+		PathFinder::followFlowField(Unit * unit, const Vec2i & targetPos,
+			Node * firstNode, int maxNodeCount, Node * &lastNode,
+			int &stepCount) {
+		stepCount = 0;
+		lastNode = firstNode;
+
+		if (SkillType::toActualField(unit->getCurrField()) == fAir) {
+			return false;
+		}
+
+		vector < Vec2i > route;
+		if (flowFields[unit->getFactionIndex()].findRoute(unit->getCurrField(),
+			unit->getType()->getSize(), targetPos, firstNode->pos,
+			pathFindExtendRefreshNodeCountMax, route) == false) {
+			return false;
+		}
+
+		FactionState & faction = factions.getFactionState(unit->getFactionIndex());
+		for (unsigned int index = 0; index < route.size(); ++index) {
+			if (canUnitMoveSoon(unit, lastNode->pos, route[index]) == false) {
+				break;
+			}
+
+			Node *
+				node = newNode(faction, maxNodeCount);
+			if (node == NULL) {
+				break;
+			}
+			node->pos = route[index];
+			node->heuristic = heuristic(node->pos, targetPos);
+			node->prev = lastNode;
+			node->next = NULL;
+			node->exploredCell =
+				map->getSurfaceCell(Map::toSurfCoords(node->pos))->
+				isExplored(unit->getTeam());
+			lastNode = node;
+			stepCount++;
+
+			if (node->exploredCell == false) {
+				break;
+			}
+		}
+		return stepCount > 0;
+	}
+
 	Vec2i
 		PathFinder::computeNearestFreePos(const Unit * unit, const Vec2i & finalPos, bool useApprox, bool buildingsOnly) {
 		Vec2i
@@ -28,10 +28,15 @@
 #include "vec.h"
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <functional>
 #include "game_constants.h"
 #include "skill_type.h"
 #include "map.h"
 #include "unit.h"
+#include "cluster_map.h"
+#include "flow_field.h"
+#include "reachability_map.h"
 //#include "randomc.h"
 #include "leak_dumper.h"
 
@@ -46,50 +51,8 @@ namespace Game {
 	// =====================================================
 
 	class
-		PathFinder {
+		PathFinder : public MapObserver {
 	public:
-		class
-			BadUnitNodeList {
-		public:
-			BadUnitNodeList() {
-				unitSize = -1;
-				field = fLand;
-			}
-			int
-				unitSize;
-			Field
-				field;
-			std::map <
-				Vec2i,
-				std::map <
-				Vec2i,
-				bool > >
-				badPosList;
-
-			inline bool
-				isPosBad(const Vec2i & pos1, const Vec2i & pos2) {
-				bool
-					result = false;
-
-				std::map <
-					Vec2i,
-					std::map <
-					Vec2i,
-					bool > >::iterator
-					iterFind = badPosList.find(pos1);
-				if (iterFind != badPosList.end()) {
-					std::map < Vec2i, bool >::iterator iterFind2 =
-						iterFind->second.find(pos2);
-					if (iterFind2 != iterFind->second.end()) {
-						result = true;
-					}
-				}
-
-				return
-					result;
-			}
-		};
-
 		class
 			Node {
 		public:
@@ -121,6 +84,27 @@ namespace Game {
 			Node * >
 			Nodes;
 
+		// Entry of the open list binary heap. Nodes are ordered by heuristic and
+		// ties are broken by insertion order, which gives exactly the same
+		// expansion order as the old std::map<float, Nodes> buckets.
+		class
+			OpenNode {
+		public:
+			float
+				heuristic;
+			uint32
+				sequence;
+			Node *
+				node;
+
+			inline bool operator> (const OpenNode & other) const {
+				if (heuristic != other.heuristic) {
+					return heuristic > other.heuristic;
+				}
+				return sequence > other.sequence;
+			}
+		};
+
 		class
 			FactionState {
 		protected:
@@ -132,11 +116,14 @@ namespace Game {
 				//factionMutexPrecache(new Mutex) {
 				factionMutexPrecache(NULL) {                       //, random(factionIndex) {
 
-				openPosList.clear();
-				openNodesList.
-					clear();
-				closedNodesList.
-					clear();
+				openNodesHeap.clear();
+				openNodesSequence = 0;
+				posMarks.clear();
+				posMarksGeneration = 0;
+				posMarksW = 0;
+				posMarksH = 0;
+				bestClosedNode = NULL;
+				closedNodesCount = 0;
 				nodePool.
 					clear();
 				nodePoolCount = 0;
@@ -161,13 +148,93 @@ namespace Game {
 				return factionMutexPrecache;
 			}
 
-			std::map < Vec2i, bool > openPosList;
-			std::map < float,
-				Nodes >
-				openNodesList;
-			std::map < float,
-				Nodes >
-				closedNodesList;
+			// Resets the open / closed state for a new search. Instead of clearing
+			// the map sized position grid we bump the generation stamp, so a cell
+			// is only considered visited if it carries the current generation.
+			void
+				beginSearch(int mapW, int mapH) {
+				if (posMarksW != mapW || posMarksH != mapH) {
+					posMarksW = mapW;
+					posMarksH = mapH;
+					posMarks.assign((size_t) mapW * (size_t) mapH, 0);
+					posMarksGeneration = 0;
+				}
+				posMarksGeneration++;
+				if (posMarksGeneration == 0) {
+					std::fill(posMarks.begin(), posMarks.end(), 0);
+					posMarksGeneration = 1;
+				}
+
+				openNodesHeap.clear();
+				openNodesSequence = 0;
+				bestClosedNode = NULL;
+				closedNodesCount = 0;
+			}
+
+			inline bool
+				isPosMarked(const Vec2i & pos) const {
+				if (pos.x < 0 || pos.y < 0 || pos.x >= posMarksW
+					|| pos.y >= posMarksH) {
+					return false;
+				}
+				return posMarks[pos.y * posMarksW + pos.x] == posMarksGeneration;
+			}
+
+			inline void
+				markPos(const Vec2i & pos) {
+				if (pos.x >= 0 && pos.y >= 0 && pos.x < posMarksW
+					&& pos.y < posMarksH) {
+					posMarks[pos.y * posMarksW + pos.x] = posMarksGeneration;
+				}
+			}
+
+			inline void
+				pushOpenNode(Node * node) {
+				OpenNode
+					entry;
+				entry.heuristic = node->heuristic;
+				entry.sequence = openNodesSequence++;
+				entry.node = node;
+				openNodesHeap.push_back(entry);
+				std::push_heap(openNodesHeap.begin(), openNodesHeap.end(),
+					std::greater < OpenNode >());
+			}
+
+			inline Node *
+				popOpenNode() {
+				std::pop_heap(openNodesHeap.begin(), openNodesHeap.end(),
+					std::greater < OpenNode >());
+				Node *
+					result = openNodesHeap.back().node;
+				openNodesHeap.pop_back();
+				return result;
+			}
+
+			// Only the best closed node is ever needed, the first one closed wins
+			// ties just like the front of the lowest std::map bucket did.
+			inline void
+				addClosedNode(Node * node) {
+				if (bestClosedNode == NULL
+					|| node->heuristic < bestClosedNode->heuristic) {
+					bestClosedNode = node;
+				}
+				closedNodesCount++;
+			}
+
+			std::vector < OpenNode > openNodesHeap;
+			uint32
+				openNodesSequence;
+			std::vector < uint32 > posMarks;
+			uint32
+				posMarksGeneration;
+			int
+				posMarksW;
+			int
+				posMarksH;
+			Node *
+				bestClosedNode;
+			int
+				closedNodesCount;
 			std::vector < Node > nodePool;
 
 			int
@@ -254,10 +321,25 @@ namespace Game {
 			pathFindNodesMax;
 		static const int
 			pathFindNodesAbsoluteMax;
+		static const int
+			pathFindHierarchicalMinDistance;
+		static const int
+			pathFindHierarchicalWaypointMinDistance;
+		static const int
+			pathFindFlowFieldMinDistance;
+		static const int
+			pathFindReachableSearchRadius;
 
 
 		FactionStateManager
 			factions;
+		ClusterMap
+			clusterMap;
+		// one per faction, see FlowFieldCache
+		FlowFieldCache
+			flowFields[GameConstants::maxPlayers];
+		ReachabilityMap
+			reachabilityMap;
 		const Map *
 			map;
 		bool
@@ -284,7 +366,7 @@ namespace Game {
 			init(const Map * map);
 		TravelState
 			findPath(Unit * unit, const Vec2i & finalPos, bool * wasStuck =
-				NULL, int frameIndex = -1);
+				NULL, int frameIndex = -1, bool useFlowField = false);
 		void
 			clearUnitPrecache(Unit * unit);
 		void
@@ -292,6 +374,9 @@ namespace Game {
 		void
 			clearCaches();
 
+		virtual void
+			staticCellsChanged(const Vec2i & pos, int size);
+
 		//bool unitCannotMove(Unit *unit);
 
 		int
@@ -314,7 +399,14 @@ namespace Game {
 		TravelState
 			aStar(Unit * unit, const Vec2i & finalPos, bool inBailout,
 				int frameIndex, int maxNodeCount =
-				-1, uint32 * searched_node_count = NULL);
+				-1, uint32 * searched_node_count = NULL, bool useFlowField = false);
+		Vec2i
+			computeHierarchicalWaypoint(const Unit * unit, const Vec2i & unitPos,
+				const Vec2i & finalPos);
+		bool
+			followFlowField(Unit * unit, const Vec2i & targetPos,
+				Node * firstNode, int maxNodeCount, Node * &lastNode,
+				int &stepCount);
 		inline static Node *
 			newNode(FactionState & faction, int maxNodeCount) {
 			if (faction.nodePoolCount < (int) faction.nodePool.size() &&
@@ -335,28 +427,16 @@ namespace Game {
 
 		inline static bool
 			openPos(const Vec2i & sucPos, FactionState & faction) {
-			if (faction.openPosList.find(sucPos) == faction.openPosList.end()) {
-				return false;
-			}
-			return true;
+			return faction.isPosMarked(sucPos);
 		}
 
 		inline static Node *
 			minHeuristicFastLookup(FactionState & faction) {
-			if (faction.openNodesList.empty() == true) {
+			if (faction.openNodesHeap.empty() == true) {
 				throw
-					game_runtime_error("openNodesList.empty() == true");
-			}
-
-			Node *
-				result = faction.openNodesList.begin()->second.front();
-			faction.openNodesList.begin()->second.erase(faction.openNodesList.
-				begin()->second.
-				begin());
-			if (faction.openNodesList.begin()->second.empty()) {
-				faction.openNodesList.erase(faction.openNodesList.begin());
+					game_runtime_error("openNodesHeap.empty() == true");
 			}
-			return result;
+			return faction.popOpenNode();
 		}
 
 		inline bool
@@ -383,14 +463,14 @@ namespace Game {
 				char
 					szBuf[8096] = "";
 				snprintf(szBuf, 8096,
-					"In processNode() nodeLimitReached %d unitFactionIndex %d foundOpenPosForPos %d allowUnitMoveSoon %d maxNodeCount %d node->pos = %s finalPos = %s sucPos = %s faction.openPosList.size() %lu closedNodesList.size() %lu",
+					"In processNode() nodeLimitReached %d unitFactionIndex %d foundOpenPosForPos %d allowUnitMoveSoon %d maxNodeCount %d node->pos = %s finalPos = %s sucPos = %s faction.nodePoolCount %d closedNodesCount %d",
 					nodeLimitReached, unitFactionIndex, foundOpenPosForPos,
 					allowUnitMoveSoon, maxNodeCount,
 					node->pos.getString().c_str(),
 					finalPos.getString().c_str(),
 					sucPos.getString().c_str(),
-					faction.openPosList.size(),
-					faction.closedNodesList.size());
+					faction.nodePoolCount,
+					faction.closedNodesCount);
 
 				if (Thread::isCurrentThreadMainThread() == false) {
 					unit->logSynchDataThreaded(__FILE__, __LINE__, szBuf);
@@ -411,12 +491,8 @@ namespace Game {
 					sucNode->exploredCell =
 						map->getSurfaceCell(Map::toSurfCoords(sucPos))->
 						isExplored(unit->getTeam());
-					if (faction.openNodesList.find(sucNode->heuristic) ==
-						faction.openNodesList.end()) {
-						faction.openNodesList[sucNode->heuristic].clear();
-					}
-					faction.openNodesList[sucNode->heuristic].push_back(sucNode);
-					faction.openPosList[sucNode->pos] = true;
+					faction.pushOpenNode(sucNode);
+					faction.markPos(sucNode->pos);
 
 					result = true;
 
@@ -494,7 +570,7 @@ namespace Game {
 
 			while (nodeLimitReached == false) {
 				whileLoopCount++;
-				if (faction.openNodesList.empty() == true) {
+				if (faction.openNodesHeap.empty() == true) {
 					if (SystemFlags::
 						getSystemSettingType(SystemFlags::debugWorldSynch).
 						enabled == true
@@ -548,12 +624,8 @@ namespace Game {
 					break;
 				}
 
-				if (faction.closedNodesList.find(node->heuristic) ==
-					faction.closedNodesList.end()) {
-					faction.closedNodesList[node->heuristic].clear();
-				}
-				faction.closedNodesList[node->heuristic].push_back(node);
-				faction.openPosList[node->pos] = true;
+				faction.addClosedNode(node);
+				faction.markPos(node->pos);
 
 				int
 					failureCount = 0;
@@ -0,0 +1,358 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#include "reachability_map.h"
+
+#include <algorithm>
+#include <set>
+
+#include "map.h"
+#include "platform_common.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Graphics;
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+namespace Game {
+	// =====================================================
+	//      class ReachabilityMap
+	// =====================================================
+
+	const int ReachabilityMap::labelBlocked = -1;
+	const int ReachabilityMap::labelNone = -2;
+	// cells searched around a change before a component counts as split
+	const int ReachabilityMap::localMargin = 8;
+
+	// Neighbours in the order straight then diagonal. Map::aproxCanMove
+	// lets units bigger than one cell step diagonally without checking the
+	// corners, single cell units can't cut corners so their diagonal steps
+	// never connect cells the straight ones don't.
+	static const int neighbourX[8] = { -1, 1, 0, 0, -1, 1, -1, 1 };
+	static const int neighbourY[8] = { 0, 0, -1, 1, -1, -1, 1, 1 };
+
+	static inline int getNeighbourCount(int size) {
+		return (size == 1 ? 4 : 8);
+	}
+
+	ReachabilityMap::ReachabilityMap() : mutex(new Mutex(CODE_AT_LINE)) {
+		map = NULL;
+	}
+
+	ReachabilityMap::~ReachabilityMap() {
+		clear();
+		map = NULL;
+
+		delete mutex;
+		mutex = NULL;
+	}
+
+	void ReachabilityMap::init(const Map *map) {
+		clear();
+		this->map = map;
+	}
+
+	void ReachabilityMap::clear() {
+		MutexSafeWrapper safeMutex(mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+		for (Layers::iterator iterMap = layers.begin(); iterMap != layers.end(); ++iterMap) {
+			delete iterMap->second;
+		}
+		layers.clear();
+	}
+
+	// Records the origins whose passability could depend on the changed
+	// cells, the labels are fixed the next time the layer is used
+	void ReachabilityMap::staticCellsChanged(const Vec2i &pos, int size) {
+		if (map == NULL) {
+			return;
+		}
+
+		MutexSafeWrapper safeMutex(mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+		for (Layers::iterator iterMap = layers.begin(); iterMap != layers.end(); ++iterMap) {
+			Layer *layer = iterMap->second;
+
+			Vec2i topLeft(max(pos.x - (layer->size - 1), 0), max(pos.y - (layer->size - 1), 0));
+			Vec2i bottomRight(min(pos.x + size - 1, map->getW() - 1), min(pos.y + size - 1, map->getH() - 1));
+			if (topLeft.x <= bottomRight.x && topLeft.y <= bottomRight.y) {
+				layer->changes.push_back(Region(topLeft, bottomRight));
+			}
+		}
+	}
+
+	// On success result is the target itself when it can be reached from
+	// the starting cell, or else the closest cell to it which can be. A
+	// blocked target counts as reachable when one of its neighbours is.
+	bool ReachabilityMap::findReachablePos(Field field, int size, const Vec2i &from, const Vec2i &to, int maxRadius, Vec2i &result) {
+		result = to;
+		if (map == NULL || map->isInside(from) == false || map->isInside(to) == false) {
+			return true;
+		}
+
+		MutexSafeWrapper safeMutex(mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+		Layer *layer = getLayer(field, size);
+
+		int width = map->getW();
+		int fromLabel = layer->labels[from.y * width + from.x];
+		if (fromLabel < 0) {
+			return true;
+		}
+
+		int toLabel = layer->labels[to.y * width + to.x];
+		if (toLabel == fromLabel) {
+			return true;
+		}
+		if (toLabel == labelBlocked) {
+			for (int i = -1; i <= 1; ++i) {
+				for (int j = -1; j <= 1; ++j) {
+					Vec2i pos(to.x + i, to.y + j);
+					if (map->isInside(pos) && layer->labels[pos.y * width + pos.x] == fromLabel) {
+						return true;
+					}
+				}
+			}
+		}
+
+		// scan rings around the target until no closer cell can follow
+		bool found = false;
+		float bestDist = 0;
+		for (int radius = 1; radius <= maxRadius; ++radius) {
+			if (found == true && radius > bestDist) {
+				break;
+			}
+			for (int y = to.y - radius; y <= to.y + radius; ++y) {
+				int step = (y == to.y - radius || y == to.y + radius) ? 1 : radius * 2;
+				for (int x = to.x - radius; x <= to.x + radius; x += step) {
+					Vec2i pos(x, y);
+					if (map->isInside(pos) == false || layer->labels[y * width + x] != fromLabel) {
+						continue;
+					}
+					float dist = pos.dist(to);
+					if (found == false || dist < bestDist) {
+						found = true;
+						bestDist = dist;
+						result = pos;
+					}
+				}
+			}
+		}
+		return found;
+	}
+
+	// ==================== PRIVATE ====================
+
+	ReachabilityMap::Layer * ReachabilityMap::getLayer(Field field, int size) {
+		int key = (static_cast<int>(field) << 8) | size;
+
+		Layer *layer = NULL;
+		Layers::iterator iterFind = layers.find(key);
+		if (iterFind == layers.end()) {
+			layer = new Layer(field, size);
+			layers[key] = layer;
+			buildLayer(layer);
+		} else {
+			layer = iterFind->second;
+			if (layer->changes.empty() == false) {
+				applyChanges(layer);
+			}
+		}
+		return layer;
+	}
+
+	void ReachabilityMap::buildLayer(Layer *layer) {
+		int width = map->getW();
+		int height = map->getH();
+
+		layer->labels.assign(width * height, labelBlocked);
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				if (isPassable(layer, Vec2i(x, y)) == true) {
+					layer->labels[y * width + x] = labelNone;
+				}
+			}
+		}
+
+		vector<int> fromLabels(1, labelNone);
+		for (int index = 0; index < width * height; ++index) {
+			if (layer->labels[index] == labelNone) {
+				labelComponent(layer, index, layer->nextLabel++, fromLabels);
+			}
+		}
+		layer->changes.clear();
+	}
+
+	void ReachabilityMap::applyChanges(Layer *layer) {
+		for (unsigned int index = 0; index < layer->changes.size(); ++index) {
+			applyChange(layer, layer->changes[index]);
+		}
+		layer->changes.clear();
+	}
+
+	// The changed cells get their new passability and the window around
+	// them is split in pieces connected inside the window. Every cell of a
+	// component outside the window reaches it through a cell of the window
+	// which didn't change, so a component found in one piece only is still
+	// in one piece and the freed cells of that piece join it. Components
+	// spread over several pieces or pieces holding several components may
+	// have split or merged and are flooded again from the window.
+	void ReachabilityMap::applyChange(Layer *layer, const Region &region) {
+		int width = map->getW();
+		int height = map->getH();
+		int neighbourCount = getNeighbourCount(layer->size);
+
+		for (int y = region.topLeft.y; y <= region.bottomRight.y; ++y) {
+			for (int x = region.topLeft.x; x <= region.bottomRight.x; ++x) {
+				layer->labels[y * width + x] = isPassable(layer, Vec2i(x, y)) ? labelNone : labelBlocked;
+			}
+		}
+
+		Vec2i topLeft(max(region.topLeft.x - localMargin, 0), max(region.topLeft.y - localMargin, 0));
+		Vec2i bottomRight(min(region.bottomRight.x + localMargin, width - 1), min(region.bottomRight.y + localMargin, height - 1));
+		int windowW = bottomRight.x - topLeft.x + 1;
+		int windowH = bottomRight.y - topLeft.y + 1;
+
+		vector<int> pieces(windowW * windowH, -1);
+		vector<int> pieceCells;
+		vector<vector<int> > pieceLabels;
+		std::map<int, int> labelPieceCount;
+		vector<int> pending;
+		for (int windowIndex = 0; windowIndex < windowW * windowH; ++windowIndex) {
+			int cellIndex = (topLeft.y + windowIndex / windowW) * width + topLeft.x + windowIndex % windowW;
+			if (pieces[windowIndex] >= 0 || layer->labels[cellIndex] == labelBlocked) {
+				continue;
+			}
+
+			int piece = (int) pieceCells.size();
+			pieceCells.push_back(cellIndex);
+			pieceLabels.push_back(vector<int>());
+			pieces[windowIndex] = piece;
+			pending.push_back(windowIndex);
+			while (pending.empty() == false) {
+				int index = pending.back();
+				pending.pop_back();
+
+				int x = index % windowW;
+				int y = index / windowW;
+				int label = layer->labels[(topLeft.y + y) * width + topLeft.x + x];
+				if (label >= 0 && std::find(pieceLabels[piece].begin(), pieceLabels[piece].end(), label) == pieceLabels[piece].end()) {
+					pieceLabels[piece].push_back(label);
+					labelPieceCount[label]++;
+				}
+
+				for (int neighbour = 0; neighbour < neighbourCount; ++neighbour) {
+					int nextX = x + neighbourX[neighbour];
+					int nextY = y + neighbourY[neighbour];
+					if (nextX < 0 || nextY < 0 || nextX >= windowW || nextY >= windowH) {
+						continue;
+					}
+					int nextIndex = nextY * windowW + nextX;
+					if (pieces[nextIndex] < 0 && layer->labels[(topLeft.y + nextY) * width + topLeft.x + nextX] != labelBlocked) {
+						pieces[nextIndex] = piece;
+						pending.push_back(nextIndex);
+					}
+				}
+			}
+		}
+
+		int pieceCount = (int) pieceCells.size();
+		vector<bool> done(pieceCount, false);
+		for (int piece = 0; piece < pieceCount; ++piece) {
+			if (done[piece] == true) {
+				continue;
+			}
+
+			if (pieceLabels[piece].size() == 1 && labelPieceCount[pieceLabels[piece][0]] == 1) {
+				int label = pieceLabels[piece][0];
+				for (int windowIndex = 0; windowIndex < windowW * windowH; ++windowIndex) {
+					int cellIndex = (topLeft.y + windowIndex / windowW) * width + topLeft.x + windowIndex % windowW;
+					if (pieces[windowIndex] == piece && layer->labels[cellIndex] == labelNone) {
+						layer->labels[cellIndex] = label;
+					}
+				}
+				done[piece] = true;
+				continue;
+			}
+
+			// the pieces sharing a component with this one, and their labels
+			vector<int> group(1, piece);
+			vector<int> fromLabels(1, labelNone);
+			for (unsigned int groupIndex = 0; groupIndex < group.size(); ++groupIndex) {
+				const vector<int> &labels = pieceLabels[group[groupIndex]];
+				for (unsigned int labelIndex = 0; labelIndex < labels.size(); ++labelIndex) {
+					if (std::find(fromLabels.begin(), fromLabels.end(), labels[labelIndex]) != fromLabels.end()) {
+						continue;
+					}
+					fromLabels.push_back(labels[labelIndex]);
+					for (int otherPiece = piece + 1; otherPiece < pieceCount; ++otherPiece) {
+						if (std::find(group.begin(), group.end(), otherPiece) == group.end() &&
+							std::find(pieceLabels[otherPiece].begin(), pieceLabels[otherPiece].end(), labels[labelIndex]) != pieceLabels[otherPiece].end()) {
+							group.push_back(otherPiece);
+						}
+					}
+				}
+			}
+
+			for (unsigned int groupIndex = 0; groupIndex < group.size(); ++groupIndex) {
+				int cellIndex = pieceCells[group[groupIndex]];
+				if (std::find(fromLabels.begin(), fromLabels.end(), layer->labels[cellIndex]) != fromLabels.end()) {
+					labelComponent(layer, cellIndex, layer->nextLabel++, fromLabels);
+				}
+				done[group[groupIndex]] = true;
+			}
+		}
+	}
+
+	// Flood fill from cellIndex over the cells labelled with one of
+	// fromLabels, using the steps the layer's unit size can take
+	void ReachabilityMap::labelComponent(Layer *layer, int cellIndex, int label, const vector<int> &fromLabels) {
+		int width = map->getW();
+		int height = map->getH();
+		int neighbourCount = getNeighbourCount(layer->size);
+
+		vector<int> pending;
+		pending.push_back(cellIndex);
+		layer->labels[cellIndex] = label;
+
+		while (pending.empty() == false) {
+			int index = pending.back();
+			pending.pop_back();
+
+			int x = index % width;
+			int y = index / width;
+			for (int neighbour = 0; neighbour < neighbourCount; ++neighbour) {
+				int nextX = x + neighbourX[neighbour];
+				int nextY = y + neighbourY[neighbour];
+				if (nextX < 0 || nextY < 0 || nextX >= width || nextY >= height) {
+					continue;
+				}
+				int nextIndex = nextY * width + nextX;
+				int nextLabel = layer->labels[nextIndex];
+				if (std::find(fromLabels.begin(), fromLabels.end(), nextLabel) != fromLabels.end()) {
+					layer->labels[nextIndex] = label;
+					pending.push_back(nextIndex);
+				}
+			}
+		}
+	}
+
+	bool ReachabilityMap::isPassable(const Layer *layer, const Vec2i &pos) const {
+		return map->isStaticFreeCells(pos, layer->size, layer->field);
+	}
+
+} //end namespace
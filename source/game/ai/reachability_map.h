@@ -0,0 +1,112 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _REACHABILITY_MAP_H_
+#define _REACHABILITY_MAP_H_
+
+#ifdef WIN32
+#   include <winsock2.h>
+#   include <winsock.h>
+#endif
+
+#include "vec.h"
+#include <vector>
+#include <map>
+#include "skill_type.h"
+#include "thread.h"
+#include "leak_dumper.h"
+
+using std::vector;
+using Shared::Graphics::Vec2i;
+using Shared::Platform::Mutex;
+
+namespace Game {
+	class Map;
+
+	// =====================================================
+	//      class ReachabilityMap
+	//
+	///     Connected component labels of the static occupancy, one layer
+	///     per field and unit size. Two cells with the same label can
+	///     reach each other, so impossible targets are known without
+	///     searching. Changed cells are checked in a window around them,
+	///     only components which may have split or merged are flooded again.
+	// =====================================================
+
+	class ReachabilityMap {
+	private:
+		static const int labelBlocked;
+		static const int labelNone;
+		static const int localMargin;
+
+		class Region {
+		public:
+			Region(const Vec2i &topLeft, const Vec2i &bottomRight) {
+				this->topLeft = topLeft;
+				this->bottomRight = bottomRight;
+			}
+			Vec2i topLeft;
+			Vec2i bottomRight;
+		};
+
+		class Layer {
+		public:
+			Layer(Field field, int size) {
+				this->field = field;
+				this->size = size;
+				nextLabel = 0;
+			}
+			Field field;
+			int size;
+			vector<int> labels;
+			int nextLabel;
+			vector<Region> changes;
+		};
+
+		typedef std::map<int, Layer *> Layers;
+
+		const Map *map;
+		Layers layers;
+		Mutex *mutex;
+
+	public:
+		ReachabilityMap();
+		~ReachabilityMap();
+
+		void init(const Map *map);
+		void clear();
+
+		void staticCellsChanged(const Vec2i &pos, int size);
+		bool findReachablePos(Field field, int size, const Vec2i &from, const Vec2i &to, int maxRadius, Vec2i &result);
+
+	private:
+		ReachabilityMap(const ReachabilityMap &obj);
+		ReachabilityMap & operator=(const ReachabilityMap &obj);
+
+		Layer * getLayer(Field field, int size);
+		void buildLayer(Layer *layer);
+		void applyChanges(Layer *layer);
+		void applyChange(Layer *layer, const Region &region);
+		void labelComponent(Layer *layer, int cellIndex, int label, const vector<int> &fromLabels);
+		bool isPassable(const Layer *layer, const Vec2i &pos) const;
+	};
+
+} //end namespace
+
+#endif
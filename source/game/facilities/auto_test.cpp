@@ -42,11 +42,15 @@ namespace Game {
 	GameSettings AutoTest::gameSettings;
 	string AutoTest::loadGameSettingsFile = "";
 
+	int AutoTest::benchmarkFrames = 0;
+	string AutoTest::benchmarkOutputFile = "";
+
 	// ===================== PUBLIC ========================
 
 	AutoTest::AutoTest() {
 		exitGame = false;
 		gameStartTime = invalidTime;
+		benchmarkStartFrame = -1;
 		random.init(time(NULL));
 	}
 
@@ -90,6 +94,26 @@ namespace Game {
 	}
 
 	bool AutoTest::updateGame(Game *game) {
+		if (isBenchmarkEnabled() == true) {
+			int frameCount = game->getWorld()->getFrameCount();
+			if (benchmarkStartFrame < 0) {
+				benchmarkStartFrame = frameCount;
+				benchmarkChrono.start();
+				printf("Benchmark running %d frames from frame %d\n", benchmarkFrames, benchmarkStartFrame);
+			}
+			if (frameCount - benchmarkStartFrame < benchmarkFrames) {
+				return false;
+			}
+
+			saveBenchmarkResults(game);
+
+			Program *program = game->getProgram();
+			Stats endStats = game->quitGame();
+			exitGame = true;
+			Game::exitGameState(program, endStats);
+			return true;
+		}
+
 		// record start time
 		if (gameStartTime == invalidTime) {
 			gameStartTime = time(NULL);
@@ -110,7 +134,133 @@ namespace Game {
 	}
 
 	void AutoTest::updateBattleEnd(Program *program) {
+		if (isBenchmarkEnabled() == true) {
+			program->setShutdownApplicationEnabled(true);
+			return;
+		}
 		program->setState(new MainMenu(program));
 	}
 
+	// While benchmarking the world runs as many frames per game update as
+	// there are left, up to one second of game time, so the simulation
+	// isn't held back by the update timer
+	int AutoTest::getBenchmarkUpdateLoops(int frameCount) const {
+		if (benchmarkStartFrame < 0) {
+			return 1;
+		}
+		int framesLeft = benchmarkFrames - (frameCount - benchmarkStartFrame);
+		return max(min(framesLeft, GameConstants::updateFps), 0);
+	}
+
+	// Values from Game::addPerformanceCount, kept raw per world frame
+	// instead of the running average the game shows
+	void AutoTest::addBenchmarkSample(int frameCount, const string &key, int64 value) {
+		if (benchmarkStartFrame < 0 || frameCount - benchmarkStartFrame > benchmarkFrames) {
+			return;
+		}
+		benchmarkKeys.insert(key);
+		benchmarkSamples[frameCount][key] += value;
+	}
+
+	// ==================== PRIVATE ====================
+
+	// Faction type and performance counter names are written as json strings,
+	// so quotes, backslashes and control characters in them are escaped
+	static string escapeJsonString(const string &value) {
+		string result;
+		result.reserve(value.size());
+		for (unsigned int i = 0; i < value.size(); ++i) {
+			unsigned char c = (unsigned char) value[i];
+			switch (c) {
+				case '"': result += "\\\""; break;
+				case '\\': result += "\\\\"; break;
+				case '\b': result += "\\b"; break;
+				case '\f': result += "\\f"; break;
+				case '\n': result += "\\n"; break;
+				case '\r': result += "\\r"; break;
+				case '\t': result += "\\t"; break;
+				default:
+					if (c < 0x20) {
+						char szBuf[8] = "";
+						snprintf(szBuf, 8, "\\u%04x", c);
+						result += szBuf;
+					} else {
+						result += (char) c;
+					}
+					break;
+			}
+		}
+		return result;
+	}
+
+	// Writes json when the output file ends with .json and csv otherwise,
+	// the csv lists the faction crcs in # comment lines above the header
+	void AutoTest::saveBenchmarkResults(Game *game) {
+		int64 totalMillis = benchmarkChrono.getMillis();
+		World *world = game->getWorld();
+
+		printf("Benchmark finished %d frames in " I64_SPECIFIER " msecs\n", benchmarkFrames, totalMillis);
+		for (int i = 0; i < world->getFactionCount(); ++i) {
+			Faction *faction = world->getFaction(i);
+			printf("Faction %d [%s] crc: %u\n", i, faction->getType()->getName(false).c_str(), Checksum64::fold(faction->getCRC()));
+		}
+		if (benchmarkOutputFile == "") {
+			return;
+		}
+
+#if defined(WIN32) && !defined(__MINGW32__)
+		FILE *fp = _wfopen(utf8_decode(benchmarkOutputFile).c_str(), L"w");
+#else
+		FILE *fp = fopen(benchmarkOutputFile.c_str(), "w");
+#endif
+		if (fp == NULL) {
+			throw game_runtime_error("Can not open benchmark output file: [" + benchmarkOutputFile + "]");
+		}
+
+		bool writeJson = (EndsWith(benchmarkOutputFile, ".json") == true);
+		if (writeJson == true) {
+			fprintf(fp, "{\n\t\"frames\": %d,\n\t\"startFrame\": %d,\n\t\"totalMillis\": " I64_SPECIFIER ",\n", benchmarkFrames, benchmarkStartFrame, totalMillis);
+			fprintf(fp, "\t\"factions\": [");
+			for (int i = 0; i < world->getFactionCount(); ++i) {
+				Faction *faction = world->getFaction(i);
+				fprintf(fp, "%s\n\t\t{ \"index\": %d, \"type\": \"%s\", \"crc\": %u }", (i > 0 ? "," : ""), i, escapeJsonString(faction->getType()->getName(false)).c_str(), Checksum64::fold(faction->getCRC()));
+			}
+			fprintf(fp, "\n\t],\n\t\"samples\": [");
+			for (std::map<int, std::map<string, int64> >::const_iterator iterFrame = benchmarkSamples.begin();
+				iterFrame != benchmarkSamples.end(); ++iterFrame) {
+				fprintf(fp, "%s\n\t\t{ \"frame\": %d", (iterFrame != benchmarkSamples.begin() ? "," : ""), iterFrame->first);
+				for (std::map<string, int64>::const_iterator iterKey = iterFrame->second.begin();
+					iterKey != iterFrame->second.end(); ++iterKey) {
+					fprintf(fp, ", \"%s\": " I64_SPECIFIER, escapeJsonString(iterKey->first).c_str(), iterKey->second);
+				}
+				fprintf(fp, " }");
+			}
+			fprintf(fp, "\n\t]\n}\n");
+		} else {
+			fprintf(fp, "# frames %d start frame %d total msecs " I64_SPECIFIER "\n", benchmarkFrames, benchmarkStartFrame, totalMillis);
+			for (int i = 0; i < world->getFactionCount(); ++i) {
+				Faction *faction = world->getFaction(i);
+				fprintf(fp, "# faction %d %s crc %u\n", i, faction->getType()->getName(false).c_str(), Checksum64::fold(faction->getCRC()));
+			}
+			fprintf(fp, "frame");
+			for (std::set<string>::const_iterator iterKey = benchmarkKeys.begin();
+				iterKey != benchmarkKeys.end(); ++iterKey) {
+				fprintf(fp, ",%s", iterKey->c_str());
+			}
+			fprintf(fp, "\n");
+			for (std::map<int, std::map<string, int64> >::const_iterator iterFrame = benchmarkSamples.begin();
+				iterFrame != benchmarkSamples.end(); ++iterFrame) {
+				fprintf(fp, "%d", iterFrame->first);
+				for (std::set<string>::const_iterator iterKey = benchmarkKeys.begin();
+					iterKey != benchmarkKeys.end(); ++iterKey) {
+					std::map<string, int64>::const_iterator iterFind = iterFrame->second.find(*iterKey);
+					fprintf(fp, "," I64_SPECIFIER, (iterFind != iterFrame->second.end() ? iterFind->second : 0));
+				}
+				fprintf(fp, "\n");
+			}
+		}
+		fclose(fp);
+		printf("Benchmark results written to [%s]\n", benchmarkOutputFile.c_str());
+	}
+
 } //end namespace
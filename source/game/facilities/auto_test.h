@@ -28,11 +28,15 @@
 #include <ctime>
 #include "randomgen.h"
 #include <string>
+#include <map>
+#include <set>
 #include "game_settings.h"
+#include "platform_common.h"
 #include "leak_dumper.h"
 
 using namespace std;
 using Shared::Util::RandomGen;
+using Shared::PlatformCommon::Chrono;
 
 namespace Game {
 	class Program;
@@ -59,6 +63,15 @@ namespace Game {
 		static const time_t invalidTime;
 		static time_t gameTime;
 
+		static int benchmarkFrames;
+		static string benchmarkOutputFile;
+		int benchmarkStartFrame;
+		Chrono benchmarkChrono;
+		std::set<string> benchmarkKeys;
+		std::map<int, std::map<string, int64> > benchmarkSamples;
+
+		void saveBenchmarkResults(Game *game);
+
 	public:
 		static AutoTest & getInstance();
 		AutoTest();
@@ -76,6 +89,16 @@ namespace Game {
 			loadGameSettingsFile = filename;
 		}
 
+		static void setBenchmark(int frames, const string &outputFile) {
+			benchmarkFrames = frames;
+			benchmarkOutputFile = outputFile;
+		}
+		static bool isBenchmarkEnabled() {
+			return benchmarkFrames > 0;
+		}
+		int getBenchmarkUpdateLoops(int frameCount) const;
+		void addBenchmarkSample(int frameCount, const string &key, int64 value);
+
 		bool mustExitGame() const {
 			return exitGame;
 		}
@@ -346,8 +346,25 @@ namespace Game {
 		return path;
 	}
 
+	static const string networkProtocolTag = " protocol ";
+
+	// The version players exchange when joining a game, builds with
+	// different network protocols can't play together
+	string getNetworkVersionString() {
+		return GameVersionString + networkProtocolTag + NetworkProtocolVersionString;
+	}
+
+	static string getNetworkProtocolVersion(const string &versionString) {
+		size_t pos = versionString.rfind(networkProtocolTag);
+		if (pos == string::npos) {
+			return "";
+		}
+		return versionString.substr(pos + networkProtocolTag.size());
+	}
+
 	bool checkVersionCompatibility(string clientVersionString, string serverVersionString) {
-		return true;
+		return getNetworkProtocolVersion(clientVersionString) ==
+			getNetworkProtocolVersion(serverVersionString);
 	}
 
 	void initSpecialStrings() {
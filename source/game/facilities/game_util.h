@@ -43,6 +43,7 @@ namespace Game {
 	string getAboutString2(int i);
 	string getTeammateName(int i);
 	string getTeammateRole(int i);
+	string getNetworkVersionString();
 	bool checkVersionCompatibility(string clientVersionString, string serverVersionString);
 	string formatString(string str);
 
@@ -44,6 +44,8 @@ namespace Game {
 	// =====================================================
 	Commander::Commander() {
 		this->world = NULL;
+		this->replayCommandIndex = 0;
+		this->replaySeekFrame = -1;
 		this->
 			pauseNetworkCommands = false;
 	}
@@ -706,27 +708,24 @@ namespace Game {
 		Commander::getReplayCommandListForFrame(int worldFrameCount) {
 		bool
 			haveReplyCommands = false;
-		if (replayCommandList.empty() == false) {
+		if (replayCommandIndex < replayCommandList.size()) {
 			if (SystemFlags::VERBOSE_MODE_ENABLED)
 				printf("worldFrameCount = %d replayCommandList.size() = "
 					SIZE_T_SPECIFIER "\n", worldFrameCount,
-					replayCommandList.size());
+					replayCommandList.size() - replayCommandIndex);
 
 			std::vector < NetworkCommand > replayList;
-			for (unsigned int i = 0; i < replayCommandList.size(); ++i) {
-				std::pair < int,
-					NetworkCommand > &
-					cmd = replayCommandList[i];
-				if (cmd.first <= worldFrameCount) {
-					replayList.push_back(cmd.second);
-					haveReplyCommands = true;
-				}
+			for (; replayCommandIndex < replayCommandList.size() &&
+				replayCommandList[replayCommandIndex].first <= worldFrameCount;
+				++replayCommandIndex) {
+				replayList.push_back(replayCommandList[replayCommandIndex].second);
+				haveReplyCommands = true;
+			}
+			if (replayCommandIndex >= replayCommandList.size()) {
+				replayCommandList.clear();
+				replayCommandIndex = 0;
 			}
 			if (haveReplyCommands == true) {
-				replayCommandList.erase(replayCommandList.begin(),
-					replayCommandList.begin() +
-					replayList.size());
-
 				if (SystemFlags::VERBOSE_MODE_ENABLED)
 					printf
 					("worldFrameCount = %d GIVING COMMANDS replayList.size() = "
@@ -747,14 +746,22 @@ namespace Game {
 
 	bool
 		Commander::hasReplayCommandListForFrame() const {
-		return (replayCommandList.empty() == false);
+		return (replayCommandIndex < replayCommandList.size());
+	}
+
+	bool
+		Commander::isReplayFastForwarding() const {
+		if (hasReplayCommandListForFrame() == false) {
+			return false;
+		}
+		return (replaySeekFrame < 0 || world == NULL
+			|| world->getFrameCount() < replaySeekFrame);
 	}
 
 	int
 		Commander::getReplayCommandListForFrameCount() const {
 		return (int)
-			replayCommandList.
-			size();
+			(replayCommandList.size() - replayCommandIndex);
 	}
 
 	void
@@ -923,6 +930,7 @@ namespace Game {
 					int
 						oldTeam = faction->getTeam();
 					faction->setTeam(newTeam);
+					world->getMap()->rebuildUnitBuckets();
 					GameSettings *
 						settings = world->getGameSettingsPtr();
 					settings->setTeam(factionIndex, newTeam);
@@ -1055,6 +1063,7 @@ namespace Game {
 					int
 						oldTeam = faction->getTeam();
 					faction->setTeam(vote->newTeam);
+					world->getMap()->rebuildUnitBuckets();
 					GameSettings *
 						settings = world->getGameSettingsPtr();
 					settings->setTeam(factionIndex, vote->newTeam);
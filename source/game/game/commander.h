@@ -79,6 +79,14 @@ namespace Game {
 			std::pair < int,
 			NetworkCommand > >
 			replayCommandList;
+		// replayCommandList is sorted by frame, entries before this
+		// index have already been given
+		unsigned int
+			replayCommandIndex;
+		// replay commands before this frame are played at full speed, the
+		// rest at game speed, -1 plays all of them at full speed
+		int
+			replaySeekFrame;
 
 		bool
 			pauseNetworkCommands;
@@ -114,6 +122,12 @@ namespace Game {
 			hasReplayCommandListForFrame() const;
 		int
 			getReplayCommandListForFrameCount() const;
+		void
+			setReplaySeekFrame(int frame) {
+			this->replaySeekFrame = frame;
+		}
+		bool
+			isReplayFastForwarding() const;
 
 		std::pair <
 			CommandResult,
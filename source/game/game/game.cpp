@@ -39,6 +39,8 @@
 #include "conversion.h"
 #include "steam.h"
 #include "shared_const.h"
+#include "replay_file.h"
+#include "xml_binary.h"
 #include "leak_dumper.h"
 
 using namespace Shared;
@@ -51,6 +53,15 @@ namespace Game {
 	string GameSettings::playerDisconnectedText = "";
 	Game *thisGamePtr = NULL;
 
+	// settings read every frame
+	static ConfigBool showPerfStatsConfig("ShowPerfStats", "false");
+	static ConfigBool newThreadManagerConfig("EnableNewThreadManager", "false");
+	static ConfigBool autoTestConfig("AutoTest", "false");
+	static ConfigBool mouseMoveScrollsWorldConfig("MouseMoveScrollsWorld", "true");
+	static ConfigBool performanceWarningEnabledConfig("PerformanceWarningEnabled", "false");
+	static ConfigInt performanceWarningMillisConfig("PerformanceWarningMillis", "7");
+	static ConfigInt performanceWarningRenderMillisConfig("PerformanceWarningRenderMillis", "40");
+
 	// =====================================================
 	//      class Game
 	// =====================================================
@@ -71,6 +82,146 @@ namespace Game {
 
 	int GAME_STATS_DUMP_INTERVAL = 60 * 10;
 
+	// =====================================================
+	//      class SaveGameThread
+	// =====================================================
+
+	SaveGameThread::SaveGameThread(XmlTree * xmlTree,
+		const string & saveGameFile, const string & compressedFile,
+		bool binary, int compressionLevel) :BaseThread(),
+		mutexSaveCompleted(new Mutex(CODE_AT_LINE)) {
+		this->uniqueID = "SaveGameThread";
+		this->xmlTree = xmlTree;
+		this->saveGameFile = saveGameFile;
+		this->compressedFile = compressedFile;
+		this->binary = binary;
+		this->compressionLevel = compressionLevel;
+		this->saveCompleted = false;
+		this->saveResult = false;
+	}
+
+	SaveGameThread::~SaveGameThread() {
+		delete xmlTree;
+		xmlTree = NULL;
+
+		delete mutexSaveCompleted;
+		mutexSaveCompleted = NULL;
+	}
+
+	void SaveGameThread::execute() {
+		RunningStatusSafeWrapper runningStatus(this);
+		bool result = false;
+		try {
+			// the write is not interrupted on quit, a partial save
+			// would be worse than waiting for it
+			ExecutingTaskSafeWrapper safeExecutingTaskMutex(this);
+			if (binary == true) {
+				xmlTree->saveBinary(saveGameFile, compressionLevel);
+			} else {
+				xmlTree->save(saveGameFile);
+			}
+
+			result = true;
+			if (compressedFile != "") {
+				result = compressFileToZIPFile(saveGameFile, compressedFile);
+				if (SystemFlags::VERBOSE_MODE_ENABLED)
+					printf
+					("Saved game [%s] compressed to [%s] returned: %d\n",
+						saveGameFile.c_str(), compressedFile.c_str(), result);
+			}
+		} catch (const exception & ex) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,
+				"In [%s::%s Line: %d] Error [%s]\n",
+				extractFileFromDirectoryPath(__FILE__).c_str(),
+				__FUNCTION__, __LINE__, ex.what());
+			result = false;
+		}
+
+		setSaveCompleted(result);
+		deleteSelfIfRequired();
+	}
+
+	bool SaveGameThread::canShutdown(bool deleteSelfIfShutdownDelayed) {
+		bool ret = (getExecutingTask() == false);
+		if (ret == false && deleteSelfIfShutdownDelayed == true) {
+			setDeleteSelfOnExecutionDone(deleteSelfIfShutdownDelayed);
+			deleteSelfIfRequired();
+			signalQuit();
+		}
+
+		return ret;
+	}
+
+	void SaveGameThread::setSaveCompleted(bool result) {
+		MutexSafeWrapper safeMutex(mutexSaveCompleted, CODE_AT_LINE);
+		saveResult = result;
+		saveCompleted = true;
+	}
+
+	bool SaveGameThread::getSaveCompleted() {
+		MutexSafeWrapper safeMutex(mutexSaveCompleted, CODE_AT_LINE);
+		return saveCompleted;
+	}
+
+	bool SaveGameThread::getSaveResult() {
+		MutexSafeWrapper safeMutex(mutexSaveCompleted, CODE_AT_LINE);
+		return saveResult;
+	}
+
+	// =====================================================
+	//      class ReplayKeyframeThread
+	// =====================================================
+
+	ReplayKeyframeThread::ReplayKeyframeThread(XmlTree * xmlTree, int frame,
+		int compressionLevel) :BaseThread(),
+		mutexCompleted(new Mutex(CODE_AT_LINE)) {
+		this->uniqueID = "ReplayKeyframeThread";
+		this->xmlTree = xmlTree;
+		this->frame = frame;
+		this->compressionLevel = compressionLevel;
+		this->completed = false;
+	}
+
+	ReplayKeyframeThread::~ReplayKeyframeThread() {
+		delete xmlTree;
+		xmlTree = NULL;
+
+		delete mutexCompleted;
+		mutexCompleted = NULL;
+	}
+
+	void ReplayKeyframeThread::execute() {
+		RunningStatusSafeWrapper runningStatus(this);
+		try {
+			ExecutingTaskSafeWrapper safeExecutingTaskMutex(this);
+			keyframeData =
+				XmlIoBinary::saveToMemory(xmlTree->getRootNode(),
+					compressionLevel);
+		} catch (const exception & ex) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,
+				"In [%s::%s Line: %d] Error [%s]\n",
+				extractFileFromDirectoryPath(__FILE__).c_str(),
+				__FUNCTION__, __LINE__, ex.what());
+			keyframeData = "";
+		}
+
+		setCompleted();
+	}
+
+	void ReplayKeyframeThread::setCompleted() {
+		MutexSafeWrapper safeMutex(mutexCompleted, CODE_AT_LINE);
+		completed = true;
+	}
+
+	bool ReplayKeyframeThread::getCompleted() {
+		MutexSafeWrapper safeMutex(mutexCompleted, CODE_AT_LINE);
+		return completed;
+	}
+
+	// =====================================================
+	//      class Game
+	// =====================================================
+
 	Game::Game() :
 		ProgramState(NULL) {
 		if (SystemFlags::VERBOSE_MODE_ENABLED)
@@ -98,6 +249,8 @@ namespace Game {
 		paused = false;
 		networkPauseGameForLaggedClientsRequested = false;
 		networkResumeGameForLaggedClientsRequested = false;
+		saveGameThread = NULL;
+		replayKeyframeThread = NULL;
 		pausedForJoinGame = false;
 		pausedBeforeJoinGame = false;
 		pauseRequestSent = false;
@@ -179,6 +332,7 @@ namespace Game {
 
 		loadGameNode = NULL;
 		lastworldFrameCountForReplay = -1;
+		replayKeyframeInterval = 0;
 		lastNetworkPlayerConnectionCheck = time(NULL);
 		inJoinGameLoading = false;
 		quitGameCalled = false;
@@ -208,6 +362,12 @@ namespace Game {
 		original_cameraFps = GameConstants::cameraFps;
 		GameConstants::updateFps = 40;
 		GameConstants::cameraFps = 100;
+		replayKeyframeInterval = 0;
+		if (Config::getInstance().getBool("SaveCommandsForReplay", "false") == true) {
+			replayKeyframeInterval =
+				Config::getInstance().getInt("ReplayKeyframeIntervalSeconds",
+					"300") * GameConstants::updateFps;
+		}
 		captureAvgTestStatus = false;
 		updateFpsAvgTest = 0;
 		renderFpsAvgTest = 0;
@@ -215,6 +375,8 @@ namespace Game {
 		playerIndexDisconnect = 0;
 		lastMasterServerGameStatsDump = 0;
 		highlightCellTexture = NULL;
+		saveGameThread = NULL;
+		replayKeyframeThread = NULL;
 		totalRenderFps = 0;
 		lastMaxUnitCalcTime = 0;
 		renderExtraTeamColor = 0;
@@ -532,6 +694,8 @@ namespace Game {
 				__LINE__);
 
 		quitGame();
+		waitForNetworkGameSave();
+		checkReplayKeyframeCompleted(true);
 
 		Object::setStateCallback(NULL);
 		thisGamePtr = NULL;
@@ -2583,8 +2747,7 @@ namespace Game {
 							if (index < world.getFactionCount()) {
 								Faction *faction = world.getFaction(index);
 								netIntf->setNetworkPlayerFactionCRC(index,
-									faction->getCRC().getSum
-									());
+									Checksum64::fold(faction->getCRC()));
 
 								if (settings != NULL) {
 									if (isFlagType1BitEnabled
@@ -2619,8 +2782,7 @@ namespace Game {
 			}
 
 			bool
-				showPerfStats =
-				Config::getInstance().getBool("ShowPerfStats", "false");
+				showPerfStats = showPerfStatsConfig.get();
 			Chrono chronoPerf;
 			char perfBuf[8096] = "";
 			std::vector < string > perfList;
@@ -2955,6 +3117,8 @@ namespace Game {
 					}
 					for (int i = 0; i < updateLoops; ++i) {
 						//if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) chrono.start();
+						recordReplayKeyframeIfRequired();
+
 						if (showPerfStats) {
 							sprintf(perfBuf,
 								"In [%s::%s] Line: %d took msecs: "
@@ -2975,9 +3139,7 @@ namespace Game {
 								());
 
 							const bool
-								newThreadManager =
-								Config::getInstance().getBool("EnableNewThreadManager",
-									"false");
+								newThreadManager = newThreadManagerConfig.get();
 							if (newThreadManager == true) {
 								int currentFrameCount = world.getFrameCount();
 								masterController.signalSlaves(&currentFrameCount);
@@ -3078,7 +3240,7 @@ namespace Game {
 								perfList.push_back(perfBuf);
 							}
 
-						} else {
+						} else if (commander.isReplayFastForwarding() == true) {
 							// Simply show a progress message while replaying commands
 							if (lastReplaySecond < chronoReplay.getSeconds()) {
 								lastReplaySecond = chronoReplay.getSeconds();
@@ -3334,7 +3496,7 @@ namespace Game {
 
 						//good_fpu_control_registers(NULL,extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 					}
-				} while (commander.hasReplayCommandListForFrame() == true);
+				} while (commander.isReplayFastForwarding() == true);
 			}
 			//else if(role == nrClient) {
 			else {
@@ -3645,7 +3807,8 @@ namespace Game {
 								commander.tryResumeGame(true, true);
 								resumeRequestSent = true;
 							}
-						} else if (server->getStartInGameConnectionLaunch() == true) {
+						} else if (saveGameThread == NULL &&
+							server->getStartInGameConnectionLaunch() == true) {
 							bool saveNetworkGame = false;
 
 							ServerInterface *server =
@@ -3672,85 +3835,13 @@ namespace Game {
 							}
 
 							if (saveNetworkGame == true) {
-								//printf("Saved network game to disk\n");
-
-								string
-									file =
-									this->saveGame(GameConstants::saveNetworkGameFileServer,
-										"temp/");
-
-								string saveGameFilePath = "temp/";
-								string
-									saveGameFileCompressed =
-									saveGameFilePath +
-									string(GameConstants::saveNetworkGameFileServerCompressed);
-								if (getGameReadWritePath
-								(GameConstants::path_logs_CacheLookupKey) != "") {
-									saveGameFilePath =
-										getGameReadWritePath
-										(GameConstants::path_logs_CacheLookupKey) +
-										saveGameFilePath;
-									saveGameFileCompressed =
-										saveGameFilePath +
-										string
-										(GameConstants::saveNetworkGameFileServerCompressed);
-								} else {
-									string
-										userData =
-										Config::getInstance().getString("UserData_Root", "");
-									if (userData != "") {
-										endPathWithSlash(userData);
-									}
-									saveGameFilePath = userData + saveGameFilePath;
-									saveGameFileCompressed =
-										saveGameFilePath +
-										string
-										(GameConstants::saveNetworkGameFileServerCompressed);
-								}
-
-								bool
-									compressed_result =
-									compressFileToZIPFile(file, saveGameFileCompressed);
-								if (SystemFlags::VERBOSE_MODE_ENABLED)
-									printf
-									("Saved game [%s] compressed to [%s] returned: %d\n",
-										file.c_str(), saveGameFileCompressed.c_str(),
-										compressed_result);
-
-								char szBuf[8096] = "";
-								Lang & lang = Lang::getInstance();
-								snprintf(szBuf, 8096,
-									lang.getString("GameSaved", "").c_str(), file.c_str());
-								console.addLine(szBuf);
-
-								for (int i = 0; i < world.getFactionCount(); ++i) {
-									Faction *faction = world.getFaction(i);
-
-									MutexSafeWrapper
-										safeMutex(server->getSlotMutex
-										(faction->getStartLocationIndex()),
-											CODE_AT_LINE);
-									ConnectionSlot *slot =
-										server->getSlot(faction->getStartLocationIndex(),
-											false);
-									if (slot != NULL
-										&& slot->getJoinGameInProgress() == true
-										&& slot->getSentSavedGameInfo() == false) {
-
-										safeMutex.ReleaseLock();
-										NetworkMessageReady networkMessageReady(0);
-										slot->sendMessage(&networkMessageReady);
-
-										slot =
-											server->getSlot(faction->getStartLocationIndex(),
-												false);
-										if (slot != NULL) {
-											slot->setSentSavedGameInfo(true);
-										}
-									}
-								}
+								startNetworkGameSave();
 							}
 						}
+
+						// joining clients are told to fetch the save once the
+						// background thread has written it
+						checkNetworkGameSaveCompleted();
 					}
 					//else {
 					// handle setting changes from clients
@@ -3784,7 +3875,7 @@ namespace Game {
 			// END - Handle joining in progress games
 
 			//update auto test
-			if (Config::getInstance().getBool("AutoTest", "false")) {
+			if (autoTestConfig.get()) {
 				AutoTest::getInstance().updateGame(this);
 				return;
 			}
@@ -4035,6 +4126,9 @@ namespace Game {
 
 	void Game::addPerformanceCount(string key, int64 value) {
 		gamePerformanceCounts[key] = value + gamePerformanceCounts[key] / 2;
+		if (AutoTest::isBenchmarkEnabled() == true) {
+			AutoTest::getInstance().addBenchmarkSample(world.getFrameCount(), key, value);
+		}
 	}
 
 	string Game::getGamePerformanceCounts(bool displayWarnings) const {
@@ -4044,15 +4138,11 @@ namespace Game {
 
 		bool displayWarningHeader = true;
 		bool
-			WARN_TO_CONSOLE =
-			Config::getInstance().getBool("PerformanceWarningEnabled", "false");
+			WARN_TO_CONSOLE = performanceWarningEnabledConfig.get();
 		int
-			WARNING_MILLIS =
-			Config::getInstance().getInt("PerformanceWarningMillis", "7");
+			WARNING_MILLIS = performanceWarningMillisConfig.get();
 		int
-			WARNING_RENDER_MILLIS =
-			Config::getInstance().getInt("PerformanceWarningRenderMillis",
-				"40");
+			WARNING_RENDER_MILLIS = performanceWarningRenderMillisConfig.get();
 
 		string result = "";
 		for (std::map < string, int64 >::const_iterator iterMap =
@@ -6167,9 +6257,7 @@ namespace Game {
 						}
 					} else {
 						bool
-							mouseMoveScrollsWorld =
-							Config::getInstance().getBool("MouseMoveScrollsWorld",
-								"true");
+							mouseMoveScrollsWorld = mouseMoveScrollsWorldConfig.get();
 						if (mouseMoveScrollsWorld == true) {
 							if (y < 10) {
 								gameCamera.setMoveZ(-scrollSpeed);
@@ -7593,8 +7681,8 @@ namespace Game {
 		}
 
 		str +=
-			"UnitRangeCellsLookupItemCache: " +
-			world.getUnitUpdater()->getUnitRangeCellsLookupItemCacheStats() +
+			"UnitBuckets: " +
+			world.getMap()->getUnitBucketStats() +
 			"\n";
 		str +=
 			"ExploredCellsLookupItemCache: " +
@@ -8566,12 +8654,14 @@ namespace Game {
 	}
 
 	int Game::getUpdateLoops() {
-		if (commander.hasReplayCommandListForFrame() == true) {
+		if (commander.isReplayFastForwarding() == true) {
 			return 1;
 		}
 
 		if (getPaused()) {
 			return 0;
+		} else if (AutoTest::isBenchmarkEnabled() == true) {
+			return AutoTest::getInstance().getBenchmarkUpdateLoops(world.getFrameCount());
 		} else if (this->speed == 0) {
 			return updateFps % 2 == 0 ? 1 : 0;
 		} else
@@ -8672,6 +8762,57 @@ namespace Game {
 		}
 	}
 
+	// Keyframes are taken before a frame is simulated, so commands up to
+	// and including that frame are already part of them. Only the tree is
+	// built here, it is serialized and compressed on a thread.
+	void Game::recordReplayKeyframeIfRequired() {
+		if (replayKeyframeInterval <= 0
+			|| commander.hasReplayCommandListForFrame() == true) {
+			return;
+		}
+		checkReplayKeyframeCompleted(false);
+
+		int frame = world.getFrameCount();
+		if (frame <= 0 || frame % replayKeyframeInterval != 0) {
+			return;
+		}
+		// one keyframe at a time keeps the list in frame order
+		checkReplayKeyframeCompleted(true);
+		if (replayKeyframeList.empty() == false
+			&& replayKeyframeList.back().first >= frame) {
+			return;
+		}
+
+		XmlTree *xmlTree = new XmlTree();
+		saveGameToTree(*xmlTree);
+		replayKeyframeThread =
+			new ReplayKeyframeThread(xmlTree, frame,
+				Config::getInstance().getInt("BinarySaveGameCompressionLevel",
+					"5"));
+		replayKeyframeThread->start();
+	}
+
+	void Game::checkReplayKeyframeCompleted(bool wait) {
+		if (replayKeyframeThread == NULL) {
+			return;
+		}
+		if (wait == false && replayKeyframeThread->getCompleted() == false) {
+			return;
+		}
+		while (replayKeyframeThread->getCompleted() == false) {
+			sleep(1);
+		}
+
+		if (replayKeyframeThread->getKeyframeData().empty() == false) {
+			replayKeyframeList.push_back(make_pair(replayKeyframeThread->getFrame(),
+				replayKeyframeThread->getKeyframeData()));
+		}
+		if (replayKeyframeThread->shutdownAndWait() == true) {
+			delete replayKeyframeThread;
+		}
+		replayKeyframeThread = NULL;
+	}
+
 	void Game::renderVideoPlayer() {
 		if (videoPlayer != NULL) {
 			if (videoPlayer->isPlaying() == true) {
@@ -8816,7 +8957,7 @@ namespace Game {
 		config.save();
 	}
 
-	string Game::saveGame(string name, const string & path) {
+	string Game::getSaveGameFilePath(string name, const string & path) {
 		Config & config = Config::getInstance();
 		// auto name file if using saved file pattern string
 		if (name == GameConstants::saveGameFilePattern) {
@@ -8855,6 +8996,12 @@ namespace Game {
 			}
 			saveGameFile = userData + saveGameFile;
 		}
+		return saveGameFile;
+	}
+
+	string Game::saveGame(string name, const string & path) {
+		Config & config = Config::getInstance();
+		string saveGameFile = getSaveGameFilePath(name, path);
 		if (SystemFlags::VERBOSE_MODE_ENABLED)
 			printf("Saving game to [%s]\n", saveGameFile.c_str());
 
@@ -8885,22 +9032,60 @@ namespace Game {
 				intToStr(world.getFrameCount()),
 				mapTagReplacements);
 
-			for (unsigned int i = 0; i < replayCommandList.size(); ++i) {
-				std::pair < int, NetworkCommand > & cmd = replayCommandList[i];
-				XmlNode *networkCommandNode = cmd.second.saveGame(gameNodeReplay);
-				networkCommandNode->addAttribute("worldFrameCount",
-					intToStr(cmd.first),
-					mapTagReplacements);
-			}
-
 			string replayFile = saveGameFile + ".replay";
 			if (SystemFlags::VERBOSE_MODE_ENABLED)
 				printf("Saving game replay commands to [%s]\n",
 					replayFile.c_str());
-			xmlTreeSaveGame.save(replayFile);
+			// binary replays are recognized when loading, so both formats load
+			if (config.getBool("BinaryReplays", "true") == true) {
+				checkReplayKeyframeCompleted(true);
+				ReplayFile::save(replayFile, rootNodeReplay, replayCommandList,
+					replayKeyframeList);
+			} else {
+				for (unsigned int i = 0; i < replayCommandList.size(); ++i) {
+					std::pair < int, NetworkCommand > & cmd = replayCommandList[i];
+					XmlNode *networkCommandNode =
+						cmd.second.saveGame(gameNodeReplay);
+					networkCommandNode->addAttribute("worldFrameCount",
+						intToStr(cmd.first),
+						mapTagReplacements);
+				}
+				xmlTreeSaveGame.save(replayFile);
+			}
 		}
 
 		XmlTree xmlTree;
+		saveGameToTree(xmlTree);
+
+		// binary saves are recognized when loading, so both formats load
+		if (config.getBool("BinarySaveGames", "true") == true) {
+			xmlTree.saveBinary(saveGameFile,
+				config.getInt("BinarySaveGameCompressionLevel", "5"));
+		} else {
+			xmlTree.save(saveGameFile);
+		}
+
+		if (masterserverMode == false) {
+			// take Screenshot
+			string jpgFileName = saveGameFile + ".jpg";
+			// menu is already disabled, last rendered screen is still with enabled one. Lets render again:
+			render3d();
+			render2d();
+			Renderer::getInstance().saveScreen(jpgFileName,
+				config.getInt
+				("SaveGameScreenshotWidth",
+					"800"),
+				config.getInt
+				("SaveGameScreenshotHeight",
+					"600"));
+		}
+
+		return saveGameFile;
+	}
+
+	// Everything a saved game holds, taken at a frame boundary so the
+	// tree stays valid while the game moves on
+	void Game::saveGameToTree(XmlTree & xmlTree) {
 		xmlTree.init("glest-saved-game");
 		XmlNode *rootNode = xmlTree.getRootNode();
 
@@ -9101,25 +9286,89 @@ namespace Game {
 		gameNode->addAttribute("disableSpeedChange",
 			intToStr(disableSpeedChange),
 			mapTagReplacements);
+	}
 
-		xmlTree.save(saveGameFile);
+	// The tree is built here so it matches this frame exactly, the
+	// serializing, compression and disk writes happen on a thread
+	void Game::startNetworkGameSave() {
+		Config & config = Config::getInstance();
+		string saveGameFile =
+			getSaveGameFilePath(GameConstants::saveNetworkGameFileServer,
+				"temp/");
+		string saveGameFileCompressed =
+			getSaveGameFilePath(GameConstants::
+				saveNetworkGameFileServerCompressed, "temp/");
+		if (SystemFlags::VERBOSE_MODE_ENABLED)
+			printf("Saving network game to [%s] in the background\n",
+				saveGameFile.c_str());
 
-		if (masterserverMode == false) {
-			// take Screenshot
-			string jpgFileName = saveGameFile + ".jpg";
-			// menu is already disabled, last rendered screen is still with enabled one. Lets render again:
-			render3d();
-			render2d();
-			Renderer::getInstance().saveScreen(jpgFileName,
-				config.getInt
-				("SaveGameScreenshotWidth",
-					"800"),
-				config.getInt
-				("SaveGameScreenshotHeight",
-					"600"));
+		XmlTree *xmlTree = new XmlTree();
+		saveGameToTree(*xmlTree);
+
+		saveGameThread =
+			new SaveGameThread(xmlTree, saveGameFile, saveGameFileCompressed,
+				config.getBool("BinarySaveGames", "true"),
+				config.getInt("BinarySaveGameCompressionLevel", "5"));
+		saveGameThread->start();
+	}
+
+	void Game::checkNetworkGameSaveCompleted() {
+		if (saveGameThread == NULL
+			|| saveGameThread->getSaveCompleted() == false) {
+			return;
 		}
 
-		return saveGameFile;
+		string file = saveGameThread->getSaveGameFile();
+		bool saveResult = saveGameThread->getSaveResult();
+		waitForNetworkGameSave();
+		if (saveResult == false) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,
+				"In [%s::%s Line: %d] Error saving network game [%s]\n",
+				extractFileFromDirectoryPath(__FILE__).c_str(),
+				__FUNCTION__, __LINE__, file.c_str());
+		}
+
+		char szBuf[8096] = "";
+		Lang & lang = Lang::getInstance();
+		snprintf(szBuf, 8096,
+			lang.getString("GameSaved", "").c_str(), file.c_str());
+		console.addLine(szBuf);
+
+		ServerInterface *server =
+			NetworkManager::getInstance().getServerInterface();
+		for (int i = 0; i < world.getFactionCount(); ++i) {
+			Faction *faction = world.getFaction(i);
+
+			MutexSafeWrapper
+				safeMutex(server->getSlotMutex
+				(faction->getStartLocationIndex()), CODE_AT_LINE);
+			ConnectionSlot *slot =
+				server->getSlot(faction->getStartLocationIndex(), false);
+			if (slot != NULL
+				&& slot->getJoinGameInProgress() == true
+				&& slot->getSentSavedGameInfo() == false) {
+
+				safeMutex.ReleaseLock();
+				NetworkMessageReady networkMessageReady(0);
+				slot->sendMessage(&networkMessageReady);
+
+				slot =
+					server->getSlot(faction->getStartLocationIndex(), false);
+				if (slot != NULL) {
+					slot->setSentSavedGameInfo(true);
+				}
+			}
+		}
+	}
+
+	void Game::waitForNetworkGameSave() {
+		if (saveGameThread != NULL) {
+			if (saveGameThread->canShutdown(true) == true &&
+				saveGameThread->shutdownAndWait() == true) {
+				delete saveGameThread;
+			}
+			saveGameThread = NULL;
+		}
 	}
 
 	void
@@ -9132,12 +9381,21 @@ namespace Game {
 		if (joinGameSettings == NULL
 			&& config.getBool("SaveCommandsForReplay", "false") == true) {
 			XmlTree xmlTreeReplay(XML_RAPIDXML_ENGINE);
+			ReplayFile replayFile;
 			std::map < string, string > mapExtraTagReplacementValues;
-			xmlTreeReplay.load(name + ".replay",
-				Properties::getTagReplacementValues
-				(&mapExtraTagReplacementValues), true);
-
-			const XmlNode *rootNode = xmlTreeReplay.getRootNode();
+			const XmlNode *rootNode = NULL;
+			bool binaryReplay = ReplayFile::isReplayFile(name + ".replay");
+			if (binaryReplay == true) {
+				replayFile.load(name + ".replay",
+					Properties::getTagReplacementValues
+					(&mapExtraTagReplacementValues));
+				rootNode = replayFile.getRootNode();
+			} else {
+				xmlTreeReplay.load(name + ".replay",
+					Properties::getTagReplacementValues
+					(&mapExtraTagReplacementValues), true);
+				rootNode = xmlTreeReplay.getRootNode();
+			}
 
 			if (rootNode->hasChild("glest-saved-game") == true) {
 				rootNode = rootNode->getChild("glest-saved-game");
@@ -9183,29 +9441,97 @@ namespace Game {
 			//newGameSettings.loadGame(gameNode);
 			//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Game settings loaded\n");
 
+			int lastWorldFrameCount =
+				gameNode->getAttribute("LastWorldFrameCount")->getIntValue();
+
+			// ReplaySeekSeconds picks an earlier point to resume from, the
+			// recorded commands after it then play at game speed
+			int seekFrame = lastWorldFrameCount;
+			int replaySeekSeconds = config.getInt("ReplaySeekSeconds", "-1");
+			if (replaySeekSeconds >= 0) {
+				seekFrame =
+					min(replaySeekSeconds * GameConstants::updateFps,
+						lastWorldFrameCount);
+			}
+
+			// Start from the last keyframe before the seek frame and only
+			// simulate the commands after it
+			int keyframeIndex =
+				(binaryReplay == true ?
+					replayFile.findKeyframe(seekFrame) : -1);
+			if (keyframeIndex >= 0) {
+				int keyframeFrame =
+					replayFile.getKeyframes()[keyframeIndex].first;
+				if (SystemFlags::VERBOSE_MODE_ENABLED)
+					printf("Replay resumes from keyframe at frame %d, seeking to %d of %d\n",
+						keyframeFrame, seekFrame, lastWorldFrameCount);
+
+				XmlNode *keyframeNode =
+					replayFile.loadKeyframe(keyframeIndex,
+						Properties::getTagReplacementValues
+						(&mapExtraTagReplacementValues));
+				try {
+					Game *newGame =
+						loadGameFromNode(keyframeNode, programPtr,
+							isMasterserverMode, NULL);
+					newGame->lastworldFrameCountForReplay = lastWorldFrameCount;
+					newGame->commander.setReplaySeekFrame(
+						replaySeekSeconds >= 0 ? seekFrame : -1);
+					newGame->replayKeyframeList = replayFile.getKeyframes();
+					replayFile.getCommandsUpTo(keyframeFrame,
+						newGame->replayCommandList);
+
+					ReplayFile::CommandList commandList;
+					replayFile.getCommandsAfter(keyframeFrame, commandList);
+					for (unsigned int i = 0; i < commandList.size(); ++i) {
+						newGame->commander.addToReplayCommandList(commandList[i].
+							second, commandList[i].first);
+					}
+
+					programPtr->setState(newGame);
+				} catch (...) {
+					delete keyframeNode;
+					throw;
+				}
+				delete keyframeNode;
+				return;
+			}
+
 			NetworkManager & networkManager = NetworkManager::getInstance();
 			networkManager.end();
 			networkManager.init(nrServer, true);
 
 			Game *newGame =
 				new Game(programPtr, &newGameSettingsReplay, isMasterserverMode);
-			newGame->lastworldFrameCountForReplay =
-				gameNode->getAttribute("LastWorldFrameCount")->getIntValue();
+			newGame->lastworldFrameCountForReplay = lastWorldFrameCount;
+			newGame->commander.setReplaySeekFrame(
+				replaySeekSeconds >= 0 ? seekFrame : -1);
 
-			vector < XmlNode * >networkCommandNodeList =
-				gameNode->getChildList("NetworkCommand");
-			if (SystemFlags::VERBOSE_MODE_ENABLED)
-				printf("networkCommandNodeList.size() = " SIZE_T_SPECIFIER
-					"\n", networkCommandNodeList.size());
-			for (unsigned int i = 0; i < networkCommandNodeList.size(); ++i) {
-				XmlNode *node = networkCommandNodeList[i];
-				int
-					worldFrameCount =
-					node->getAttribute("worldFrameCount")->getIntValue();
-				NetworkCommand command;
-				command.loadGame(node);
-				newGame->commander.addToReplayCommandList(command,
-					worldFrameCount);
+			if (binaryReplay == true) {
+				newGame->replayKeyframeList = replayFile.getKeyframes();
+
+				ReplayFile::CommandList commandList;
+				replayFile.getCommandsAfter(INT_MIN, commandList);
+				for (unsigned int i = 0; i < commandList.size(); ++i) {
+					newGame->commander.addToReplayCommandList(commandList[i].
+						second, commandList[i].first);
+				}
+			} else {
+				vector < XmlNode * >networkCommandNodeList =
+					gameNode->getChildList("NetworkCommand");
+				if (SystemFlags::VERBOSE_MODE_ENABLED)
+					printf("networkCommandNodeList.size() = " SIZE_T_SPECIFIER
+						"\n", networkCommandNodeList.size());
+				for (unsigned int i = 0; i < networkCommandNodeList.size(); ++i) {
+					XmlNode *node = networkCommandNodeList[i];
+					int
+						worldFrameCount =
+						node->getAttribute("worldFrameCount")->getIntValue();
+					NetworkCommand command;
+					command.loadGame(node);
+					newGame->commander.addToReplayCommandList(command,
+						worldFrameCount);
+				}
 			}
 
 			programPtr->setState(newGame);
@@ -9223,7 +9549,17 @@ namespace Game {
 		if (SystemFlags::VERBOSE_MODE_ENABLED)
 			printf("After load of XML\n");
 
-		const XmlNode *rootNode = xmlTree.getRootNode();
+		Game *newGame =
+			loadGameFromNode(xmlTree.getRootNode(), programPtr,
+				isMasterserverMode, joinGameSettings);
+		programPtr->setState(newGame);
+	}
+
+	// Builds the game from a saved game tree, which has to outlive the
+	// caller's setState since loading the world reads from it
+	Game *Game::loadGameFromNode(const XmlNode * rootNode,
+		Program * programPtr, bool isMasterserverMode,
+		const GameSettings * joinGameSettings) {
 		if (rootNode->hasChild("glest-saved-game") == true) {
 			rootNode = rootNode->getChild("glest-saved-game");
 		}
@@ -9504,6 +9840,6 @@ namespace Game {
 		newGame->world.loadGame(worldNode);
 		if (SystemFlags::VERBOSE_MODE_ENABLED)
 			printf("Starting Game ...\n");
-		programPtr->setState(newGame);
+		return newGame;
 	}
 } //end namespace
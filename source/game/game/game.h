@@ -37,6 +37,7 @@
 #include "network_interface.h"
 #include "data_types.h"
 #include "selection.h"
+#include "base_thread.h"
 #include "leak_dumper.h"
 
 using std::vector;
@@ -65,6 +66,75 @@ namespace Game {
 			lgt_Scenario)
 	};
 
+	// =====================================================
+	//      class SaveGameThread
+	//
+	//      Writes a saved game tree built on the main thread to
+	//      disk, and zips it when asked, off the main thread
+	// =====================================================
+	class SaveGameThread : public BaseThread {
+	protected:
+		XmlTree *xmlTree;
+		string saveGameFile;
+		string compressedFile;
+		bool binary;
+		int compressionLevel;
+
+		Mutex *mutexSaveCompleted;
+		bool saveCompleted;
+		bool saveResult;
+
+		void setSaveCompleted(bool result);
+
+	public:
+		SaveGameThread(XmlTree * xmlTree, const string & saveGameFile,
+			const string & compressedFile, bool binary,
+			int compressionLevel);
+		virtual ~SaveGameThread();
+		virtual void execute();
+		virtual bool canShutdown(bool deleteSelfIfShutdownDelayed = false);
+
+		bool getSaveCompleted();
+		bool getSaveResult();
+		const string & getSaveGameFile() const {
+			return saveGameFile;
+		}
+	};
+
+	// =====================================================
+	//      class ReplayKeyframeThread
+	//
+	//      Serializes and compresses a replay keyframe tree built
+	//      on the main thread, off the main thread
+	// =====================================================
+	class ReplayKeyframeThread : public BaseThread {
+	protected:
+		XmlTree *xmlTree;
+		int frame;
+		int compressionLevel;
+		string keyframeData;
+
+		Mutex *mutexCompleted;
+		bool completed;
+
+		void setCompleted();
+
+	public:
+		ReplayKeyframeThread(XmlTree * xmlTree, int frame,
+			int compressionLevel);
+		virtual ~ReplayKeyframeThread();
+		virtual void execute();
+
+		bool getCompleted();
+		int getFrame() const {
+			return frame;
+		}
+		// empty if serializing failed, only valid once completed
+		const string & getKeyframeData() const {
+			return keyframeData;
+		}
+	};
+
 	// =====================================================
 	//      class Game
 	//
@@ -215,6 +285,9 @@ namespace Game {
 		XmlNode *loadGameNode;
 		int lastworldFrameCountForReplay;
 		std::vector < std::pair < int, NetworkCommand > > replayCommandList;
+		// frame and binary saved game of each replay keyframe
+		std::vector < std::pair < int, string > > replayKeyframeList;
+		int replayKeyframeInterval;
 
 		std::vector < string > streamingVideos;
 		::Shared::Graphics::VideoPlayer * videoPlayer;
@@ -238,6 +311,9 @@ namespace Game {
 		bool networkPauseGameForLaggedClientsRequested;
 		bool networkResumeGameForLaggedClientsRequested;
 
+		SaveGameThread *saveGameThread;
+		ReplayKeyframeThread *replayKeyframeThread;
+
 	public:
 		Game();
 		Game(Program * program, const GameSettings * gameSettings,
@@ -539,6 +615,17 @@ namespace Game {
 		std::map < int, int > getTeamsAlive();
 		void initCamera(Map * map);
 
+		string getSaveGameFilePath(string name, const string & path);
+		void saveGameToTree(XmlTree & xmlTree);
+		void startNetworkGameSave();
+		void checkNetworkGameSaveCompleted();
+		void waitForNetworkGameSave();
+		void recordReplayKeyframeIfRequired();
+		void checkReplayKeyframeCompleted(bool wait);
+		static Game *loadGameFromNode(const XmlNode * rootNode,
+			Program * programPtr, bool isMasterserverMode,
+			const GameSettings * joinGameSettings);
+
 		virtual bool
 			clientLagHandler(int slotIndex,
 				bool networkPauseGameForLaggedClients);
@@ -0,0 +1,355 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#include "replay_file.h"
+
+#include <cstdio>
+#include <cstring>
+#include <climits>
+
+#include "xml_binary.h"
+#include "conversion.h"
+#include "util.h"
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Xml;
+using namespace Shared::Util;
+using namespace Shared::Platform;
+
+namespace Game {
+
+	static const char replayFileMagic[4] = { 'G', 'R', 'P', 'L' };
+	static const uint32 replayFileVersion = 1;
+	// the delta encoding restarts at the first command of each
+	// span, one minute of game time at the default update rate
+	static const int replayFrameIndexInterval = 40 * 60;
+
+	static void writeUInt(string & out, uint32 value) {
+		out.append((const char *) &value, sizeof(value));
+	}
+
+	static void writeVarInt(string & out, int64 value) {
+		// zigzag so small negative deltas stay short
+		uint64 bits = ((uint64) value << 1) ^ (uint64) (value >> 63);
+		while (bits >= 0x80) {
+			out.push_back((char) ((bits & 0x7F) | 0x80));
+			bits >>= 7;
+		}
+		out.push_back((char) bits);
+	}
+
+	static uint32 readUInt(const char *data, uint32 & offset, uint32 end) {
+		if (end - offset < sizeof(uint32)) {
+			throw game_runtime_error("Replay file is truncated");
+		}
+		uint32 value = 0;
+		memcpy(&value, data + offset, sizeof(value));
+		offset += sizeof(value);
+		return value;
+	}
+
+	static int64 readVarInt(const char *data, uint32 & offset, uint32 end) {
+		uint64 bits = 0;
+		for (int shift = 0;; shift += 7) {
+			if (offset >= end || shift > 63) {
+				throw game_runtime_error("Replay command data is corrupt");
+			}
+			unsigned char byte = (unsigned char) data[offset++];
+			bits |= (uint64) (byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0) {
+				break;
+			}
+		}
+		return (int64) (bits >> 1) ^ -(int64) (bits & 1);
+	}
+
+	static void writeCommand(string & out, const NetworkCommand & command,
+		const NetworkCommand & previous) {
+		writeVarInt(out, (int64) command.networkCommandType - previous.networkCommandType);
+		writeVarInt(out, (int64) command.unitId - previous.unitId);
+		writeVarInt(out, (int64) command.unitTypeId - previous.unitTypeId);
+		writeVarInt(out, (int64) command.commandTypeId - previous.commandTypeId);
+		writeVarInt(out, (int64) command.positionX - previous.positionX);
+		writeVarInt(out, (int64) command.positionY - previous.positionY);
+		writeVarInt(out, (int64) command.targetId - previous.targetId);
+		writeVarInt(out, (int64) command.wantQueue - previous.wantQueue);
+		writeVarInt(out, (int64) command.fromFactionIndex - previous.fromFactionIndex);
+		writeVarInt(out, (int64) command.unitFactionUnitCount - previous.unitFactionUnitCount);
+		writeVarInt(out, (int64) command.unitFactionIndex - previous.unitFactionIndex);
+		writeVarInt(out, (int64) command.commandStateType - previous.commandStateType);
+		writeVarInt(out, (int64) command.commandStateValue - previous.commandStateValue);
+		writeVarInt(out, (int64) command.unitCommandGroupId - previous.unitCommandGroupId);
+	}
+
+	static void readCommand(const char *data, uint32 & offset, uint32 end,
+		NetworkCommand & command) {
+		command.networkCommandType = (int16) (command.networkCommandType + readVarInt(data, offset, end));
+		command.unitId = (int32) (command.unitId + readVarInt(data, offset, end));
+		command.unitTypeId = (int16) (command.unitTypeId + readVarInt(data, offset, end));
+		command.commandTypeId = (int16) (command.commandTypeId + readVarInt(data, offset, end));
+		command.positionX = (int16) (command.positionX + readVarInt(data, offset, end));
+		command.positionY = (int16) (command.positionY + readVarInt(data, offset, end));
+		command.targetId = (int32) (command.targetId + readVarInt(data, offset, end));
+		command.wantQueue = (int8) (command.wantQueue + readVarInt(data, offset, end));
+		command.fromFactionIndex = (int8) (command.fromFactionIndex + readVarInt(data, offset, end));
+		command.unitFactionUnitCount = (uint16) (command.unitFactionUnitCount + readVarInt(data, offset, end));
+		command.unitFactionIndex = (int8) (command.unitFactionIndex + readVarInt(data, offset, end));
+		command.commandStateType = (int8) (command.commandStateType + readVarInt(data, offset, end));
+		command.commandStateValue = (int32) (command.commandStateValue + readVarInt(data, offset, end));
+		command.unitCommandGroupId = (int32) (command.unitCommandGroupId + readVarInt(data, offset, end));
+	}
+
+	// =====================================================
+	//      class ReplayFile
+	// =====================================================
+
+	ReplayFile::ReplayFile() {
+		rootNode = NULL;
+		commandCount = 0;
+	}
+
+	ReplayFile::~ReplayFile() {
+		delete rootNode;
+		rootNode = NULL;
+	}
+
+	bool ReplayFile::isReplayFile(const string & path) {
+#ifdef WIN32
+		FILE *fp = _wfopen(utf8_decode(path).c_str(), L"rb");
+#else
+		FILE *fp = fopen(path.c_str(), "rb");
+#endif
+		if (fp == NULL) {
+			return false;
+		}
+		char magic[sizeof(replayFileMagic)];
+		bool result = (fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+			memcmp(magic, replayFileMagic, sizeof(magic)) == 0);
+		fclose(fp);
+		return result;
+	}
+
+	void ReplayFile::save(const string & path, const XmlNode * rootNode,
+		const CommandList & commandList, const KeyframeList & keyframeList) {
+		string out(replayFileMagic, sizeof(replayFileMagic));
+		writeUInt(out, replayFileVersion);
+
+		string settings = XmlIoBinary::saveToMemory(rootNode);
+		writeUInt(out, (uint32) settings.size());
+		out.append(settings);
+		settings.clear();
+
+		string commands;
+		vector < FrameIndexEntry > index;
+		NetworkCommand previous;
+		int previousFrame = 0;
+		int nextIndexFrame = INT_MIN;
+		for (unsigned int i = 0; i < commandList.size(); ++i) {
+			int frame = commandList[i].first;
+			if (frame >= nextIndexFrame) {
+				FrameIndexEntry entry;
+				entry.frame = frame;
+				entry.commandIndex = i;
+				entry.offset = (uint32) commands.size();
+				index.push_back(entry);
+
+				previous = NetworkCommand();
+				previousFrame = 0;
+				nextIndexFrame =
+					(frame / replayFrameIndexInterval + 1) * replayFrameIndexInterval;
+			}
+			writeVarInt(commands, (int64) frame - previousFrame);
+			writeCommand(commands, commandList[i].second, previous);
+			previous = commandList[i].second;
+			previousFrame = frame;
+		}
+
+		writeUInt(out, (uint32) commandList.size());
+		writeUInt(out, (uint32) commands.size());
+		out.append(commands);
+		commands.clear();
+
+		writeUInt(out, (uint32) index.size());
+		for (unsigned int i = 0; i < index.size(); ++i) {
+			writeUInt(out, (uint32) index[i].frame);
+			writeUInt(out, index[i].commandIndex);
+			writeUInt(out, index[i].offset);
+		}
+
+		writeUInt(out, (uint32) keyframeList.size());
+		for (unsigned int i = 0; i < keyframeList.size(); ++i) {
+			writeUInt(out, (uint32) keyframeList[i].first);
+			writeUInt(out, (uint32) keyframeList[i].second.size());
+			out.append(keyframeList[i].second);
+		}
+
+#ifdef WIN32
+		FILE *fp = _wfopen(utf8_decode(path).c_str(), L"wb");
+#else
+		FILE *fp = fopen(path.c_str(), "wb");
+#endif
+		if (fp == NULL) {
+			throw game_runtime_error("Can not open file: [" + path + "]");
+		}
+		bool written = (fwrite(out.data(), 1, out.size(), fp) == out.size());
+		fclose(fp);
+		if (written == false) {
+			throw game_runtime_error("Error writing file: [" + path + "]");
+		}
+	}
+
+	void ReplayFile::load(const string & path,
+		const std::map < string, string > &mapTagReplacementValues) {
+#ifdef WIN32
+		FILE *fp = _wfopen(utf8_decode(path).c_str(), L"rb");
+#else
+		FILE *fp = fopen(path.c_str(), "rb");
+#endif
+		if (fp == NULL) {
+			throw game_runtime_error("Can not open file: [" + path + "]");
+		}
+		fseek(fp, 0, SEEK_END);
+		long fileSize = ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+		vector < char > buffer(fileSize > 0 ? fileSize : 1);
+		bool readOk = (fileSize > 0 &&
+			fread(&buffer[0], 1, fileSize, fp) == (size_t) fileSize);
+		fclose(fp);
+		if (readOk == false || fileSize < (long) sizeof(replayFileMagic) ||
+			memcmp(&buffer[0], replayFileMagic, sizeof(replayFileMagic)) != 0) {
+			throw game_runtime_error("Not a replay file: [" + path + "]");
+		}
+
+		const char *data = &buffer[0];
+		uint32 end = (uint32) fileSize;
+		uint32 offset = sizeof(replayFileMagic);
+		uint32 version = readUInt(data, offset, end);
+		if (version != replayFileVersion) {
+			throw game_runtime_error("Unsupported replay version: " + uIntToStr(version));
+		}
+
+		uint32 settingsSize = readUInt(data, offset, end);
+		if (end - offset < settingsSize) {
+			throw game_runtime_error("Replay file is truncated");
+		}
+		delete rootNode;
+		rootNode = XmlIoBinary::load(data + offset, settingsSize, mapTagReplacementValues, true);
+		offset += settingsSize;
+
+		commandCount = readUInt(data, offset, end);
+		uint32 commandSize = readUInt(data, offset, end);
+		if (end - offset < commandSize) {
+			throw game_runtime_error("Replay file is truncated");
+		}
+		commandData.assign(data + offset, commandSize);
+		offset += commandSize;
+
+		uint32 indexCount = readUInt(data, offset, end);
+		if (indexCount > commandCount) {
+			throw game_runtime_error("Replay file is corrupt");
+		}
+		frameIndex.resize(indexCount);
+		for (unsigned int i = 0; i < indexCount; ++i) {
+			frameIndex[i].frame = (int) readUInt(data, offset, end);
+			frameIndex[i].commandIndex = readUInt(data, offset, end);
+			frameIndex[i].offset = readUInt(data, offset, end);
+			if (frameIndex[i].offset > commandSize) {
+				throw game_runtime_error("Replay file is corrupt");
+			}
+		}
+
+		uint32 keyframeCount = readUInt(data, offset, end);
+		keyframes.clear();
+		for (unsigned int i = 0; i < keyframeCount; ++i) {
+			int frame = (int) readUInt(data, offset, end);
+			uint32 size = readUInt(data, offset, end);
+			if (end - offset < size) {
+				throw game_runtime_error("Replay file is truncated");
+			}
+			keyframes.push_back(make_pair(frame, string(data + offset, size)));
+			offset += size;
+		}
+	}
+
+	// Index of the last keyframe taken at or before the frame, -1 if none
+	int ReplayFile::findKeyframe(int frame) const {
+		int result = -1;
+		for (unsigned int i = 0; i < keyframes.size(); ++i) {
+			if (keyframes[i].first <= frame) {
+				result = i;
+			}
+		}
+		return result;
+	}
+
+	XmlNode *ReplayFile::loadKeyframe(int keyframeIndex,
+		const std::map < string, string > &mapTagReplacementValues) const {
+		const string & keyframe = keyframes.at(keyframeIndex).second;
+		return XmlIoBinary::load(keyframe.data(), keyframe.size(),
+			mapTagReplacementValues, true);
+	}
+
+	void ReplayFile::getCommandsUpTo(int frame, CommandList & commandList) const {
+		if (frameIndex.empty() == false) {
+			readCommands(0, INT_MIN, frame, commandList);
+		}
+	}
+
+	// Decoding starts at the last index entry at or before the frame
+	void ReplayFile::getCommandsAfter(int frame, CommandList & commandList) const {
+		uint32 entryIndex = 0;
+		for (unsigned int i = 0; i < frameIndex.size() && frameIndex[i].frame <= frame; ++i) {
+			entryIndex = i;
+		}
+		if (frameIndex.empty() == false) {
+			readCommands(entryIndex, frame, INT_MAX, commandList);
+		}
+	}
+
+	// ==================== PRIVATE ====================
+
+	// Adds the commands with fromFrame < frame <= toFrame
+	void ReplayFile::readCommands(uint32 entryIndex, int fromFrame, int toFrame,
+		CommandList & commandList) const {
+		const char *data = commandData.data();
+		uint32 end = (uint32) commandData.size();
+		uint32 offset = frameIndex[entryIndex].offset;
+		uint32 nextEntry = entryIndex + 1;
+
+		NetworkCommand command;
+		int frame = 0;
+		for (uint32 i = frameIndex[entryIndex].commandIndex; i < commandCount; ++i) {
+			if (nextEntry < frameIndex.size() && frameIndex[nextEntry].commandIndex == i) {
+				command = NetworkCommand();
+				frame = 0;
+				nextEntry++;
+			}
+			frame += (int) readVarInt(data, offset, end);
+			readCommand(data, offset, end, command);
+			if (frame > toFrame) {
+				break;
+			}
+			if (frame > fromFrame) {
+				commandList.push_back(make_pair(frame, command));
+			}
+		}
+	}
+
+} //end namespace
@@ -0,0 +1,103 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _REPLAYFILE_H_
+#define _REPLAYFILE_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include "network_types.h"
+#include "xml_parser.h"
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::string;
+using std::vector;
+using std::pair;
+using Shared::Xml::XmlNode;
+
+namespace Game {
+
+	// =====================================================
+	//      class ReplayFile
+	//
+	///     Binary replay stream: the game settings, every network
+	///     command delta encoded against the one before it, an index
+	///     of where each span of frames starts, and saved game
+	///     keyframes taken while the game was played. A replay is
+	///     resumed from the last keyframe before the wanted frame.
+	// =====================================================
+
+	class ReplayFile {
+	public:
+		typedef vector < pair < int, NetworkCommand > > CommandList;
+		// frame and the binary saved game taken at that frame
+		typedef vector < pair < int, string > > KeyframeList;
+
+	private:
+		class FrameIndexEntry {
+		public:
+			int frame;
+			uint32 commandIndex;
+			uint32 offset;
+		};
+
+		XmlNode *rootNode;
+		uint32 commandCount;
+		string commandData;
+		vector < FrameIndexEntry > frameIndex;
+		KeyframeList keyframes;
+
+		void readCommands(uint32 entryIndex, int fromFrame, int toFrame,
+			CommandList & commandList) const;
+
+	public:
+		ReplayFile();
+		~ReplayFile();
+
+		static bool isReplayFile(const string & path);
+		static void save(const string & path, const XmlNode * rootNode,
+			const CommandList & commandList,
+			const KeyframeList & keyframeList);
+
+		void load(const string & path,
+			const std::map < string, string > &mapTagReplacementValues);
+
+		const XmlNode *getRootNode() const {
+			return rootNode;
+		}
+		int getCommandCount() const {
+			return (int) commandCount;
+		}
+		const KeyframeList & getKeyframes() const {
+			return keyframes;
+		}
+
+		int findKeyframe(int frame) const;
+		XmlNode *loadKeyframe(int keyframeIndex,
+			const std::map < string, string > &mapTagReplacementValues) const;
+
+		void getCommandsUpTo(int frame, CommandList & commandList) const;
+		void getCommandsAfter(int frame, CommandList & commandList) const;
+	};
+
+} //end namespace
+
+#endif
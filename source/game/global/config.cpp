@@ -119,6 +119,7 @@ namespace Game {
 	const char *Config::frustumPicking = "frustum";
 
 	map < string, string > Config::customRuntimeProperties;
+	int Config::version = 0;
 
 	// =====================================================
 	//      class Config
@@ -436,6 +437,7 @@ namespace Game {
 
 			configList.insert(map < ConfigType,
 				Config >::value_type(type.first, config));
+			version++;
 
 			if (SystemFlags::VERBOSE_MODE_ENABLED)
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).
@@ -455,6 +457,7 @@ namespace Game {
 		dest->fileName = src->fileName;
 		dest->fileNameParameter = src->fileNameParameter;
 		dest->fileLoaded = src->fileLoaded;
+		version++;
 	}
 
 	void Config::reload() {
@@ -714,6 +717,7 @@ namespace Game {
 	//}
 
 	void Config::setInt(const string & key, int value, bool tempBuffer) {
+		version++;
 		if (tempBuffer == true) {
 			tempProperties.setInt(key, value);
 			return;
@@ -726,6 +730,7 @@ namespace Game {
 	}
 
 	void Config::setBool(const string & key, bool value, bool tempBuffer) {
+		version++;
 		if (tempBuffer == true) {
 			tempProperties.setBool(key, value);
 			return;
@@ -740,6 +745,7 @@ namespace Game {
 	}
 
 	void Config::setFloat(const string & key, float value, bool tempBuffer) {
+		version++;
 		if (tempBuffer == true) {
 			tempProperties.setFloat(key, value);
 			return;
@@ -755,6 +761,7 @@ namespace Game {
 
 	void Config::setString(const string & key, const string & value,
 		bool tempBuffer) {
+		version++;
 		if (tempBuffer == true) {
 			tempProperties.setString(key, value);
 			return;
@@ -819,6 +826,7 @@ namespace Game {
 	void Config::setUserProperties(const vector < pair < string,
 		string > >&valueList) {
 		Properties & propertiesObj = properties.second;
+		version++;
 
 		for (unsigned int idx = 0; idx < valueList.size(); ++idx) {
 			const pair < string, string > &nameValuePair = valueList[idx];
@@ -67,6 +67,9 @@ namespace Game {
 
 		static map < string, string > customRuntimeProperties;
 
+		// changes whenever any config is created, reloaded or set
+		static int version;
+
 	public:
 
 		static const char *glestkeys_ini_filename;
@@ -136,6 +139,10 @@ namespace Game {
 
 		string toString();
 
+		static int getVersion() {
+			return version;
+		}
+
 		static string getCustomRuntimeProperty(string key) {
 			return customRuntimeProperties[key];
 		}
@@ -149,6 +156,53 @@ namespace Game {
 			"", bool errorOnNotFound = true);
 	};
 
+	// =====================================================
+	//      class ConfigValue
+	//
+	///     One setting of the main game config, looked up again only
+	///     after a config was reloaded or set. For code reading the same
+	///     setting every frame, declare it once and call get(). Not for
+	///     use from the worker threads.
+	// =====================================================
+
+	template<typename T> class ConfigValue {
+	private:
+		const char *key;
+		const char *defaultValue;
+		T value;
+		int configVersion;
+
+		static void read(const char *key, const char *defaultValue, bool &result) {
+			result = Config::getInstance().getBool(key, defaultValue);
+		}
+		static void read(const char *key, const char *defaultValue, int &result) {
+			result = Config::getInstance().getInt(key, defaultValue);
+		}
+		static void read(const char *key, const char *defaultValue, float &result) {
+			result = Config::getInstance().getFloat(key, defaultValue);
+		}
+
+	public:
+		ConfigValue(const char *key, const char *defaultValue) {
+			this->key = key;
+			this->defaultValue = defaultValue;
+			this->value = T();
+			this->configVersion = -1;
+		}
+
+		T get() {
+			if (configVersion != Config::getVersion()) {
+				read(key, defaultValue, value);
+				configVersion = Config::getVersion();
+			}
+			return value;
+		}
+	};
+
+	typedef ConfigValue<bool> ConfigBool;
+	typedef ConfigValue<int> ConfigInt;
+	typedef ConfigValue<float> ConfigFloat;
+
 } //end namespace
 
 #endif
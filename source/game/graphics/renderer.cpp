@@ -202,6 +202,9 @@ namespace Game {
 			}
 			particleManager[i] = graphicsFactory->newParticleManager();
 		}
+		if (config.getBool("EnableTaskPoolParticleUpdate", "false") == true) {
+			particleManager[rsGame]->setWorkerCount(config.getInt("TaskPoolWorkerCount", "-1"));
+		}
 
 		if (GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false) {
 			static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
@@ -5803,6 +5803,11 @@ namespace Game {
 			}
 		}
 
+		if (hasCommandArgument
+		(argc, argv, string(GAME_ARGS[GAME_ARG_BENCHMARK])) == true) {
+			GlobalStaticFlags::setIsNonGraphicalModeEnabled(true);
+		}
+
 		if (hasCommandArgument(argc, argv, GAME_ARGS[GAME_ARG_SERVER_TITLE]) ==
 			true) {
 			int
@@ -6430,7 +6435,9 @@ namespace Game {
 				|| hasCommandArgument(argc, argv,
 					string(GAME_ARGS
 						[GAME_ARG_MASTERSERVER_MODE])) ==
-				true) {
+				true
+				|| hasCommandArgument(argc, argv,
+					string(GAME_ARGS[GAME_ARG_BENCHMARK])) == true) {
 				config.setString("FactorySound", "None", true);
 				if (hasCommandArgument
 				(argc, argv,
@@ -6975,6 +6982,79 @@ namespace Game {
 				}
 			}
 
+			if (hasCommandArgument
+			(argc, argv, string(GAME_ARGS[GAME_ARG_BENCHMARK])) == true) {
+				int
+					foundParamIndIndex = -1;
+				hasCommandArgument(argc, argv,
+					string(GAME_ARGS[GAME_ARG_BENCHMARK]) +
+					string("="), &foundParamIndIndex);
+				if (foundParamIndIndex < 0) {
+					hasCommandArgument(argc, argv,
+						string(GAME_ARGS[GAME_ARG_BENCHMARK]),
+						&foundParamIndIndex);
+				}
+				string
+					paramValue = argv[foundParamIndIndex];
+				vector < string > paramPartTokens;
+				Tokenize(paramValue, paramPartTokens, "=");
+				vector < string > paramPartTokens2;
+				if (paramPartTokens.size() >= 2
+					&& paramPartTokens[1].length() > 0) {
+					Tokenize(paramPartTokens[1], paramPartTokens2, ",");
+				}
+				if (paramPartTokens2.size() < 2 || strToInt(paramPartTokens2[0]) <= 0
+					|| paramPartTokens2[1].length() == 0) {
+					printf
+					("\nInvalid benchmark parameters specified on commandline [%s]\n\n",
+						argv[foundParamIndIndex]);
+					printParameterHelp(argv[0], false);
+					return 1;
+				}
+
+				Config::getInstance().setBool("AutoTest", true, true);
+				int
+					benchmarkFrames = strToInt(paramPartTokens2[0]);
+				string
+					benchmarkOutputFile = (paramPartTokens2.size() >= 3 ? paramPartTokens2[2] : "");
+				AutoTest::setBenchmark(benchmarkFrames, benchmarkOutputFile);
+				AutoTest::setLoadGameSettingsFile(paramPartTokens2[1]);
+				AutoTest::setWantExitGameWhenDone(true);
+
+				printf("Running headless benchmark of %d frames using game settings file [%s]\n",
+					benchmarkFrames, paramPartTokens2[1].c_str());
+			}
+
+			if (hasCommandArgument
+			(argc, argv, string(GAME_ARGS[GAME_ARG_REPLAY_SEEK])) == true) {
+				int
+					foundParamIndIndex = -1;
+				hasCommandArgument(argc, argv,
+					string(GAME_ARGS[GAME_ARG_REPLAY_SEEK]) +
+					string("="), &foundParamIndIndex);
+				if (foundParamIndIndex < 0) {
+					hasCommandArgument(argc, argv,
+						string(GAME_ARGS[GAME_ARG_REPLAY_SEEK]),
+						&foundParamIndIndex);
+				}
+				string
+					paramValue = argv[foundParamIndIndex];
+				vector < string > paramPartTokens;
+				Tokenize(paramValue, paramPartTokens, "=");
+				if (paramPartTokens.size() < 2
+					|| IsNumeric(paramPartTokens[1].c_str(), false) == false) {
+					printf
+					("\nInvalid replay seek specified on commandline [%s]\n\n",
+						argv[foundParamIndIndex]);
+					printParameterHelp(argv[0], false);
+					return 1;
+				}
+
+				// read by Game::loadGame when it loads the replay
+				Config::getInstance().setInt("ReplaySeekSeconds",
+					strToInt(paramPartTokens[1]), true);
+			}
+
 			Renderer & renderer = Renderer::getInstance();
 			lang.loadGameStrings(language, false, true);
 
@@ -7188,6 +7268,14 @@ namespace Game {
 			} else if (hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_MASTERSERVER_MODE])) == true) {
 				program->initServer(mainWindow, false, true, true);
 				gameInitialized = true;
+			} else if (hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_BENCHMARK])) == true) {
+				if (CoreData::getInstance().loadGameSettingsFromFile(
+					AutoTest::getLoadGameSettingsFile(), &startupGameSettings) == false) {
+					throw game_runtime_error("Specified game settings file [" +
+						AutoTest::getLoadGameSettingsFile() + "] was NOT found!");
+				}
+				program->initBenchmark(mainWindow, &startupGameSettings);
+				gameInitialized = true;
 			} else if (hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_AUTOSTART_LASTGAME])) == true) {
 				program->initServer(mainWindow, true, false);
 				gameInitialized = true;
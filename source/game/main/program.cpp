@@ -375,6 +375,14 @@ namespace Game {
 			autoloadScenarioName));
 	}
 
+	// Starts the game straight away without any menus, used by the
+	// headless benchmark which is driven from AutoTest
+	void
+		Program::initBenchmark(WindowGl * window, GameSettings * settings) {
+		init(window);
+		setState(new Game(this, settings, false));
+	}
+
 	Program::~Program() {
 		if (SystemFlags::VERBOSE_MODE_ENABLED)
 			printf("In [%s::%s Line: %d]\n",
@@ -360,6 +360,8 @@ namespace Game {
 			initClientAutoFindHost(WindowGl * window);
 		void
 			initScenario(WindowGl * window, string autoloadScenarioName);
+		void
+			initBenchmark(WindowGl * window, GameSettings * settings);
 
 		//main
 		bool textInput(std::string text);
@@ -568,7 +568,7 @@ namespace Game {
 					if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] got NetworkMessageIntro, networkMessageIntro.getGameState() = %d, versionString [%s], sessionKey = %d, playerIndex = %d, serverFTPPort = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, networkMessageIntro.getGameState(), versionString.c_str(), sessionKey, playerIndex, serverFTPPort);
 
 					//check consistency
-					bool compatible = checkVersionCompatibility(GameVersionString, networkMessageIntro.getVersionString());
+					bool compatible = checkVersionCompatibility(getNetworkVersionString(), networkMessageIntro.getVersionString());
 
 					if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] got NetworkMessageIntro, networkMessageIntro.getGameState() = %d, versionString [%s], sessionKey = %d, playerIndex = %d, serverFTPPort = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, networkMessageIntro.getGameState(), versionString.c_str(), sessionKey, playerIndex, serverFTPPort);
 
@@ -577,12 +577,12 @@ namespace Game {
 
 						string playerNameStr = getHumanPlayerName();
 						string sErr = "Server and client binary mismatch!\nYou have to use the exactly same binaries!\n\nServer: " + networkMessageIntro.getVersionString() +
-							"\nClient: " + GameVersionString + " player [" + playerNameStr + "]";
+							"\nClient: " + getNetworkVersionString() + " player [" + playerNameStr + "]";
 						printf("%s\n", sErr.c_str());
 
 						sendTextMessage("Server and client binary mismatch", -1, true, "");
 						sendTextMessage(" Server:" + networkMessageIntro.getVersionString(), -1, true, "");
-						sendTextMessage(" Client: " + GameVersionString, -1, true, "");
+						sendTextMessage(" Client: " + getNetworkVersionString(), -1, true, "");
 						sendTextMessage(" Client player [" + playerNameStr + "]", -1, true, "");
 					}
 
@@ -597,7 +597,7 @@ namespace Game {
 						//send intro message
 						Lang &lang = Lang::getInstance();
 						NetworkMessageIntro sendNetworkMessageIntro(
-							sessionKey, GameVersionString,
+							sessionKey, getNetworkVersionString(),
 							getHumanPlayerName(),
 							-1,
 							nmgstOk,
@@ -250,12 +250,15 @@ namespace Game {
 							break;
 						}
 
-						PLATFORM_SOCKET socketId = socket->getSocketId();
 						safeMutex.ReleaseLock();
 
-						// Avoid mutex locking
-						//bool socketHasReadData = Socket::hasDataToRead(socket->getSocketId());
-						bool socketHasReadData = Socket::hasDataToReadWithWait(socketId, 150000);
+						// The server update signals this thread when its poller
+						// finds data on the slot's socket. Signals piled up during
+						// the last read are dropped, the poller signals again on
+						// the next update if data is left.
+						bool socketHasReadData = (semTaskSignalled.waitTillSignalled(150) == 0);
+						while (socketHasReadData == true && semTaskSignalled.tryDecrement() == true) {
+						}
 
 						if (getQuitStatus() == true) {
 							if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
@@ -619,7 +622,7 @@ namespace Game {
 
 							NetworkMessageIntro networkMessageIntro(
 								sessionKey,
-								GameVersionString,
+								getNetworkVersionString(),
 								getHostName(),
 								playerIndex,
 								nmgstOk,
@@ -872,7 +875,7 @@ namespace Game {
 										//check consistency
 										if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
-										bool compatible = checkVersionCompatibility(networkMessageIntro.getVersionString(), GameVersionString);
+										bool compatible = checkVersionCompatibility(networkMessageIntro.getVersionString(), getNetworkVersionString());
 
 										if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
@@ -880,12 +883,12 @@ namespace Game {
 											if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
 											string playerNameStr = name;
-											string sErr = "Server and client version mismatch!\nYou have to use the exactly same versions!\n\nServer: " + GameVersionString +
+											string sErr = "Server and client version mismatch!\nYou have to use the exactly same versions!\n\nServer: " + getNetworkVersionString() +
 												"\nClient: " + networkMessageIntro.getVersionString() + " player [" + playerNameStr + "]";
 											printf("%s\n", sErr.c_str());
 
 											serverInterface->sendTextMessage("Server and client version mismatch", -1, true, "", lockedSlotIndex);
-											serverInterface->sendTextMessage(" Server:" + GameVersionString, -1, true, "", lockedSlotIndex);
+											serverInterface->sendTextMessage(" Server:" + getNetworkVersionString(), -1, true, "", lockedSlotIndex);
 											serverInterface->sendTextMessage(" Client: " + networkMessageIntro.getVersionString(), -1, true, "", lockedSlotIndex);
 											serverInterface->sendTextMessage(" Client player [" + playerNameStr + "]", -1, true, "", lockedSlotIndex);
 										}
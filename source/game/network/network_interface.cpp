@@ -59,6 +59,8 @@ namespace Game {
 		for (unsigned int index = 0; index < (unsigned int) GameConstants::maxPlayers; ++index) {
 			networkPlayerFactionCRC[index] = 0;
 		}
+
+		Socket::setSocketClosedCallback(&NetworkMessageCommandList::socketClosed);
 	}
 
 	void NetworkInterface::init() {
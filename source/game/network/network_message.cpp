@@ -93,31 +93,18 @@ namespace Game {
 		}
 	}
 
+	// The message type (and compressed length) go out in the same send as
+	// the payload through a socket send batch, instead of copying
+	// everything into a new buffer per message
 	void NetworkMessage::send(Socket* socket, const void* data, int dataSize, int8 messageType) {
 		if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] socket = %p, data = %p, dataSize = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, socket, data, dataSize);
 
 		if (socket != NULL) {
-			int msgTypeSize = sizeof(messageType);
-			int fullMsgSize = msgTypeSize + dataSize;
-
-			char *out_buffer = new char[fullMsgSize];
-			memcpy(out_buffer, &messageType, msgTypeSize);
-			memcpy(&out_buffer[msgTypeSize], (const char *) data, dataSize);
-
-			dump_packet("\nOUTGOING PACKET:\n", out_buffer, fullMsgSize, true);
-			int sendResult = socket->send(out_buffer, fullMsgSize);
-			if (sendResult != fullMsgSize) {
-				delete[] out_buffer;
-				if (socket != NULL && socket->isSocketValid() == true) {
-					char szBuf[8096] = "";
-					snprintf(szBuf, 8096, "Error sending NetworkMessage, sendResult = %d, dataSize = %d", sendResult, fullMsgSize);
-					throw game_runtime_error(szBuf);
-				} else {
-					if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] Line: %d socket has been disconnected\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
-				}
-			} else {
-				delete[] out_buffer;
-			}
+			socket->beginSendBatch();
+			socket->send(&messageType, sizeof(messageType));
+			socket->send(data, dataSize);
+			endSendBatch(socket, sizeof(messageType) + dataSize);
+			dump_packet("\nOUTGOING PACKET:\n", data, dataSize, true);
 		}
 	}
 
@@ -125,28 +112,23 @@ namespace Game {
 		if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] socket = %p, data = %p, dataSize = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, socket, data, dataSize);
 
 		if (socket != NULL) {
-			int msgTypeSize = sizeof(messageType);
-			int compressedSize = sizeof(compressedLength);
-			int fullMsgSize = msgTypeSize + compressedSize + dataSize;
-
-			char *out_buffer = new char[fullMsgSize];
-			memcpy(out_buffer, &messageType, msgTypeSize);
-			memcpy(&out_buffer[msgTypeSize], &compressedLength, compressedSize);
-			memcpy(&out_buffer[msgTypeSize + compressedSize], (const char *) data, dataSize);
-
-			dump_packet("\nOUTGOING PACKET:\n", out_buffer, fullMsgSize, true);
-			int sendResult = socket->send(out_buffer, fullMsgSize);
-			if (sendResult != fullMsgSize) {
-				delete[] out_buffer;
-				if (socket != NULL && socket->isSocketValid() == true) {
-					char szBuf[8096] = "";
-					snprintf(szBuf, 8096, "Error sending NetworkMessage, sendResult = %d, dataSize = %d", sendResult, fullMsgSize);
-					throw game_runtime_error(szBuf);
-				} else {
-					if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] Line: %d socket has been disconnected\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
-				}
+			socket->beginSendBatch();
+			socket->send(&messageType, sizeof(messageType));
+			socket->send(&compressedLength, sizeof(compressedLength));
+			socket->send(data, dataSize);
+			endSendBatch(socket, sizeof(messageType) + sizeof(compressedLength) + dataSize);
+			dump_packet("\nOUTGOING PACKET:\n", data, dataSize, true);
+		}
+	}
+
+	void NetworkMessage::endSendBatch(Socket* socket, int dataSize) {
+		if (socket->endSendBatch() == false) {
+			if (socket->isSocketValid() == true) {
+				char szBuf[8096] = "";
+				snprintf(szBuf, 8096, "Error sending NetworkMessage, dataSize = %d", dataSize);
+				throw game_runtime_error(szBuf);
 			} else {
-				delete[] out_buffer;
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] Line: %d socket has been disconnected\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
 			}
 		}
 	}
@@ -1630,9 +1612,110 @@ namespace Game {
 	}
 
 	// =====================================================
-	//	class NetworkMessageLaunch
+	//	class NetworkMessageCommandList
 	// =====================================================
 
+	// flags byte that leads a compact command list
+	static const uint8 commandListFlagCompressed = 0x01;
+	static const uint8 commandListFlagLongSize = 0x02;
+	static const uint8 commandListFlagFullCRC = 0x04;
+	// larger lists are compressed when that makes them smaller
+	static const uint32 commandListCompressThreshold = 256;
+	static const uint32 commandListMaxPayloadSize = 8 * 1024 * 1024;
+	// all CRCs are sent again after this many lists on a connection
+	static const int commandListFullCRCInterval = 64;
+	static const int commandListFieldCount = 14;
+
+	static void writeVarInt(string & out, int64 value) {
+		// zigzag so small negative deltas stay short
+		uint64 bits = ((uint64) value << 1) ^ (uint64) (value >> 63);
+		while (bits >= 0x80) {
+			out.push_back((char) ((bits & 0x7F) | 0x80));
+			bits >>= 7;
+		}
+		out.push_back((char) bits);
+	}
+
+	static int64 readVarInt(const char *data, uint32 & offset, uint32 end) {
+		uint64 bits = 0;
+		for (int shift = 0;; shift += 7) {
+			if (offset >= end || shift > 63) {
+				throw game_runtime_error("Network command list is corrupt");
+			}
+			unsigned char byte = (unsigned char) data[offset++];
+			bits |= (uint64) (byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0) {
+				break;
+			}
+		}
+		return (int64) (bits >> 1) ^ -(int64) (bits & 1);
+	}
+
+	static void writeCommonUInt(string & out, uint32 value) {
+		for (int index = 0; index < 4; ++index) {
+			out.push_back((char) ((value >> (index * 8)) & 0xFF));
+		}
+	}
+
+	static uint32 readCommonUInt(const char *data, uint32 & offset, uint32 end) {
+		if (end - offset < 4) {
+			throw game_runtime_error("Network command list is corrupt");
+		}
+		uint32 value = 0;
+		for (int index = 0; index < 4; ++index) {
+			value |= (uint32) (unsigned char) data[offset++] << (index * 8);
+		}
+		return value;
+	}
+
+	static void writeCommand(string & out, const NetworkCommand & command,
+		const NetworkCommand & previous) {
+		writeVarInt(out, (int64) command.networkCommandType - previous.networkCommandType);
+		writeVarInt(out, (int64) command.unitId - previous.unitId);
+		writeVarInt(out, (int64) command.unitTypeId - previous.unitTypeId);
+		writeVarInt(out, (int64) command.commandTypeId - previous.commandTypeId);
+		writeVarInt(out, (int64) command.positionX - previous.positionX);
+		writeVarInt(out, (int64) command.positionY - previous.positionY);
+		writeVarInt(out, (int64) command.targetId - previous.targetId);
+		writeVarInt(out, (int64) command.wantQueue - previous.wantQueue);
+		writeVarInt(out, (int64) command.fromFactionIndex - previous.fromFactionIndex);
+		writeVarInt(out, (int64) command.unitFactionUnitCount - previous.unitFactionUnitCount);
+		writeVarInt(out, (int64) command.unitFactionIndex - previous.unitFactionIndex);
+		writeVarInt(out, (int64) command.commandStateType - previous.commandStateType);
+		writeVarInt(out, (int64) command.commandStateValue - previous.commandStateValue);
+		writeVarInt(out, (int64) command.unitCommandGroupId - previous.unitCommandGroupId);
+	}
+
+	static void readCommand(const char *data, uint32 & offset, uint32 end,
+		NetworkCommand & command) {
+		command.networkCommandType = (int16) (command.networkCommandType + readVarInt(data, offset, end));
+		command.unitId = (int32) (command.unitId + readVarInt(data, offset, end));
+		command.unitTypeId = (int16) (command.unitTypeId + readVarInt(data, offset, end));
+		command.commandTypeId = (int16) (command.commandTypeId + readVarInt(data, offset, end));
+		command.positionX = (int16) (command.positionX + readVarInt(data, offset, end));
+		command.positionY = (int16) (command.positionY + readVarInt(data, offset, end));
+		command.targetId = (int32) (command.targetId + readVarInt(data, offset, end));
+		command.wantQueue = (int8) (command.wantQueue + readVarInt(data, offset, end));
+		command.fromFactionIndex = (int8) (command.fromFactionIndex + readVarInt(data, offset, end));
+		command.unitFactionUnitCount = (uint16) (command.unitFactionUnitCount + readVarInt(data, offset, end));
+		command.unitFactionIndex = (int8) (command.unitFactionIndex + readVarInt(data, offset, end));
+		command.commandStateType = (int8) (command.commandStateType + readVarInt(data, offset, end));
+		command.commandStateValue = (int32) (command.commandStateValue + readVarInt(data, offset, end));
+		command.unitCommandGroupId = (int32) (command.unitCommandGroupId + readVarInt(data, offset, end));
+	}
+
+	auto_ptr<Mutex> NetworkMessageCommandList::mutexCRCState(new Mutex(CODE_AT_LINE));
+	std::map<const Socket *, NetworkMessageCommandList::CRCState> NetworkMessageCommandList::sentCRCState;
+	std::map<const Socket *, NetworkMessageCommandList::CRCState> NetworkMessageCommandList::receivedCRCState;
+
+	// a new connection may get the address of a deleted socket, so it
+	// must not inherit that socket's CRCs
+	void NetworkMessageCommandList::socketClosed(const Socket *socket) {
+		MutexSafeWrapper safeMutex(mutexCRCState.get(), CODE_AT_LINE);
+		sentCRCState.erase(socket);
+		receivedCRCState.erase(socket);
+	}
+
 	NetworkMessageCommandList::NetworkMessageCommandList(int32 frameCount) {
 		data.messageType = nmtCommandList;
 		data.header.frameCount = frameCount;
@@ -1648,169 +1731,148 @@ namespace Game {
 		return true;
 	}
 
-	const char * NetworkMessageCommandList::getPackedMessageFormatHeader() const {
-		return "cHlLLLLLLLL";
-	}
+	bool NetworkMessageCommandList::encodeCompact(const Socket *socket, string &out) {
+		MutexSafeWrapper safeMutex(mutexCRCState.get(), CODE_AT_LINE);
+		bool fullCRC = false;
+		std::map<const Socket *, CRCState>::iterator iterFind = sentCRCState.find(socket);
+		if (iterFind == sentCRCState.end()) {
+			iterFind = sentCRCState.insert(make_pair(socket, CRCState())).first;
+			fullCRC = true;
+		} else if (iterFind->second.listsSinceFullCRC >= commandListFullCRCInterval) {
+			fullCRC = true;
+		}
 
-	unsigned int NetworkMessageCommandList::getPackedSizeHeader() {
-		static unsigned int result = 0;
-		if (result == 0) {
-			Data packedData;
-			init(packedData);
-			unsigned char *buf = new unsigned char[sizeof(packedData) * 3];
-			result = pack(buf, getPackedMessageFormatHeader(),
-				packedData.messageType,
-				packedData.header.commandCount,
-				packedData.header.frameCount,
-				packedData.header.networkPlayerFactionCRC[0],
-				packedData.header.networkPlayerFactionCRC[1],
-				packedData.header.networkPlayerFactionCRC[2],
-				packedData.header.networkPlayerFactionCRC[3],
-				packedData.header.networkPlayerFactionCRC[4],
-				packedData.header.networkPlayerFactionCRC[5],
-				packedData.header.networkPlayerFactionCRC[6],
-				packedData.header.networkPlayerFactionCRC[7]);
-			delete[] buf;
+		CRCState &state = iterFind->second;
+		uint32 crcMask = 0;
+		for (int index = 0; index < GameConstants::maxPlayers; ++index) {
+			uint32 crc = data.header.networkPlayerFactionCRC[index];
+			if (fullCRC == true ? crc != 0 : crc != state.crc[index]) {
+				crcMask |= (1 << index);
+			}
+			state.crc[index] = crc;
 		}
-		return result;
-	}
-	void NetworkMessageCommandList::unpackMessageHeader(unsigned char *buf) {
-		unpack(buf, getPackedMessageFormatHeader(),
-			&data.messageType,
-			&data.header.commandCount,
-			&data.header.frameCount,
-			&data.header.networkPlayerFactionCRC[0],
-			&data.header.networkPlayerFactionCRC[1],
-			&data.header.networkPlayerFactionCRC[2],
-			&data.header.networkPlayerFactionCRC[3],
-			&data.header.networkPlayerFactionCRC[4],
-			&data.header.networkPlayerFactionCRC[5],
-			&data.header.networkPlayerFactionCRC[6],
-			&data.header.networkPlayerFactionCRC[7]);
-	}
-
-	unsigned char * NetworkMessageCommandList::packMessageHeader() {
-		unsigned char *buf = new unsigned char[getPackedSizeHeader() + 1];
-		pack(buf, getPackedMessageFormatHeader(),
-			data.messageType,
-			data.header.commandCount,
-			data.header.frameCount,
-			data.header.networkPlayerFactionCRC[0],
-			data.header.networkPlayerFactionCRC[1],
-			data.header.networkPlayerFactionCRC[2],
-			data.header.networkPlayerFactionCRC[3],
-			data.header.networkPlayerFactionCRC[4],
-			data.header.networkPlayerFactionCRC[5],
-			data.header.networkPlayerFactionCRC[6],
-			data.header.networkPlayerFactionCRC[7]);
-		return buf;
-	}
+		state.listsSinceFullCRC = (fullCRC == true ? 0 : state.listsSinceFullCRC + 1);
+		safeMutex.ReleaseLock();
 
-	const char * NetworkMessageCommandList::getPackedMessageFormatDetail() const {
-		return "hlhhhhlccHccll";
-	}
-
-	unsigned int NetworkMessageCommandList::getPackedSizeDetail(int count) {
-		unsigned int result = 0;
-		//if(result == 0) {
-		for (unsigned int i = 0; i < (unsigned int) count; ++i) {
-			NetworkCommand packedData;
-			unsigned char *buf = new unsigned char[sizeof(NetworkCommand) * 3];
-			result += pack(buf, getPackedMessageFormatDetail(),
-				packedData.networkCommandType,
-				packedData.unitId,
-				packedData.unitTypeId,
-				packedData.commandTypeId,
-				packedData.positionX,
-				packedData.positionY,
-				packedData.targetId,
-				packedData.wantQueue,
-				packedData.fromFactionIndex,
-				packedData.unitFactionUnitCount,
-				packedData.unitFactionIndex,
-				packedData.commandStateType,
-				packedData.commandStateValue,
-				packedData.unitCommandGroupId);
-			delete[] buf;
+		writeVarInt(out, data.header.commandCount);
+		writeVarInt(out, data.header.frameCount);
+		writeVarInt(out, crcMask);
+		for (int index = 0; index < GameConstants::maxPlayers; ++index) {
+			if ((crcMask & (1 << index)) != 0) {
+				writeCommonUInt(out, data.header.networkPlayerFactionCRC[index]);
+			}
 		}
-		//}
-		return result;
-	}
-	void NetworkMessageCommandList::unpackMessageDetail(unsigned char *buf, int count) {
-		data.commands.clear();
-		data.commands.resize(count);
-		//unsigned int bytes_processed_total = 0;
-		unsigned char *bufMove = buf;
-		for (unsigned int i = 0; i < (unsigned int) count; ++i) {
-			unsigned int bytes_processed = unpack(bufMove, getPackedMessageFormatDetail(),
-				&data.commands[i].networkCommandType,
-				&data.commands[i].unitId,
-				&data.commands[i].unitTypeId,
-				&data.commands[i].commandTypeId,
-				&data.commands[i].positionX,
-				&data.commands[i].positionY,
-				&data.commands[i].targetId,
-				&data.commands[i].wantQueue,
-				&data.commands[i].fromFactionIndex,
-				&data.commands[i].unitFactionUnitCount,
-				&data.commands[i].unitFactionIndex,
-				&data.commands[i].commandStateType,
-				&data.commands[i].commandStateValue,
-				&data.commands[i].unitCommandGroupId);
-			bufMove += bytes_processed;
-			//bytes_processed_total += bytes_processed;
+
+		NetworkCommand previous;
+		for (unsigned int index = 0; index < data.header.commandCount; ++index) {
+			writeCommand(out, data.commands[index], previous);
+			previous = data.commands[index];
 		}
-		//printf("\nUnPacked detail size = %u\n",bytes_processed_total);
+		return fullCRC;
 	}
 
-	unsigned char * NetworkMessageCommandList::packMessageDetail(uint16 totalCommand) {
-		int packetSize = getPackedSizeDetail(totalCommand) + 1;
-		unsigned char *buf = new unsigned char[packetSize];
-		unsigned char *bufMove = buf;
-		//unsigned int bytes_processed_total = 0;
-		for (unsigned int i = 0; i < totalCommand; ++i) {
-			unsigned int bytes_processed = pack(bufMove, getPackedMessageFormatDetail(),
-				data.commands[i].networkCommandType,
-				data.commands[i].unitId,
-				data.commands[i].unitTypeId,
-				data.commands[i].commandTypeId,
-				data.commands[i].positionX,
-				data.commands[i].positionY,
-				data.commands[i].targetId,
-				data.commands[i].wantQueue,
-				data.commands[i].fromFactionIndex,
-				data.commands[i].unitFactionUnitCount,
-				data.commands[i].unitFactionIndex,
-				data.commands[i].commandStateType,
-				data.commands[i].commandStateValue,
-				data.commands[i].unitCommandGroupId);
-			bufMove += bytes_processed;
-			//bytes_processed_total += bytes_processed;
+	void NetworkMessageCommandList::decodeCompact(const Socket *socket, bool fullCRC, const char *payload, uint32 size) {
+		uint32 offset = 0;
+		int64 commandCount = readVarInt(payload, offset, size);
+		// every command takes at least one byte per field
+		if (commandCount < 0 || commandCount > 0xFFFF || commandCount * commandListFieldCount > size) {
+			throw game_runtime_error("Network command list is corrupt");
+		}
+		data.header.commandCount = (uint16) commandCount;
+		data.header.frameCount = (int32) readVarInt(payload, offset, size);
+		uint32 crcMask = (uint32) readVarInt(payload, offset, size);
+
+		MutexSafeWrapper safeMutex(mutexCRCState.get(), CODE_AT_LINE);
+		std::map<const Socket *, CRCState>::iterator iterFind = receivedCRCState.find(socket);
+		if (iterFind == receivedCRCState.end()) {
+			if (fullCRC == false) {
+				throw game_runtime_error("Network command list refers to CRCs that were never received");
+			}
+			iterFind = receivedCRCState.insert(make_pair(socket, CRCState())).first;
+		}
+		CRCState &state = iterFind->second;
+		for (int index = 0; index < GameConstants::maxPlayers; ++index) {
+			if ((crcMask & (1 << index)) != 0) {
+				state.crc[index] = readCommonUInt(payload, offset, size);
+			} else if (fullCRC == true) {
+				state.crc[index] = 0;
+			}
+			data.header.networkPlayerFactionCRC[index] = state.crc[index];
+		}
+		safeMutex.ReleaseLock();
+
+		data.commands.clear();
+		data.commands.resize(data.header.commandCount);
+		for (unsigned int index = 0; index < data.header.commandCount; ++index) {
+			if (index > 0) {
+				data.commands[index] = data.commands[index - 1];
+			}
+			readCommand(payload, offset, size, data.commands[index]);
+		}
+		if (offset != size) {
+			throw game_runtime_error("Network command list is corrupt");
 		}
-		//printf("\nPacked detail size = %u, allocated = %d\n",bytes_processed_total,packetSize);
-		return buf;
 	}
 
 	bool NetworkMessageCommandList::receive(Socket* socket) {
 		if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
 
-		unsigned char *buf = NULL;
 		bool result = false;
 		if (useOldProtocol == true) {
 			result = NetworkMessage::receive(socket, &data.header, commandListHeaderSize, true);
 			if (result == true) {
 				data.messageType = this->getNetworkMessageType();
 			}
+			fromEndianHeader();
 
 			//printf("!!! =====> IN Network hdr cmd get frame: %d data.header.commandCount: %u\n",data.header.frameCount,data.header.commandCount);
 		} else {
-			buf = new unsigned char[getPackedSizeHeader() + 1];
-			result = NetworkMessage::receive(socket, buf, getPackedSizeHeader(), true);
-			unpackMessageHeader(buf);
-			//if(data.header.commandCount) printf("\n\nGot packet size = %u data.messageType = %d\n%s\ncommandcount [%u] framecount [%d]\n",getPackedSizeHeader(),data.header.messageType,buf,data.header.commandCount,data.header.frameCount);
-			delete[] buf;
+			// message type, flags and the low half of the stored size
+			unsigned char frameHeader[4];
+			result = NetworkMessage::receive(socket, frameHeader, sizeof(frameHeader), true);
+			if (result == true) {
+				data.messageType = (int8) frameHeader[0];
+				uint8 flags = frameHeader[1];
+				uint32 storedSize = (uint32) frameHeader[2] | ((uint32) frameHeader[3] << 8);
+				if ((flags & commandListFlagLongSize) != 0) {
+					unsigned char sizeHigh[2];
+					result = NetworkMessage::receive(socket, sizeHigh, sizeof(sizeHigh), true);
+					storedSize |= ((uint32) sizeHigh[0] << 16) | ((uint32) sizeHigh[1] << 24);
+				}
+				if (storedSize > commandListMaxPayloadSize) {
+					throw game_runtime_error("Network command list is too large: " + uIntToStr(storedSize));
+				}
+
+				std::vector<char> stored(storedSize + 1);
+				if (result == true && storedSize > 0) {
+					result = NetworkMessage::receive(socket, &stored[0], storedSize, true);
+				}
+				if (result == true) {
+					if ((flags & commandListFlagCompressed) != 0) {
+						uint32 offset = 0;
+						int64 rawSize = readVarInt(&stored[0], offset, storedSize);
+						if (rawSize <= 0 || rawSize > commandListMaxPayloadSize) {
+							throw game_runtime_error("Network command list is corrupt");
+						}
+						std::pair<unsigned char *, unsigned long> extracted =
+							Shared::CompressionUtil::extractMemoryToMemory((unsigned char *) &stored[offset], storedSize - offset, (unsigned long) rawSize);
+						if (extracted.second != (unsigned long) rawSize) {
+							delete[] extracted.first;
+							throw game_runtime_error("Network command list failed to decompress");
+						}
+						try {
+							decodeCompact(socket, (flags & commandListFlagFullCRC) != 0, (const char *) extracted.first, (uint32) rawSize);
+						} catch (...) {
+							delete[] extracted.first;
+							throw;
+						}
+						delete[] extracted.first;
+					} else {
+						decodeCompact(socket, (flags & commandListFlagFullCRC) != 0, &stored[0], storedSize);
+					}
+				}
+			}
 		}
-		fromEndianHeader();
 
 		if (result == true) {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] got header, messageType = %d, commandCount = %u, frameCount = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, data.messageType, data.header.commandCount, data.header.frameCount);
@@ -1818,25 +1880,16 @@ namespace Game {
 			//printf("!!! =====> IN Network cmd get frame: %d data.header.commandCount: %u\n",data.header.frameCount,data.header.commandCount);
 
 			if (data.header.commandCount > 0) {
-				data.commands.resize(data.header.commandCount);
-
 				if (useOldProtocol == true) {
+					data.commands.resize(data.header.commandCount);
 					int totalMsgSize = (sizeof(NetworkCommand) * data.header.commandCount);
 					result = NetworkMessage::receive(socket, &data.commands[0], totalMsgSize, true);
+					fromEndianDetail();
 
 					//				if(data.commands[0].getNetworkCommandType() == nctPauseResume) {
 					//					printf("=====> IN Network cmd type: %d [%d] frame: %d\n",data.commands[0].getNetworkCommandType(),nctPauseResume,data.header.frameCount);
 					//				}
-				} else {
-					//int totalMsgSize = (sizeof(NetworkCommand) * data.header.commandCount);
-					//result = NetworkMessage::receive(socket, &data.commands[0], totalMsgSize, true);
-					buf = new unsigned char[getPackedSizeDetail(data.header.commandCount) + 1];
-					result = NetworkMessage::receive(socket, buf, getPackedSizeDetail(data.header.commandCount), true);
-					unpackMessageDetail(buf, data.header.commandCount);
-					//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
-					delete[] buf;
 				}
-				fromEndianDetail();
 
 				//	        for(int idx = 0 ; idx < data.header.commandCount; ++idx) {
 				//	            const NetworkCommand &cmd = data.commands[idx];
@@ -1881,56 +1934,61 @@ namespace Game {
 
 		assert(data.messageType == nmtCommandList);
 		uint16 totalCommand = data.header.commandCount;
-		toEndianHeader();
-		toEndianDetail(totalCommand);
 
-		unsigned char *buf = NULL;
-		//bool result = false;
 		if (useOldProtocol == true) {
+			toEndianHeader();
+			toEndianDetail(totalCommand);
+
 			//printf("<===== OUT Network hdr cmd type: frame: %d totalCommand: %u [%u]\n",data.header.frameCount,totalCommand,data.header.commandCount);
 			//NetworkMessage::send(socket, &data.messageType, sizeof(data.messageType));
 
 			//NetworkMessage::send(socket, &data.header, commandListHeaderSize, data.messageType);
-			unsigned char *send_buffer = getData();
+			// header and commands straight from this message, one send
 			int headerSize = sizeof(data.header);
 			uint16 totalCommand = data.header.commandCount;
 			int detailSize = (sizeof(NetworkCommand) * totalCommand);
-			int fullBufferSize = headerSize + detailSize;
-			NetworkMessage::send(socket, send_buffer, fullBufferSize, data.messageType);
-			delete[] send_buffer;
-		} else {
-			//NetworkMessage::send(socket, &data.header, commandListHeaderSize);
-			buf = packMessageHeader();
-			//if(totalCommand) printf("\n\nSend packet size = %u data.messageType = %d\n%s\ncommandcount [%u] framecount [%d]\n",getPackedSizeHeader(),data.header.messageType,buf,totalCommand,data.header.frameCount);
-			NetworkMessage::send(socket, buf, getPackedSizeHeader());
-			delete[] buf;
-		}
-
-		if (totalCommand > 0) {
-			//printf("\n#2 Send packet commandcount [%u] framecount [%d]\n",totalCommand,data.header.frameCount);
-			//toEndianDetail(totalCommand);
-			//printf("\n#3 Send packet commandcount [%u] framecount [%d]\n",totalCommand,data.header.frameCount);
+			if (socket != NULL) {
+				socket->beginSendBatch();
+				socket->send(&data.messageType, sizeof(data.messageType));
+				socket->send(&data.header, headerSize);
+				if (detailSize > 0) {
+					socket->send(&data.commands[0], detailSize);
+				}
+				endSendBatch(socket, sizeof(data.messageType) + headerSize + detailSize);
+				dump_packet("\nOUTGOING PACKET:\n", &data.header, headerSize, true);
+			}
+		} else if (socket != NULL) {
+			string payload;
+			uint8 flags = (encodeCompact(socket, payload) == true ? commandListFlagFullCRC : 0);
+			if (payload.size() > commandListCompressThreshold) {
+				std::pair<unsigned char *, unsigned long> compressed =
+					Shared::CompressionUtil::compressMemoryToMemory((unsigned char *) payload.data(), (unsigned long) payload.size());
+				// the raw size goes first so the receiver can size its buffer
+				string stored;
+				writeVarInt(stored, (int64) payload.size());
+				if (compressed.first != NULL && stored.size() + compressed.second < payload.size()) {
+					stored.append((const char *) compressed.first, compressed.second);
+					payload.swap(stored);
+					flags |= commandListFlagCompressed;
+				}
+				delete[] compressed.first;
+			}
 
-			//bool result = false;
-			if (useOldProtocol == true) {
-				//			if(data.commands[0].getNetworkCommandType() == nctPauseResume) {
-				//				printf("<===== OUT Network cmd type: %d [%d] frame: %d totalCommand: %u [%u]\n",data.commands[0].getNetworkCommandType(),nctPauseResume,data.header.frameCount,totalCommand,data.header.commandCount);
-				//			}
-							//NetworkMessage::send(socket, &data.commands[0], (sizeof(NetworkCommand) * totalCommand));
-			} else {
-				buf = packMessageDetail(totalCommand);
-				//printf("\n#4 Send packet commandcount [%u] framecount [%d]\n",totalCommand,data.header.frameCount);
-				//printf("Send packet size = %u data.messageType = %d\n[%s]\n",getPackedSize(),data.messageType,buf);
-				NetworkMessage::send(socket, buf, getPackedSizeDetail(totalCommand));
-				//printf("\n#5 Send packet commandcount [%u] framecount [%d]\n",totalCommand,data.header.frameCount);
-				delete[] buf;
-				//printf("\n#6 Send packet commandcount [%u] framecount [%d]\n",totalCommand,data.header.frameCount);
-
-		//        for(int idx = 0 ; idx < totalCommand; ++idx) {
-		//            const NetworkCommand &cmd = data.commands[idx];
-		//            printf("========> Send index = %d / %u, sent networkCommand [%s]\n",idx, totalCommand,cmd.toString().c_str());
-		//        }
+			uint32 storedSize = (uint32) payload.size();
+			if (storedSize > 0xFFFF) {
+				flags |= commandListFlagLongSize;
+			}
+			string frame;
+			frame.reserve(5 + payload.size());
+			frame.push_back((char) flags);
+			frame.push_back((char) (storedSize & 0xFF));
+			frame.push_back((char) ((storedSize >> 8) & 0xFF));
+			if ((flags & commandListFlagLongSize) != 0) {
+				frame.push_back((char) ((storedSize >> 16) & 0xFF));
+				frame.push_back((char) ((storedSize >> 24) & 0xFF));
 			}
+			frame.append(payload);
+			NetworkMessage::send(socket, frame.data(), (int) frame.size(), data.messageType);
 		}
 
 		if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled == true) {
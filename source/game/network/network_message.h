@@ -139,6 +139,7 @@ namespace Game {
 		void send(Socket* socket, const void* data, int dataSize);
 		void send(Socket* socket, const void* data, int dataSize, int8 messageType);
 		void send(Socket* socket, const void* data, int dataSize, int8 messageType, uint32 compressedLength);
+		void endSendBatch(Socket* socket, int dataSize);
 
 		virtual const char * getPackedMessageFormat() const = 0;
 		virtual unsigned int getPackedSize() = 0;
@@ -470,6 +471,11 @@ namespace Game {
 	//	class CommandList
 	//
 	//	Message to order a commands to several units
+	//
+	//	With the new protocol the list is sent compact: varint
+	//	counts, each command delta coded against the one before,
+	//	only the faction CRCs that changed, and large bursts
+	//	compressed
 	// =====================================================
 
 #pragma pack(push, 1)
@@ -504,6 +510,28 @@ namespace Game {
 		void toEndianDetail(uint16 totalCommand);
 		void fromEndianDetail();
 
+		// CRCs last sent to or received from one connection, the new
+		// protocol only sends the ones that changed since then. Entries
+		// are dropped when their socket is closed.
+		class CRCState {
+		public:
+			uint32 crc[GameConstants::maxPlayers];
+			int listsSinceFullCRC;
+
+			CRCState() : listsSinceFullCRC(0) {
+				for (int index = 0; index < GameConstants::maxPlayers; ++index) {
+					crc[index] = 0;
+				}
+			}
+		};
+
+		static auto_ptr<Mutex> mutexCRCState;
+		static std::map<const Socket *, CRCState> sentCRCState;
+		static std::map<const Socket *, CRCState> receivedCRCState;
+
+		bool encodeCompact(const Socket *socket, string &out);
+		void decodeCompact(const Socket *socket, bool fullCRC, const char *payload, uint32 size);
+
 	private:
 		Data data;
 
@@ -520,16 +548,6 @@ namespace Game {
 			return NULL;
 		}
 
-		const char * getPackedMessageFormatHeader() const;
-		unsigned int getPackedSizeHeader();
-		void unpackMessageHeader(unsigned char *buf);
-		unsigned char * packMessageHeader();
-
-		const char * getPackedMessageFormatDetail() const;
-		unsigned int getPackedSizeDetail(int count);
-		void unpackMessageDetail(unsigned char *buf, int count);
-		unsigned char * packMessageDetail(uint16 totalCommand);
-
 	public:
 		explicit NetworkMessageCommandList(int32 frameCount = -1);
 
@@ -544,6 +562,8 @@ namespace Game {
 
 		bool addCommand(const NetworkCommand* networkCommand);
 
+		static void socketClosed(const Socket *socket);
+
 		void clear() {
 			data.header.commandCount = 0;
 		}
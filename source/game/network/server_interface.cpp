@@ -866,6 +866,54 @@ namespace Game {
 		}
 	}
 
+	// While a game runs the slot threads wait for the server update to
+	// find data on their sockets, only those with readable sockets are woken
+	void ServerInterface::signalReadyClientsInGame(std::map<PLATFORM_SOCKET, bool> & socketTriggeredList) {
+		for (int index = 0; exitServer == false && index < GameConstants::maxPlayers; ++index) {
+			MutexSafeWrapper safeMutexSlot(slotAccessorMutexes[index], CODE_AT_LINE_X(index));
+			ConnectionSlot *connectionSlot = slots[index];
+			if (connectionSlot != NULL) {
+				PLATFORM_SOCKET clientSocket = connectionSlot->getSocketId();
+				if (Socket::isSocketValid(&clientSocket) == true &&
+					socketTriggeredList[clientSocket] == true) {
+					connectionSlot->signalUpdate(NULL);
+				}
+			}
+		}
+	}
+
+	// While a game runs, everything sent to a client during one server
+	// update goes out in a single send per client. The sockets are looked
+	// up again at the end because a slot may have been dropped meanwhile.
+	void ServerInterface::beginSlotSendBatch() {
+		for (int index = 0; exitServer == false && index < GameConstants::maxPlayers; ++index) {
+			MutexSafeWrapper safeMutexSlot(slotAccessorMutexes[index], CODE_AT_LINE_X(index));
+			ConnectionSlot *connectionSlot = slots[index];
+			if (connectionSlot != NULL && connectionSlot->isConnected() == true) {
+				Socket *socket = connectionSlot->getSocket();
+				if (socket != NULL) {
+					socket->beginSendBatch();
+				}
+			}
+		}
+	}
+
+	void ServerInterface::endSlotSendBatch() {
+		for (int index = 0; index < GameConstants::maxPlayers; ++index) {
+			MutexSafeWrapper safeMutexSlot(slotAccessorMutexes[index], CODE_AT_LINE_X(index));
+			ConnectionSlot *connectionSlot = slots[index];
+			if (connectionSlot != NULL) {
+				Socket *socket = connectionSlot->getSocket();
+				if (socket != NULL && socket->endSendBatch() == false) {
+					// endSendBatch closed the socket, the slot now reports
+					// it is not connected and is dropped like any client
+					// that went away
+					SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] send batch to slot %d failed, client disconnected\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, index);
+				}
+			}
+		}
+	}
+
 	void ServerInterface::validateConnectedClients() {
 		for (int index = 0; exitServer == false && index < GameConstants::maxPlayers; ++index) {
 			MutexSafeWrapper safeMutexSlot(slotAccessorMutexes[index], CODE_AT_LINE_X(index));
@@ -1468,6 +1516,10 @@ namespace Game {
 		//printf("\nServerInterface::update -- A\n");
 
 		std::vector <string> errorMsgList;
+		const bool batchSlotSends = gameHasBeenInitiated;
+		if (batchSlotSends == true) {
+			beginSlotSendBatch();
+		}
 		try {
 			// The first thing we will do is check all clients to ensure they have
 			// properly identified themselves within the alloted time period
@@ -1494,10 +1546,13 @@ namespace Game {
 
 				std::map<int, ConnectionSlotEvent> eventList;
 
-				bool hasData = false;
-				if (gameHasBeenInitiated == false) {
-					hasData = Socket::hasDataToRead(socketTriggeredList);
-				} else {
+				bool hasData = slotSocketPoller.hasDataToRead(socketTriggeredList);
+				if (gameHasBeenInitiated == true) {
+					// slot threads may hold messages read earlier, so the
+					// queues below are processed even without new data
+					if (hasData == true) {
+						signalReadyClientsInGame(socketTriggeredList);
+					}
 					hasData = true;
 				}
 
@@ -1641,6 +1696,9 @@ namespace Game {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] error detected [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, ex.what());
 			errorMsgList.push_back(ex.what());
 		}
+		if (batchSlotSends == true) {
+			endSlotSendBatch();
+		}
 
 		if (errorMsgList.empty() == false) {
 			for (int iErrIdx = 0; iErrIdx < (int) errorMsgList.size(); ++iErrIdx) {
@@ -83,6 +83,8 @@ namespace Game {
 		Mutex *slotAccessorMutexes[GameConstants::maxPlayers];
 
 		ServerSocket serverSocket;
+		// read readiness of the slot sockets, kept between updates
+		SocketEventPoller slotSocketPoller;
 
 		Mutex *switchSetupRequestsSynchAccessor;
 		SwitchSetupRequest* switchSetupRequests[GameConstants::maxPlayers];
@@ -248,6 +250,9 @@ namespace Game {
 		std::pair<bool, bool> clientLagCheck(ConnectionSlot *connectionSlot, bool skipNetworkBroadCast = false);
 		bool signalClientReceiveCommands(ConnectionSlot *connectionSlot, int slotIndex, bool socketTriggered, ConnectionSlotEvent & event);
 		void updateSocketTriggeredList(std::map<PLATFORM_SOCKET, bool> & socketTriggeredList);
+		void signalReadyClientsInGame(std::map<PLATFORM_SOCKET, bool> & socketTriggeredList);
+		void beginSlotSendBatch();
+		void endSlotSendBatch();
 		bool isPortBound() const {
 			return serverSocket.isPortBound();
 		}
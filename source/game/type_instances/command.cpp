@@ -39,6 +39,7 @@ namespace Game {
 		stateType = cst_None;
 		stateValue = -1;
 		unitCommandGroupId = -1;
+		crcDirty = true;
 	}
 
 	Command::Command(const CommandType * ct, const Vec2i & pos) :unitRef() {
@@ -51,6 +52,7 @@ namespace Game {
 		stateType = cst_None;
 		stateValue = -1;
 		unitCommandGroupId = -1;
+		crcDirty = true;
 	}
 
 	Command::Command(const CommandType * ct, Unit * unit) {
@@ -66,6 +68,7 @@ namespace Game {
 		stateType = cst_None;
 		stateValue = -1;
 		unitCommandGroupId = -1;
+		crcDirty = true;
 	}
 
 	Command::Command(const CommandType * ct, const Vec2i & pos,
@@ -79,6 +82,7 @@ namespace Game {
 		stateType = cst_None;
 		stateValue = -1;
 		unitCommandGroupId = -1;
+		crcDirty = true;
 
 		//if(this->unitType != NULL) {
 		//      SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] unitType = [%s]\n",__FILE__,__FUNCTION__,__LINE__,this->unitType->toString().c_str());
@@ -96,10 +100,12 @@ namespace Game {
 
 	void Command::setCommandType(const CommandType * commandType) {
 		this->commandType = commandType;
+		crcDirty = true;
 	}
 
 	void Command::setPos(const Vec2i & pos) {
 		this->pos = pos;
+		crcDirty = true;
 	}
 
 	//void Command::setOriginalPos(const Vec2i &pos) {
@@ -108,10 +114,12 @@ namespace Game {
 
 	void Command::setPosToOriginalPos() {
 		this->pos = this->originalPos;
+		crcDirty = true;
 	}
 
 	void Command::setUnit(Unit * unit) {
 		this->unitRef = unit;
+		crcDirty = true;
 	}
 
 	std::string Command::toString(bool translatedValue) const {
@@ -184,6 +192,22 @@ namespace Game {
 		return crcForCmd;
 	}
 
+	void Command::addCRC64(Checksum64 & crc) const {
+		crc.addInt(commandType->getId());
+		crc.addInt(originalPos.x);
+		crc.addInt(originalPos.y);
+		crc.addInt(pos.x);
+		crc.addInt(pos.y);
+		crc.addInt(unitRef.getUnitId());
+		crc.addInt(facing);
+		if (unitType != NULL) {
+			crc.addInt(unitType->getId());
+		}
+		crc.addInt(stateType);
+		crc.addInt(stateValue);
+		crc.addInt(unitCommandGroupId);
+	}
+
 	void Command::saveGame(XmlNode * rootNode, Faction * faction) {
 		std::map < string, string > mapTagReplacements;
 		XmlNode *commandNode = rootNode->addChild("Command");
@@ -62,6 +62,8 @@ namespace Game {
 
 		int unitCommandGroupId;
 
+		bool crcDirty;
+
 		Command();
 	public:
 		//constructor
@@ -105,6 +107,7 @@ namespace Game {
 
 		inline void setStateType(CommandStateType value) {
 			stateType = value;
+			crcDirty = true;
 		}
 		inline CommandStateType getStateType() const {
 			return stateType;
@@ -112,6 +115,7 @@ namespace Game {
 
 		inline void setStateValue(int value) {
 			stateValue = value;
+			crcDirty = true;
 		}
 		inline int getStateValue() const {
 			return stateValue;
@@ -119,6 +123,7 @@ namespace Game {
 
 		inline void setUnitCommandGroupId(int value) {
 			unitCommandGroupId = value;
+			crcDirty = true;
 		}
 		inline int getUnitCommandGroupId() const {
 			return unitCommandGroupId;
@@ -131,6 +136,14 @@ namespace Game {
 			World * world);
 
 		Checksum getCRC();
+		void addCRC64(Checksum64 & crc) const;
+		// set by the setters, the owning unit rehashes while it is set
+		inline bool isCRCDirty() const {
+			return crcDirty;
+		}
+		inline void clearCRCDirty() {
+			crcDirty = false;
+		}
 	};
 
 } //end namespace
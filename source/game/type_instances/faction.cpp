@@ -1841,6 +1841,8 @@ namespace Game {
 				const int harvestDistance = 5;
 				const Map *map = world->getMap();
 				Vec2i pos = unit->getPos();
+				// squares of the map without this type are skipped whole
+				int typeIndex = map->getResourceBucketTypeIndex(type);
 
 				bool foundCloseResource = false;
 				// First look immediately around the unit's position
@@ -1859,6 +1861,11 @@ namespace Game {
 						for (int k = -harvestDistance;
 							k <= harvestDistance && foundCloseResource == false; ++k) {
 							Vec2i newPos = pos + Vec2i(j, k);
+							if (map->isInside(newPos) == true &&
+								map->hasResourcesInBucket(newPos.x, newPos.y, typeIndex) == false) {
+								k = Map::getUnitBucketLastCoord(newPos.y) - pos.y;
+								continue;
+							}
 							if (map->isInside(newPos) == true
 								&& isResourceTargetInCache(newPos) == false) {
 								const SurfaceCell *sc =
@@ -1891,6 +1898,11 @@ namespace Game {
 						for (int k = harvestDistance;
 							k >= -harvestDistance && foundCloseResource == false; --k) {
 							Vec2i newPos = pos + Vec2i(j, k);
+							if (map->isInside(newPos) == true &&
+								map->hasResourcesInBucket(newPos.x, newPos.y, typeIndex) == false) {
+								k = Map::getUnitBucketFirstCoord(newPos.y) - pos.y;
+								continue;
+							}
 							if (map->isInside(newPos) == true
 								&& isResourceTargetInCache(newPos) == false) {
 								const SurfaceCell *sc =
@@ -1995,6 +2007,8 @@ namespace Game {
 
 				const int harvestDistance = 5;
 				const Map *map = world->getMap();
+				// squares of the map without this type are skipped whole
+				int typeIndex = map->getResourceBucketTypeIndex(type);
 
 				bool foundCloseResource = false;
 
@@ -2011,6 +2025,11 @@ namespace Game {
 						for (int k = -harvestDistance;
 							k <= harvestDistance && foundCloseResource == false; ++k) {
 							Vec2i newPos = pos + Vec2i(j, k);
+							if (map->isInside(newPos) == true &&
+								map->hasResourcesInBucket(newPos.x, newPos.y, typeIndex) == false) {
+								k = Map::getUnitBucketLastCoord(newPos.y) - pos.y;
+								continue;
+							}
 							if (map->isInside(newPos) == true
 								&& isResourceTargetInCache(newPos) == false) {
 								const SurfaceCell *sc =
@@ -2040,6 +2059,11 @@ namespace Game {
 						for (int k = harvestDistance;
 							k >= -harvestDistance && foundCloseResource == false; --k) {
 							Vec2i newPos = pos + Vec2i(j, k);
+							if (map->isInside(newPos) == true &&
+								map->hasResourcesInBucket(newPos.x, newPos.y, typeIndex) == false) {
+								k = Map::getUnitBucketFirstCoord(newPos.y) - pos.y;
+								continue;
+							}
 							if (map->isInside(newPos) == true
 								&& isResourceTargetInCache(newPos) == false) {
 								const SurfaceCell *sc =
@@ -2887,59 +2911,90 @@ namespace Game {
 		}
 	}
 
-	Checksum Faction::getCRC() {
-		const bool consoleDebug = false;
-
-		Checksum crcForFaction;
+	// units per inner node of the faction CRC tree
+	static const unsigned int CRC_UNITS_PER_GROUP = 32;
 
-		// UpgradeManager upgradeManager;
+	// The faction CRC is the root of a two level hash tree: one leaf per
+	// unit, one node per group of units, and the root over those nodes
+	// and the resources. A group is only hashed again when one of its
+	// leaves changed, and getCRC_TreeDetails shows which group (and so
+	// which units) differ when two players go out of synch.
+	uint64 Faction::getCRC() {
+		const bool consoleDebug = false;
 
+		Checksum64 crcForResources;
 		for (unsigned int i = 0; i < resources.size(); ++i) {
-			Resource & resource = resources[i];
-			//crcForFaction.addSum(resource.getCRC().getSum());
-			uint32 crc = resource.getCRC().getSum();
-			crcForFaction.addBytes(&crc, sizeof(uint32));
+			resources[i].addCRC64(crcForResources);
 		}
-
-		if (consoleDebug) {
-			if (getWorld()->getFrameCount() % 40 == 0) {
-				printf("#1 Frame #: %d Faction: %d CRC: %u\n",
-					getWorld()->getFrameCount(), index,
-					crcForFaction.getSum());
-			}
+		for (unsigned int i = 0; i < store.size(); ++i) {
+			store[i].addCRC64(crcForResources);
 		}
 
-		for (unsigned int i = 0; i < store.size(); ++i) {
-			Resource & resource = store[i];
-			//crcForFaction.addSum(resource.getCRC().getSum());
-			uint32 crc = resource.getCRC().getSum();
-			crcForFaction.addBytes(&crc, sizeof(uint32));
+		const unsigned int unitCount = (unsigned int) units.size();
+		const unsigned int groupCount =
+			(unitCount + CRC_UNITS_PER_GROUP - 1) / CRC_UNITS_PER_GROUP;
+		std::vector < bool > groupChanged(groupCount,
+			crcUnitHashes.size() != unitCount);
+		crcUnitHashes.resize(unitCount);
+		crcGroupHashes.resize(groupCount);
+
+		for (unsigned int i = 0; i < unitCount; ++i) {
+			uint64 crc = units[i]->getCRC64();
+			if (crc != crcUnitHashes[i]) {
+				crcUnitHashes[i] = crc;
+				groupChanged[i / CRC_UNITS_PER_GROUP] = true;
+			}
+		}
+
+		Checksum64 crcForFaction;
+		crcForFaction.addUInt64(crcForResources.getSum());
+		crcForFaction.addInt(unitCount);
+		for (unsigned int group = 0; group < groupCount; ++group) {
+			if (groupChanged[group] == true) {
+				Checksum64 crcForGroup;
+				unsigned int last =
+					min((group + 1) * CRC_UNITS_PER_GROUP, unitCount);
+				for (unsigned int i = group * CRC_UNITS_PER_GROUP; i < last; ++i) {
+					crcForGroup.addInt(units[i]->getId());
+					crcForGroup.addUInt64(crcUnitHashes[i]);
+				}
+				crcGroupHashes[group] = crcForGroup.getSum();
+			}
+			crcForFaction.addUInt64(crcGroupHashes[group]);
 		}
 
 		if (consoleDebug) {
 			if (getWorld()->getFrameCount() % 40 == 0) {
-				printf("#2 Frame #: %d Faction: %d CRC: %u\n",
+				printf("Frame #: %d Faction: %d CRC: %u\n",
 					getWorld()->getFrameCount(), index,
-					crcForFaction.getSum());
+					Checksum64::fold(crcForFaction.getSum()));
 			}
 		}
 
-		for (unsigned int i = 0; i < units.size(); ++i) {
-			Unit *unit = units[i];
-			//crcForFaction.addSum(unit->getCRC().getSum());
-			uint32 crc = unit->getCRC().getSum();
-			crcForFaction.addBytes(&crc, sizeof(uint32));
-		}
+		return crcForFaction.getSum();
+	}
 
-		if (consoleDebug) {
-			if (getWorld()->getFrameCount() % 40 == 0) {
-				printf("#3 Frame #: %d Faction: %d CRC: %u\n",
-					getWorld()->getFrameCount(), index,
-					crcForFaction.getSum());
+	string Faction::getCRC_TreeDetails() const {
+		string result = "CRC tree groups: " + uIntToStr((uint32) crcGroupHashes.size()) + "\n";
+		char szBuf[128] = "";
+		for (unsigned int group = 0; group < crcGroupHashes.size(); ++group) {
+			unsigned int first = group * CRC_UNITS_PER_GROUP;
+			unsigned int last =
+				min(first + CRC_UNITS_PER_GROUP, (unsigned int) crcUnitHashes.size());
+			if (first >= last || last > units.size()) {
+				break;
+			}
+			snprintf(szBuf, 128, "group %u units [%d..%d] hash %016llx\n",
+				group, units[first]->getId(), units[last - 1]->getId(),
+				(unsigned long long) crcGroupHashes[group]);
+			result += szBuf;
+			for (unsigned int i = first; i < last; ++i) {
+				snprintf(szBuf, 128, "  unit %d hash %016llx\n",
+					units[i]->getId(), (unsigned long long) crcUnitHashes[i]);
+				result += szBuf;
 			}
 		}
-
-		return crcForFaction;
+		return result;
 	}
 
 	void Faction::addCRC_DetailsForWorldFrame(int worldFrameCount,
@@ -2948,7 +3003,8 @@ namespace Game {
 		if (isNetworkServer == true) {
 			MAX_FRAME_CACHE += 250;
 		}
-		crcWorldFrameDetails[worldFrameCount] = this->toString(true);
+		crcWorldFrameDetails[worldFrameCount] =
+			this->toString(true) + "\n" + getCRC_TreeDetails();
 		//if(worldFrameCount <= 0) printf("Adding world frame: %d log entries: %lld\n",worldFrameCount,(long long int)crcWorldFrameDetails.size());
 
 		for (unsigned int i = 0; i < units.size(); ++i) {
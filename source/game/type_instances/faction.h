@@ -204,6 +204,9 @@ namespace Game {
 		std::vector < string > worldSynchThreadedLogList;
 
 		std::map < int, string > crcWorldFrameDetails;
+		// last getCRC leaf hash per unit and hash per group of units
+		std::vector < uint64 > crcUnitHashes;
+		std::vector < uint64 > crcGroupHashes;
 
 		std::map < int, const Unit *>aliveUnitListCache;
 		std::map < int, const Unit *>mobileUnitListCache;
@@ -485,7 +488,8 @@ namespace Game {
 
 		void clearCaches();
 
-		Checksum getCRC();
+		uint64 getCRC();
+		string getCRC_TreeDetails() const;
 		void addCRC_DetailsForWorldFrame(int worldFrameCount,
 			bool isNetworkServer);
 		string getCRC_DetailsForWorldFrame(int worldFrameCount);
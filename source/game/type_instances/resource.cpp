@@ -171,4 +171,12 @@ namespace Game {
 		return crcForResource;
 	}
 
+	void Resource::addCRC64(Checksum64 & crc) const {
+		crc.addInt(amount);
+		crc.addString(type->getName(false));
+		crc.addInt(pos.x);
+		crc.addInt(pos.y);
+		crc.addInt(balance);
+	}
+
 } //end namespace
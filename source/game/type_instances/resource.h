@@ -29,6 +29,7 @@
 #include "vec.h"
 #include "platform_common.h"
 #include "xml_parser.h"
+#include "checksum.h"
 #include "leak_dumper.h"
 
 using std::string;
@@ -38,6 +39,7 @@ using Shared::Xml::XmlNode;
 namespace Game {
 	using Shared::Graphics::Vec2i;
 	using Shared::PlatformCommon::ValueCheckerVault;
+	using Shared::Util::Checksum64;
 
 	class ResourceType;
 	class TechTree;
@@ -81,6 +83,7 @@ namespace Game {
 
 		std::string toString() const;
 		Checksum getCRC();
+		void addCRC64(Checksum64 & crc) const;
 	};
 
 } //end namespace
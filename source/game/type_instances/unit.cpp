@@ -64,6 +64,7 @@ namespace Game {
 		this->blockCount = 0;
 		this->pathQueue.clear();
 		this->map = NULL;
+		this->crcDirty = true;
 	}
 
 	UnitPathBasic::~UnitPathBasic() {
@@ -97,6 +98,7 @@ namespace Game {
 	void UnitPathBasic::clearCaches() {
 		this->blockCount = 0;
 		this->pathQueue.clear();
+		this->crcDirty = true;
 	}
 
 	bool UnitPathBasic::isEmpty() const {
@@ -114,11 +116,13 @@ namespace Game {
 	void UnitPathBasic::clear() {
 		pathQueue.clear();
 		blockCount = 0;
+		crcDirty = true;
 	}
 
 	void UnitPathBasic::incBlockCount() {
 		pathQueue.clear();
 		blockCount++;
+		crcDirty = true;
 	}
 
 	void UnitPathBasic::add(const Vec2i & path) {
@@ -149,6 +153,7 @@ namespace Game {
 		}
 
 		pathQueue.push_back(path);
+		crcDirty = true;
 	}
 
 	Vec2i UnitPathBasic::pop(bool removeFrontPos) {
@@ -167,6 +172,7 @@ namespace Game {
 			}
 
 			pathQueue.erase(pathQueue.begin());
+			crcDirty = true;
 		}
 		return p;
 	}
@@ -216,6 +222,7 @@ namespace Game {
 				Vec2i::strToVec2(node->getAttribute("vec")->getValue());
 			pathQueue.push_back(vec);
 		}
+		crcDirty = true;
 	}
 
 	Checksum UnitPathBasic::getCRC() {
@@ -227,6 +234,11 @@ namespace Game {
 		return crcForPath;
 	}
 
+	void UnitPathBasic::addCRC64(Checksum64 & crc) const {
+		crc.addInt(blockCount);
+		crc.addInt((int) pathQueue.size());
+	}
+
 	// =====================================================
 	//      class UnitPath
 	// =====================================================
@@ -690,6 +702,13 @@ namespace Game {
 		random.setDisableLastCallerTracking(isNetworkCRCEnabled() == false);
 		pathFindRefreshCellCount =
 			random.randRange(10, 20, intToStr(__LINE__));
+		visibleCellsTeamIndex = -1;
+		for (int index = 0; index < 5; ++index) {
+			crcNameKeys[index] = NULL;
+		}
+		crcNameHash = 0;
+		crcDirty = true;
+		crcHash = 0;
 
 		if (map->isInside(position) == false
 			|| map->isInsideSurface(map->toSurfCoords(position)) == false) {
@@ -743,6 +762,8 @@ namespace Game {
 		loadCount = 0;
 		ep = 0;
 		deadCount = 0;
+		sleepUntilFrame = 0;
+		sleepStartFrame = -1;
 		hp = type->getMaxHp() / 20;
 		toBeUndertaken = false;
 
@@ -790,6 +811,7 @@ namespace Game {
 
 	Unit::~Unit() {
 		badHarvestPosList.clear();
+		clearVisibleCells();
 
 		this->faction->deleteLivingUnits(id);
 		this->faction->deleteLivingUnitsp(this);
@@ -887,11 +909,13 @@ namespace Game {
 	}
 
 	void Unit::setType(const UnitType * newType) {
+		crcDirty = true;
 		this->faction->notifyUnitTypeChange(this, newType);
 		this->type = newType;
 	}
 
 	void Unit::setAlive(bool value) {
+		crcDirty = true;
 		this->alive = value;
 		this->faction->notifyUnitAliveStatusChange(this);
 	}
@@ -929,6 +953,7 @@ namespace Game {
 		}
 	}
 	void Unit::clearParticleInfo() {
+		crcDirty = true;
 		if (networkCRCParticleInfoList.empty() == false) {
 			networkCRCParticleInfoList.clear();
 		}
@@ -941,6 +966,7 @@ namespace Game {
 	}
 
 	void Unit::logParticleInfo(string info) {
+		crcDirty = true;
 		if (isNetworkCRCEnabled() == true) {
 			networkCRCParticleInfoList.push_back(info);
 		}
@@ -957,6 +983,7 @@ namespace Game {
 	}
 
 	void Unit::end(ParticleSystem * particleSystem) {
+		crcDirty = true;
 		if (particleSystem == fire) {
 			fire = NULL;
 		}
@@ -1009,6 +1036,7 @@ namespace Game {
 	//}
 
 	void Unit::setModelFacing(CardinalDir value) {
+		crcDirty = true;
 		modelFacing = value;
 		lastRotation = targetRotation = rotation = value * 90.f;
 	}
@@ -1443,6 +1471,7 @@ namespace Game {
 	// ====================================== set ======================================
 
 	void Unit::setCurrSkill(const SkillType * currSkill) {
+		crcDirty = true;
 		if (currSkill == NULL) {
 			char szBuf[8096] = "";
 			snprintf(szBuf, 8096,
@@ -1541,6 +1570,7 @@ namespace Game {
 		if (this->currSkill != currSkill) {
 			this->lastModelIndexForCurrSkillType = -1;
 			this->animationRandomCycleCount = 0;
+			wakeUp();
 		}
 
 		if (faction != NULL)
@@ -1570,6 +1600,7 @@ namespace Game {
 	}
 
 	void Unit::setTarget(const Unit * unit) {
+		crcDirty = true;
 
 		if (unit == NULL) {
 			char szBuf[8096] = "";
@@ -1590,6 +1621,7 @@ namespace Game {
 	}
 
 	RandomGen *Unit::getRandom(bool threadAccessAllowed) {
+		crcDirty = true;
 		if (threadAccessAllowed == false
 			&& Thread::isCurrentThreadMainThread() == false) {
 			throw
@@ -1602,6 +1634,7 @@ namespace Game {
 	}
 
 	void Unit::setPos(const Vec2i & position, bool clearPathFinder, bool threaded) {
+		crcDirty = true;
 		static string mutexOwnerId =
 			string(__FILE__) + string("_") + intToStr(__LINE__);
 		MutexSafeWrapper safeMutex(mutexCommands, mutexOwnerId);
@@ -1618,6 +1651,7 @@ namespace Game {
 			this->unitPath->clear();
 		}
 
+		wakeUp();
 		this->lastPos = this->pos;
 
 		if (map->isInside(position) == false
@@ -1713,6 +1747,7 @@ namespace Game {
 	}
 
 	void Unit::setTargetPos(const Vec2i & targetPos, bool threaded) {
+		crcDirty = true;
 		Vec2i newTargetPos;
 		if (map->isInside(targetPos) == false
 			|| map->isInsideSurface(map->toSurfCoords(targetPos)) == false) {
@@ -1750,6 +1785,7 @@ namespace Game {
 	}
 
 	void Unit::addAttackParticleSystem(ParticleSystem * ps) {
+		crcDirty = true;
 		attackParticleSystems.push_back(ps);
 	}
 
@@ -2054,6 +2090,7 @@ namespace Game {
 	}
 
 	void Unit::replaceCurrCommand(Command * cmd) {
+		crcDirty = true;
 		if (cmd == NULL)
 			return;
 		static string mutexOwnerId =
@@ -2096,11 +2133,13 @@ namespace Game {
 	//give one command (clear, and push back)
 	std::pair < CommandResult, string > Unit::giveCommand(Command * command,
 		bool tryQueue) {
+		crcDirty = true;
 		std::pair < CommandResult, string > result(crFailUndefined, "");
 		if (command == NULL) {
 			/*throw game_runtime_error("command == NULL");*/
 			return result;
 		}
+		wakeUp();
 		if (SystemFlags::
 			getSystemSettingType(SystemFlags::debugUnitCommands).enabled)
 			SystemFlags::OutputDebug(SystemFlags::debugUnitCommands,
@@ -2340,6 +2379,7 @@ namespace Game {
 
 	//pop front (used when order is done)
 	CommandResult Unit::finishCommand() {
+		crcDirty = true;
 		changedActiveCommand = false;
 		retryCurrCommandCount = 0;
 		// Reset the progress when task completed.
@@ -2387,6 +2427,8 @@ namespace Game {
 
 	//to cancel a command
 	CommandResult Unit::cancelCommand() {
+		crcDirty = true;
+		wakeUp();
 		changedActiveCommand = false;
 		retryCurrCommandCount = 0;
 
@@ -2441,6 +2483,7 @@ namespace Game {
 	}
 
 	void Unit::born(const CommandType * ct) {
+		crcDirty = true;
 		if (type == NULL) {
 			char szBuf[8096] = "";
 			snprintf(szBuf, 8096,
@@ -2487,6 +2530,7 @@ namespace Game {
 	}
 
 	void Unit::kill() {
+		crcDirty = true;
 		//no longer needs static resources
 		if (isBeingBuilt()) {
 			faction->deApplyStaticConsumption(type,
@@ -2521,6 +2565,7 @@ namespace Game {
 	}
 
 	void Unit::undertake() {
+		crcDirty = true;
 		try {
 			if (SystemFlags::
 				getSystemSettingType(SystemFlags::debugSystem).enabled)
@@ -3284,16 +3329,73 @@ namespace Game {
 		}
 	}
 
-	bool Unit::update() {
-		assert(progress <= PROGRESS_SPEED_MULTIPLIER);
-
-		//highlight
+	void Unit::updateHighlight() {
 		if (highlight > 0.f) {
 			const Game *game = Renderer::getInstance().getGame();
 			highlight -=
 				1.f / (Game::highlightTime *
 					game->getWorld()->getUpdateFps(this->getFactionIndex()));
 		}
+	}
+
+	// A unit whose next updates would only advance a counter sleeps until
+	// its next interesting frame or until an event (a command, damage, a
+	// skill change, an upgrade or a boost) wakes it. Only state that is the
+	// same on every network peer decides this, so all of them skip alike.
+	void Unit::sleepIfDormant(int frameCount) {
+		if (currSkill == NULL || toBeUndertaken == true ||
+			changedActiveCommand == true || currSkill->isAttackBoostEnabled() == true ||
+			currentAttackBoostEffects.empty() == false ||
+			currentAttackBoostOriginatorEffect.currentAttackBoostUnits.empty() == false) {
+			return;
+		}
+
+		int sleepFrames = 0;
+		if (currSkill->getClass() == scDie) {
+			// a corpse whose animation is over only counts down to being
+			// undertaken, wake it for the last count
+			if (progress >= PROGRESS_SPEED_MULTIPLIER &&
+				lastAnimProgress >= ANIMATION_SPEED_MULTIPLIER) {
+				sleepFrames = maxDeadCount - deadCount;
+			}
+		} else if (currSkill->getClass() == scStop) {
+			// idle units that can neither attack nor flee, with a stop skill
+			// that has nothing to animate, play or spend
+			if (type->hasSkillClass(scAttack) == false &&
+				type->hasCommandClass(ccMove) == false &&
+				currSkill->getAnimSpeed() == 0 && currSkill->getShake() == false &&
+				currSkill->getSkillSoundList()->empty() == true &&
+				currSkill->unitParticleSystemTypes.empty() == true &&
+				currSkill->getEpCost() == 0 && commands.size() == 1 &&
+				commands.front()->getCommandType()->getClass() == ccStop) {
+				sleepFrames = GameConstants::updateFps;
+			}
+		}
+
+		if (sleepFrames > 1) {
+			sleepStartFrame = frameCount;
+			sleepUntilFrame = frameCount + sleepFrames;
+		}
+	}
+
+	void Unit::resumeFromSleep(int frameCount) {
+		crcDirty = true;
+		if (sleepStartFrame < 0) {
+			return;
+		}
+		if (currSkill->getClass() == scDie && progress >= PROGRESS_SPEED_MULTIPLIER) {
+			// the corpse would have counted every frame it slept through
+			deadCount += frameCount - sleepStartFrame - 1;
+		}
+		sleepStartFrame = -1;
+		sleepUntilFrame = 0;
+	}
+
+	bool Unit::update() {
+		crcDirty = true;
+		assert(progress <= PROGRESS_SPEED_MULTIPLIER);
+
+		updateHighlight();
 
 		if (currSkill == NULL) {
 			char szBuf[8096] = "";
@@ -3641,6 +3743,7 @@ namespace Game {
 
 	bool Unit::applyAttackBoost(const AttackBoost * boost,
 		const Unit * source) {
+		crcDirty = true;
 		if (boost == NULL) {
 			char szBuf[8096] = "";
 			snprintf(szBuf, 8096,
@@ -3651,6 +3754,7 @@ namespace Game {
 		}
 
 		//printf("APPLYING ATTACK BOOST to unit [%s - %d] from unit [%s - %d]\n",this->getType()->getName().c_str(),this->getId(),source->getType()->getName().c_str(),source->getId());
+		wakeUp();
 
 		bool shouldApplyAttackBoost = true;
 		if (boost->allowMultipleBoosts == false) {
@@ -3812,6 +3916,7 @@ namespace Game {
 
 	void Unit::deapplyAttackBoost(const AttackBoost * boost,
 		const Unit * source) {
+		crcDirty = true;
 		if (boost == NULL) {
 			char szBuf[8096] = "";
 			snprintf(szBuf, 8096,
@@ -3828,6 +3933,7 @@ namespace Game {
 				source->getType()->getName(false).c_str(), source->getId(),
 				hp);
 
+		wakeUp();
 		bool wasAlive = alive;
 		int originalHp = hp;
 		int prevMaxHp = totalUpgrade.getMaxHp();
@@ -3949,6 +4055,7 @@ namespace Game {
 	}
 
 	void Unit::tick() {
+		crcDirty = true;
 
 		if (isAlive()) {
 			if (type == NULL) {
@@ -4154,6 +4261,7 @@ namespace Game {
 	}
 
 	bool Unit::repair() {
+		crcDirty = true;
 
 		if (type == NULL) {
 			char szBuf[8096] = "";
@@ -4201,6 +4309,7 @@ namespace Game {
 
 	//decrements HP and returns if dead
 	bool Unit::decHp(int decrementValue) {
+		crcDirty = true;
 		char szBuf[8096] = "";
 		snprintf(szBuf, 8095, "this->hp = %d, decrementValue = %d", this->hp,
 			decrementValue);
@@ -4209,6 +4318,7 @@ namespace Game {
 		if (this->hp == 0) {
 			return false;
 		}
+		wakeUp();
 
 		checkItemInVault(&this->hp, this->hp);
 		int original_hp = this->hp;
@@ -4399,6 +4509,7 @@ namespace Game {
 	}
 
 	void Unit::applyUpgrade(const UpgradeType * upgradeType) {
+		crcDirty = true;
 		if (upgradeType == NULL) {
 			char szBuf[8096] = "";
 			snprintf(szBuf, 8096,
@@ -4409,6 +4520,7 @@ namespace Game {
 		}
 
 		if (upgradeType->isAffected(type)) {
+			wakeUp();
 			totalUpgrade.sum(upgradeType, this);
 
 			checkItemInVault(&this->hp, this->hp);
@@ -4428,11 +4540,13 @@ namespace Game {
 	}
 
 	void Unit::computeTotalUpgrade() {
+		crcDirty = true;
 		faction->getUpgradeManager()->computeTotalUpgrade(this,
 			&totalUpgrade);
 	}
 
 	void Unit::incKills(int team) {
+		crcDirty = true;
 		++kills;
 		if (team != this->getTeam()) {
 			++enemyKills;
@@ -4499,6 +4613,7 @@ namespace Game {
 	}
 
 	bool Unit::morph(const MorphCommandType * mct, int frameIndex) {
+		crcDirty = true;
 
 		if (mct == NULL) {
 			char szBuf[8096] = "";
@@ -4664,6 +4779,7 @@ namespace Game {
 	}
 
 	void Unit::clearCommands() {
+		crcDirty = true;
 
 		this->setCurrentUnitTitle("");
 		this->unitPath->clear();
@@ -4916,6 +5032,7 @@ namespace Game {
 	}
 
 	CommandResult Unit::undoCommand(Command * command) {
+		crcDirty = true;
 
 		if (command == NULL) {
 			char szBuf[8096] = "";
@@ -5453,6 +5570,7 @@ namespace Game {
 	}
 
 	void Unit::setMeetingPos(const Vec2i & meetingPos) {
+		crcDirty = true;
 		Vec2i pos;
 		if (map->isInside(meetingPos) == false
 			|| map->isInsideSurface(map->toSurfCoords(meetingPos)) == false) {
@@ -5484,6 +5602,9 @@ namespace Game {
 		return frameCount;
 	}
 
+	// The cells a unit sees are counted in the map while it is alive, so
+	// they only have to be updated when the unit moves, its sight or team
+	// changes or it dies
 	void Unit::exploreCells(bool forceRefresh) {
 		if (this->isAlive() == true) {
 			const Vec2i & newPos = this->getCenteredPos();
@@ -5503,8 +5624,20 @@ namespace Game {
 			if (!forceRefresh &&
 				cacheExploredCellsKey.first == newPos &&
 				cacheExploredCellsKey.second == sightRange) {
-				game->getWorld()->exploreCells(teamIndex, cacheExploredCells);
+				if (visibleCellsTeamIndex != teamIndex) {
+					game->getWorld()->exploreCells(teamIndex, cacheExploredCells);
+
+					clearVisibleCells();
+					map->addVisibleCells(teamIndex, cacheExploredCells.visibleCellList);
+					visibleCellsTeamIndex = teamIndex;
+				}
 			} else {
+				// Keep the old cells until the new ones are counted, so cells
+				// seen from both positions never drop to zero in between
+				std::vector<SurfaceCell *> oldVisibleCellList;
+				oldVisibleCellList.swap(cacheExploredCells.visibleCellList);
+				int oldVisibleCellsTeamIndex = visibleCellsTeamIndex;
+
 				// Try the world exploration scan or possible cache
 				cacheExploredCells =
 					game->getWorld()->exploreCells(newPos, sightRange, teamIndex,
@@ -5513,7 +5646,25 @@ namespace Game {
 				// Cache the result for this unit
 				cacheExploredCellsKey.first = newPos;
 				cacheExploredCellsKey.second = sightRange;
+
+				map->addVisibleCells(teamIndex, cacheExploredCells.visibleCellList);
+				visibleCellsTeamIndex = teamIndex;
+				if (oldVisibleCellsTeamIndex >= 0) {
+					map->removeVisibleCells(oldVisibleCellsTeamIndex, oldVisibleCellList);
+				}
 			}
+		} else {
+			clearVisibleCells();
+		}
+	}
+
+	// releaseCells is false when the map counts were cleared already
+	void Unit::clearVisibleCells(bool releaseCells) {
+		if (visibleCellsTeamIndex >= 0) {
+			if (releaseCells == true) {
+				map->removeVisibleCells(visibleCellsTeamIndex, cacheExploredCells.visibleCellList);
+			}
+			visibleCellsTeamIndex = -1;
 		}
 	}
 
@@ -5589,6 +5740,7 @@ namespace Game {
 	}
 
 	void Unit::addBadHarvestPos(const Vec2i & value) {
+		crcDirty = true;
 		//Chrono chron;
 		//chron.start();
 		badHarvestPosList[value] = getFrameCount();
@@ -5604,6 +5756,7 @@ namespace Game {
 	//}
 
 	void Unit::cleanupOldBadHarvestPos() {
+		crcDirty = true;
 		const unsigned int cleanupInterval = (GameConstants::updateFps * 5);
 		bool needToCleanup = (getFrameCount() % cleanupInterval == 0);
 
@@ -5689,6 +5842,7 @@ namespace Game {
 	}
 
 	void Unit::setLastStuckFrameToCurrentFrame() {
+		crcDirty = true;
 		lastStuckFrame = getFrameCount();
 	}
 
@@ -5744,6 +5898,8 @@ namespace Game {
 		cachedFow.surfPosAlphaList.clear();
 		cachedFowPos = Vec2i(0, 0);
 
+		clearVisibleCells();
+
 		cacheExploredCells.exploredCellList.clear();
 		cacheExploredCells.visibleCellList.clear();
 		cacheExploredCellsKey.first = Vec2i(-1, -1);
@@ -5973,6 +6129,10 @@ namespace Game {
 		//    int deadCount;
 		unitNode->addAttribute("deadCount", intToStr(deadCount),
 			mapTagReplacements);
+		unitNode->addAttribute("sleepUntilFrame", intToStr(sleepUntilFrame),
+			mapTagReplacements);
+		unitNode->addAttribute("sleepStartFrame", intToStr(sleepStartFrame),
+			mapTagReplacements);
 		//    float progress;                   //between 0 and 1
 		unitNode->addAttribute("progress", intToStr(progress),
 			mapTagReplacements);
@@ -6445,6 +6605,12 @@ namespace Game {
 		//    int deadCount;
 		result->deadCount =
 			unitNode->getAttribute("deadCount")->getIntValue();
+		if (unitNode->hasAttribute("sleepUntilFrame") == true) {
+			result->sleepUntilFrame =
+				unitNode->getAttribute("sleepUntilFrame")->getIntValue();
+			result->sleepStartFrame =
+				unitNode->getAttribute("sleepStartFrame")->getIntValue();
+		}
 		//    float progress;                   //between 0 and 1
 		try {
 			result->progress =
@@ -7247,4 +7413,139 @@ namespace Game {
 
 		return crcForUnit;
 	}
+
+	// Same state as getCRC, hashed a word at a time for the per frame
+	// network synch checks
+	uint64 Unit::getCRC64() {
+		// the path and the commands are changed in place by the command
+		// update, they keep their own flag
+		if (crcDirty == false && unitPath != NULL &&
+			unitPath->isCRCDirty() == true) {
+			crcDirty = true;
+		}
+		for (Commands::const_iterator it = commands.begin();
+			crcDirty == false && it != commands.end(); ++it) {
+			if ((*it)->isCRCDirty() == true) {
+				crcDirty = true;
+			}
+		}
+		// attack particle system crcs change on their own while network
+		// crc logging is on, so those units are always rehashed
+		if (crcDirty == false && (attackParticleSystems.empty() == true ||
+			isNetworkCRCEnabled() == false)) {
+			return crcHash;
+		}
+
+		const void *nameKeys[5] = { level, preMorph_type, type, loadType, currSkill };
+		if (memcmp(nameKeys, crcNameKeys, sizeof(nameKeys)) != 0) {
+			Checksum64 crcForNames;
+			if (level != NULL) {
+				crcForNames.addString(level->getName(false));
+			}
+			if (preMorph_type != NULL) {
+				crcForNames.addString(preMorph_type->getName(false));
+			}
+			if (type != NULL) {
+				crcForNames.addString(type->getName(false));
+			}
+			if (loadType != NULL) {
+				crcForNames.addString(loadType->getName(false));
+			}
+			if (currSkill != NULL) {
+				crcForNames.addString(currSkill->getName());
+			}
+			crcNameHash = crcForNames.getSum();
+			memcpy(crcNameKeys, nameKeys, sizeof(nameKeys));
+		}
+
+		Checksum64 crcForUnit;
+
+		crcForUnit.addInt(id);
+		crcForUnit.addInt(hp);
+		crcForUnit.addInt(ep);
+		crcForUnit.addInt(loadCount);
+		crcForUnit.addInt(deadCount);
+		crcForUnit.addInt64(progress);
+		crcForUnit.addInt64(lastAnimProgress);
+		crcForUnit.addInt64(animProgress);
+		crcForUnit.addInt(progress2);
+		crcForUnit.addInt(kills);
+		crcForUnit.addInt(enemyKills);
+		crcForUnit.addInt(morphFieldsBlocked);
+		crcForUnit.addInt(currField);
+		crcForUnit.addInt(targetField);
+		crcForUnit.addUInt64(crcNameHash);
+
+		crcForUnit.addInt(pos.x);
+		crcForUnit.addInt(pos.y);
+		crcForUnit.addInt(lastPos.x);
+		crcForUnit.addInt(lastPos.y);
+		crcForUnit.addInt(targetPos.x);
+		crcForUnit.addInt(targetPos.y);
+		crcForUnit.addInt(meetingPos.x);
+		crcForUnit.addInt(meetingPos.y);
+
+		crcForUnit.addInt(toBeUndertaken);
+		crcForUnit.addInt(alive);
+		if (fire != NULL) {
+			crcForUnit.addInt(fire->getActive());
+		}
+
+		totalUpgrade.addCRC64(crcForUnit);
+		if (unitPath != NULL) {
+			unitPath->addCRC64(crcForUnit);
+			unitPath->clearCRCDirty();
+		}
+		crcForUnit.addInt((int) commands.size());
+		for (Commands::const_iterator it = commands.begin();
+			it != commands.end(); ++it) {
+			(*it)->addCRC64(crcForUnit);
+			(*it)->clearCRCDirty();
+		}
+
+		crcForUnit.addInt((int) damageParticleSystems.size());
+		crcForUnit.addInt(modelFacing);
+		crcForUnit.addInt(inBailOutAttempt);
+		crcForUnit.addInt((int) badHarvestPosList.size());
+		crcForUnit.addInt((int) lastStuckFrame);
+		crcForUnit.addInt(lastStuckPos.x);
+		crcForUnit.addInt(lastStuckPos.y);
+		crcForUnit.addInt((int)
+			currentAttackBoostOriginatorEffect.currentAttackBoostUnits.size());
+		crcForUnit.addInt(currentPathFinderDesiredFinalPos.x);
+		crcForUnit.addInt(currentPathFinderDesiredFinalPos.y);
+
+		crcForUnit.addInt(random.getLastNumber());
+		const vector < string > &lastCallerList = random.getLastCallerList();
+		for (unsigned int index = 0; index < lastCallerList.size(); ++index) {
+			crcForUnit.addString(lastCallerList[index]);
+		}
+		crcForUnit.addInt(lastHarvestedResourcePos.x);
+		crcForUnit.addInt(lastHarvestedResourcePos.y);
+
+		for (unsigned int index = 0;
+			index < networkCRCParticleInfoList.size(); ++index) {
+			crcForUnit.addString(networkCRCParticleInfoList[index]);
+		}
+		crcForUnit.addInt((int) attackParticleSystems.size());
+		if (isNetworkCRCEnabled() == true) {
+			for (unsigned int index = 0; index < attackParticleSystems.size();
+				++index) {
+				ParticleSystem *ps = attackParticleSystems[index];
+				if (ps != NULL &&
+					Renderer::getInstance().validateParticleSystemStillExists(ps,
+						rsGame)
+					== true) {
+					crcForUnit.addInt(ps->getCRC().getSum());
+				}
+			}
+		}
+		if (this->networkCRCParticleLogInfo != "") {
+			crcForUnit.addString(this->networkCRCParticleLogInfo);
+		}
+
+		crcHash = crcForUnit.getSum();
+		crcDirty = false;
+		return crcHash;
+	}
 } //end namespace
@@ -181,6 +181,10 @@ namespace Game {
 		virtual void clearCaches() = 0;
 
 		virtual Checksum getCRC() = 0;
+		virtual void addCRC64(Checksum64 & crc) const = 0;
+		// set by the mutators, the owning unit rehashes while it is set
+		virtual bool isCRCDirty() const = 0;
+		virtual void clearCRCDirty() = 0;
 	};
 
 	class UnitPathBasic :public UnitPathInterface {
@@ -195,6 +199,7 @@ namespace Game {
 	private:
 		int blockCount;
 		vector < Vec2i > pathQueue;
+		bool crcDirty;
 
 	public:
 		UnitPathBasic();
@@ -211,6 +216,7 @@ namespace Game {
 		virtual void clear();
 		virtual void clearBlockCount() {
 			blockCount = 0;
+			crcDirty = true;
 		}
 		virtual void incBlockCount();
 		virtual void add(const Vec2i & path);
@@ -240,6 +246,13 @@ namespace Game {
 		virtual void clearCaches();
 
 		virtual Checksum getCRC();
+		virtual void addCRC64(Checksum64 & crc) const;
+		virtual bool isCRCDirty() const {
+			return crcDirty;
+		}
+		virtual void clearCRCDirty() {
+			crcDirty = false;
+		}
 	};
 
 	// =====================================================
@@ -347,6 +360,13 @@ namespace Game {
 		virtual Checksum getCRC() {
 			return Checksum();
 		};
+		virtual void addCRC64(Checksum64 & crc) const {
+		};
+		virtual bool isCRCDirty() const {
+			return false;
+		}
+		virtual void clearCRCDirty() {
+		}
 	};
 
 	class WaypointPath :public list < Vec2i > {
@@ -445,6 +465,10 @@ namespace Game {
 		int32 ep;
 		int32 loadCount;
 		int32 deadCount;
+		// a sleeping unit is skipped by the world until sleepUntilFrame,
+		// sleepStartFrame is its last update or -1 while it is awake
+		int32 sleepUntilFrame;
+		int32 sleepStartFrame;
 		//float progress;                   //between 0 and 1
 		int64 progress;           //between 0 and 1
 		int64 lastAnimProgress;   //between 0 and 1
@@ -575,9 +599,20 @@ namespace Game {
 
 		ExploredCellsLookupItem cacheExploredCells;
 		std::pair < Vec2i, int >cacheExploredCellsKey;
+		// team whose visible counts hold cacheExploredCells.visibleCellList
+		int visibleCellsTeamIndex;
 
 		Vec2i lastHarvestedResourcePos;
 
+		// the type names in getCRC64 only change with these pointers, so
+		// their hash is kept until one of them does
+		const void *crcNameKeys[5];
+		uint64 crcNameHash;
+		// getCRC64 only rehashes the unit after it was updated or one of
+		// its setters ran, otherwise crcHash is returned as is
+		bool crcDirty;
+		uint64 crcHash;
+
 		string networkCRCLogInfo;
 		string networkCRCParticleLogInfo;
 		vector < string > networkCRCDecHpList;
@@ -601,6 +636,7 @@ namespace Game {
 
 		void setCurrentPathFinderDesiredFinalPos(const Vec2i & finalPos) {
 			currentPathFinderDesiredFinalPos = finalPos;
+			crcDirty = true;
 		}
 		Vec2i getCurrentPathFinderDesiredFinalPos() const {
 			return currentPathFinderDesiredFinalPos;
@@ -651,6 +687,7 @@ namespace Game {
 		}
 		inline void setCurrField(Field value) {
 			currField = value;
+			crcDirty = true;
 		}
 		inline int getLoadCount() const {
 			return loadCount;
@@ -687,9 +724,11 @@ namespace Game {
 		}
 		inline void setHp(int32 value) {
 			hp = value;
+			crcDirty = true;
 		}
 		inline void setEp(int32 value) {
 			ep = value;
+			crcDirty = true;
 		}
 		int getProductionPercent() const;
 		float getProgressRatio() const;
@@ -823,6 +862,7 @@ namespace Game {
 
 		void setMorphFieldsBlocked(bool value) {
 			this->morphFieldsBlocked = value;
+			crcDirty = true;
 		}
 		bool getMorphFieldsBlocked() const {
 			return morphFieldsBlocked;
@@ -830,6 +870,7 @@ namespace Game {
 
 		inline void setLastHarvestedResourcePos(Vec2i pos) {
 			this->lastHarvestedResourcePos = pos;
+			crcDirty = true;
 		}
 		inline Vec2i getLastHarvestedResourcePos() const {
 			return this->lastHarvestedResourcePos;
@@ -837,13 +878,16 @@ namespace Game {
 
 		inline void setLoadCount(int loadCount) {
 			this->loadCount = loadCount;
+			crcDirty = true;
 		}
 		inline void setLoadType(const ResourceType * loadType) {
 			this->loadType = loadType;
+			crcDirty = true;
 		}
 		// resetProgress2 resets produce and upgrade progress.
 		inline void resetProgress2() {
 			this->progress2 = 0;
+			crcDirty = true;
 		}
 		void setPos(const Vec2i & pos, bool clearPathFinder =
 			false, bool threaded = false);
@@ -905,6 +949,16 @@ namespace Game {
 		bool decHp(int i);
 		int update2();
 		bool update();
+		void updateHighlight();
+		inline bool isSleeping(int frameCount) const {
+			return frameCount < sleepUntilFrame;
+		}
+		inline void wakeUp() {
+			sleepUntilFrame = 0;
+			crcDirty = true;
+		}
+		void sleepIfDormant(int frameCount);
+		void resumeFromSleep(int frameCount);
 		void tick();
 		RandomGen *getRandom(bool threadAccessAllowed = false);
 
@@ -956,12 +1010,14 @@ namespace Game {
 		}
 
 		void exploreCells(bool forceRefresh = false);
+		void clearVisibleCells(bool releaseCells = true);
 
 		inline bool getInBailOutAttempt() const {
 			return inBailOutAttempt;
 		}
 		inline void setInBailOutAttempt(bool value) {
 			inBailOutAttempt = value;
+			crcDirty = true;
 		}
 
 		//std::vector<std::pair<Vec2i,Chrono> > getBadHarvestPosList() const { return badHarvestPosList; }
@@ -1035,6 +1091,7 @@ namespace Game {
 		}
 		inline void setLastStuckPos(Vec2i pos) {
 			lastStuckPos = pos;
+			crcDirty = true;
 		}
 
 		bool isLastPathfindFailedFrameWithinCurrentFrameTolerance() const;
@@ -1075,11 +1132,13 @@ namespace Game {
 		void addAttackParticleSystem(ParticleSystem * ps);
 
 		Checksum getCRC();
+		uint64 getCRC64();
 
 		virtual void end(ParticleSystem * particleSystem);
 		virtual void logParticleInfo(string info);
 		void setNetworkCRCParticleLogInfo(string networkCRCParticleLogInfo) {
 			this->networkCRCParticleLogInfo = networkCRCParticleLogInfo;
+			crcDirty = true;
 		}
 		void clearParticleInfo();
 		void addNetworkCRCDecHp(string info);
@@ -323,56 +323,67 @@ namespace Game {
 		*/
 		virtual Checksum getCRC() {
 			Checksum crcForUpgradeType;
+			addCRCFields(crcForUpgradeType);
+			return crcForUpgradeType;
+		}
 
-			crcForUpgradeType.addString(getUpgradeName());
-			crcForUpgradeType.addInt(getMaxHp());
-			crcForUpgradeType.addInt(getMaxHpIsMultiplier());
-			crcForUpgradeType.addInt(getMaxHpRegeneration());
+		/**
+		* Adds the upgrade fields to a unit's 64 bit checksum without
+		* building an intermediate checksum.
+		*/
+		void addCRC64(Checksum64 & crc) const {
+			addCRCFields(crc);
+		}
 
-			crcForUpgradeType.addInt(getSight());
-			crcForUpgradeType.addInt(getSightIsMultiplier());
+	private:
+		template < typename T > void addCRCFields(T & crc) const {
+			crc.addString(upgradename);
+			crc.addInt(getMaxHp());
+			crc.addInt(getMaxHpIsMultiplier());
+			crc.addInt(getMaxHpRegeneration());
+
+			crc.addInt(getSight());
+			crc.addInt(getSightIsMultiplier());
 
-			crcForUpgradeType.addInt(getMaxEp());
-			crcForUpgradeType.addInt(getMaxEpIsMultiplier());
-			crcForUpgradeType.addInt(getMaxEpRegeneration());
+			crc.addInt(getMaxEp());
+			crc.addInt(getMaxEpIsMultiplier());
+			crc.addInt(getMaxEpRegeneration());
 
-			crcForUpgradeType.addInt(getArmor());
-			crcForUpgradeType.addInt(getArmorIsMultiplier());
+			crc.addInt(getArmor());
+			crc.addInt(getArmorIsMultiplier());
 
-			crcForUpgradeType.addInt(getAttackStrength());
-			crcForUpgradeType.addInt(getAttackStrengthIsMultiplier());
+			crc.addInt(getAttackStrength());
+			crc.addInt(getAttackStrengthIsMultiplier());
 			//std::map<string,int> attackStrengthMultiplierValueList;
-			crcForUpgradeType.addInt64((int64) attackStrengthMultiplierValueList.
+			crc.addInt64((int64) attackStrengthMultiplierValueList.
 				size());
 
-			crcForUpgradeType.addInt(getAttackRange());
-			crcForUpgradeType.addInt(getAttackRangeIsMultiplier());
+			crc.addInt(getAttackRange());
+			crc.addInt(getAttackRangeIsMultiplier());
 			//std::map<string,int> attackRangeMultiplierValueList;
-			crcForUpgradeType.addInt64((int64) attackRangeMultiplierValueList.
+			crc.addInt64((int64) attackRangeMultiplierValueList.
 				size());
 
-			crcForUpgradeType.addInt(getMoveSpeed());
-			crcForUpgradeType.addInt(getMoveSpeedIsMultiplier());
+			crc.addInt(getMoveSpeed());
+			crc.addInt(getMoveSpeedIsMultiplier());
 			//std::map<string,int> moveSpeedIsMultiplierValueList;
-			crcForUpgradeType.addInt64((int64) moveSpeedIsMultiplierValueList.
+			crc.addInt64((int64) moveSpeedIsMultiplierValueList.
 				size());
 
-			crcForUpgradeType.addInt(getProdSpeed());
-			crcForUpgradeType.addInt(getProdSpeedIsMultiplier());
+			crc.addInt(getProdSpeed());
+			crc.addInt(getProdSpeedIsMultiplier());
 			//std::map<string,int> prodSpeedProduceIsMultiplierValueList;
-			crcForUpgradeType.
+			crc.
 				addInt64((int64) prodSpeedProduceIsMultiplierValueList.size());
 			//std::map<string,int> prodSpeedUpgradeIsMultiplierValueList;
-			crcForUpgradeType.
+			crc.
 				addInt64((int64) prodSpeedUpgradeIsMultiplierValueList.size());
 			//std::map<string,int> prodSpeedMorphIsMultiplierValueList;
-			crcForUpgradeType.
+			crc.
 				addInt64((int64) prodSpeedMorphIsMultiplierValueList.size());
 
-			crcForUpgradeType.addInt(getAttackSpeed());
-			crcForUpgradeType.addInt(getAttackSpeedIsMultiplier());
-
-			return crcForUpgradeType;
+			crc.addInt(getAttackSpeed());
+			crc.addInt(getAttackSpeedIsMultiplier());
 		}
 	};
 
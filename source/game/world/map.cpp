@@ -20,6 +20,7 @@
 #include "map.h"
 
 #include <cassert>
+#include <algorithm>
 
 #include "tileset.h"
 #include "unit.h"
@@ -141,6 +142,7 @@ namespace Game {
 		for (int index = 0; index < GameConstants::maxPlayers + GameConstants::specialFactions; ++index) {
 			setVisible(index, false);
 			setExplored(index, false);
+			visibleCount[index] = 0;
 		}
 	}
 
@@ -332,6 +334,7 @@ namespace Game {
 	//		}
 		}
 	}
+
 	// =====================================================
 	// 	class Map
 	// =====================================================
@@ -340,6 +343,8 @@ namespace Game {
 
 	const int Map::cellScale = 2;
 	const int Map::mapScale = 2;
+	const int Map::unitBucketSize = 8;
+	const int Map::unitBucketTeamSlots = GameConstants::maxPlayers + GameConstants::specialFactions;
 
 	Map::Map() {
 		cells = NULL;
@@ -358,6 +363,8 @@ namespace Game {
 		surfaceSize = (surfaceW * surfaceH);
 		maxPlayers = 0;
 		maxMapHeight = 0;
+		unitBucketsW = 0;
+		unitBucketsH = 0;
 	}
 
 	Map::~Map() {
@@ -489,6 +496,8 @@ namespace Game {
 				//cells
 				cells = new Cell[getCellArraySize()];
 				surfaceCells = new SurfaceCell[getSurfaceCellArraySize()];
+				initUnitBuckets();
+				unseenCells.clear();
 
 				//read heightmap
 				for (int j = 0; j < surfaceH; ++j) {
@@ -576,6 +585,7 @@ namespace Game {
 		computeInterpolatedHeights();
 		computeNearSubmerged();
 		computeCellColors();
+		initResourceBuckets();
 	}
 
 
@@ -596,6 +606,7 @@ namespace Game {
 		bool resourceNear = false;
 		float distanceFromUnit = -1;
 		float distanceFromClick = -1;
+		int typeIndex = getResourceBucketTypeIndex(rt);
 
 		if (resourceClickPos) {
 			//printf("+++++++++ unit [%s - %d] pos = [%s] resourceClickPos [%s]\n",unit->getFullName().c_str(),unit->getId(),pos.getString().c_str(),resourceClickPos->getString().c_str());
@@ -608,7 +619,8 @@ namespace Game {
 				}
 				Vec2i surfCoords = toSurfCoords(resPos);
 
-				if (isInside(resPos) && isInsideSurface(surfCoords)) {
+				if (isInside(resPos) && isInsideSurface(surfCoords) &&
+					hasResourcesInBucket(resPos.x, resPos.y, typeIndex)) {
 					Resource *r = getSurfaceCell(surfCoords)->getResource();
 					if (r != NULL) {
 						if (r->getType() == rt) {
@@ -888,6 +900,34 @@ namespace Game {
 		}
 	}
 
+	bool Map::isStaticFreeCell(const Vec2i &pos, Field field) const {
+		if (isInside(pos) == false || isInsideSurface(toSurfCoords(pos)) == false) {
+			return false;
+		}
+
+		const Unit *unit = getCell(pos)->getUnit(field);
+		if (unit != NULL && unit->isPutrefacting() == false && unit->getType()->isMobile() == false) {
+			return false;
+		}
+		if (SkillType::toActualField(field) == fAir) {
+			return true;
+		}
+		return
+			getSurfaceCell(toSurfCoords(pos))->isFree() &&
+			((field & fWater) == fWater ? ((field & fLand) == fLand ? true : getDeepSubmerged(getCell(pos))) : !getDeepSubmerged(getCell(pos)));
+	}
+
+	bool Map::isStaticFreeCells(const Vec2i &pos, int size, Field field) const {
+		for (int i = pos.x; i < pos.x + size; ++i) {
+			for (int j = pos.y; j < pos.y + size; ++j) {
+				if (isStaticFreeCell(Vec2i(i, j), field) == false) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
 	//bool Map::canOccupy(const Vec2i &pos, Field field, const UnitType *ut, CardinalDir facing) {
 	//	if (ut->hasCellMap() && isInside(pos) && isInsideSurface(toSurfCoords(pos))) {
 	//		for (int y=0; y < ut->getSize(); ++y) {
@@ -915,44 +955,19 @@ namespace Game {
 	// ==================== unit placement ====================
 
 	//checks if a unit can move from between 2 cells
-	bool Map::canMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2, std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<Field, bool> > > > *lookupCache) const {
+	bool Map::canMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2) const {
 		int size = unit->getType()->getSize();
 		Field field = unit->getCurrField();
 
-		if (lookupCache != NULL) {
-			std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<Field, bool> > > >::const_iterator iterFind1 = lookupCache->find(pos1);
-			if (iterFind1 != lookupCache->end()) {
-				std::map<Vec2i, std::map<int, std::map<Field, bool> > >::const_iterator iterFind2 = iterFind1->second.find(pos2);
-				if (iterFind2 != iterFind1->second.end()) {
-					std::map<int, std::map<Field, bool> >::const_iterator iterFind3 = iterFind2->second.find(size);
-					if (iterFind3 != iterFind2->second.end()) {
-						std::map<Field, bool>::const_iterator iterFind4 = iterFind3->second.find(field);
-						if (iterFind4 != iterFind3->second.end()) {
-							// Found this result in the cache
-							return iterFind4->second;
-						}
-					}
-				}
-			}
-		}
-
 		for (int i = pos2.x; i < pos2.x + size; ++i) {
 			for (int j = pos2.y; j < pos2.y + size; ++j) {
 				if (isInside(i, j) && isInsideSurface(toSurfCoords(Vec2i(i, j)))) {
 					if (getCell(i, j)->getUnit(field) != unit) {
 						if (isFreeCell(Vec2i(i, j), field) == false) {
-							if (lookupCache != NULL) {
-								(*lookupCache)[pos1][pos2][size][field] = false;
-							}
-
 							return false;
 						}
 					}
 				} else {
-					if (lookupCache != NULL) {
-						(*lookupCache)[pos1][pos2][size][field] = false;
-					}
-
 					return false;
 				}
 			}
@@ -970,22 +985,14 @@ namespace Game {
 		//}
 
 		if (isBadHarvestPos == true) {
-			if (lookupCache != NULL) {
-				(*lookupCache)[pos1][pos2][size][field] = false;
-			}
-
 			return false;
 		}
 
-		if (lookupCache != NULL) {
-			(*lookupCache)[pos1][pos2][size][field] = true;
-		}
-
 		return true;
 	}
 
 	//checks if a unit can move from between 2 cells using only visible cells (for pathfinding)
-	bool Map::aproxCanMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2, std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<int, std::map<Field, bool> > > > > *lookupCache) const {
+	bool Map::aproxCanMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2) const {
 		if (isInside(pos1) == false || isInsideSurface(toSurfCoords(pos1)) == false ||
 			isInside(pos2) == false || isInsideSurface(toSurfCoords(pos2)) == false) {
 
@@ -1000,45 +1007,14 @@ namespace Game {
 		int teamIndex = unit->getTeam();
 		Field field = unit->getCurrField();
 
-		if (lookupCache != NULL) {
-			std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<int, std::map<Field, bool> > > > >::const_iterator iterFind1 = lookupCache->find(pos1);
-			if (iterFind1 != lookupCache->end()) {
-				std::map<Vec2i, std::map<int, std::map<int, std::map<Field, bool> > > >::const_iterator iterFind2 = iterFind1->second.find(pos2);
-				if (iterFind2 != iterFind1->second.end()) {
-					std::map<int, std::map<int, std::map<Field, bool> > >::const_iterator iterFind3 = iterFind2->second.find(teamIndex);
-					if (iterFind3 != iterFind2->second.end()) {
-						std::map<int, std::map<Field, bool> >::const_iterator iterFind4 = iterFind3->second.find(size);
-						if (iterFind4 != iterFind3->second.end()) {
-							std::map<Field, bool>::const_iterator iterFind5 = iterFind4->second.find(field);
-							if (iterFind5 != iterFind4->second.end()) {
-								// Found this result in the cache
-								if (iterFind5->second == false) {
-									//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
-								}
-								return iterFind5->second;
-							}
-						}
-					}
-				}
-			}
-		}
-
 		//single cell units
 		if (size == 1) {
 			if (isAproxFreeCell(pos2, field, teamIndex) == false) {
-				if (lookupCache != NULL) {
-					(*lookupCache)[pos1][pos2][teamIndex][size][field] = false;
-				}
-
 				//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
 				return false;
 			}
 			if (pos1.x != pos2.x && pos1.y != pos2.y) {
 				if (isAproxFreeCell(Vec2i(pos1.x, pos2.y), field, teamIndex) == false) {
-					if (lookupCache != NULL) {
-						(*lookupCache)[pos1][pos2][teamIndex][size][field] = false;
-					}
-
 					//Unit *cellUnit = getCell(Vec2i(pos1.x, pos2.y))->getUnit(field);
 					//Object * obj = getSurfaceCell(toSurfCoords(Vec2i(pos1.x, pos2.y)))->getObject();
 
@@ -1047,10 +1023,6 @@ namespace Game {
 					return false;
 				}
 				if (isAproxFreeCell(Vec2i(pos2.x, pos1.y), field, teamIndex) == false) {
-					if (lookupCache != NULL) {
-						(*lookupCache)[pos1][pos2][teamIndex][size][field] = false;
-					}
-
 					//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
 					return false;
 				}
@@ -1068,18 +1040,10 @@ namespace Game {
 			//}
 
 			if (unit == NULL || isBadHarvestPos == true) {
-				if (lookupCache != NULL) {
-					(*lookupCache)[pos1][pos2][teamIndex][size][field] = false;
-				}
-
 				//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
 				return false;
 			}
 
-			if (lookupCache != NULL) {
-				(*lookupCache)[pos1][pos2][teamIndex][size][field] = true;
-			}
-
 			return true;
 		}
 		//multi cell units
@@ -1091,20 +1055,12 @@ namespace Game {
 					if (isInside(cellPos) && isInsideSurface(toSurfCoords(cellPos))) {
 						if (getCell(cellPos)->getUnit(unit->getCurrField()) != unit) {
 							if (isAproxFreeCell(cellPos, field, teamIndex) == false) {
-								if (lookupCache != NULL) {
-									(*lookupCache)[pos1][pos2][teamIndex][size][field] = false;
-								}
-
 								//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
 								return false;
 							}
 						}
 					} else {
 
-						if (lookupCache != NULL) {
-							(*lookupCache)[pos1][pos2][teamIndex][size][field] = false;
-						}
-
 						//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
 						return false;
 					}
@@ -1121,17 +1077,10 @@ namespace Game {
 			}
 
 			if (isBadHarvestPos == true) {
-				if (lookupCache != NULL) {
-					(*lookupCache)[pos1][pos2][teamIndex][size][field] = false;
-				}
-
 				//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
 				return false;
 			}
 
-			if (lookupCache != NULL) {
-				(*lookupCache)[pos1][pos2][teamIndex][size][field] = true;
-			}
 		}
 		return true;
 	}
@@ -1387,11 +1336,11 @@ namespace Game {
 						(unit->getType()->hasSkillClass(scBeBuilt) != getCell(currPos)->getUnit(field)->getType()->hasSkillClass(scBeBuilt))) {
 						if (isMorph) {
 							// unit is beeing morphed to another unit with maybe other field.
-							getCell(currPos)->setUnit(field, unit);
+							setCellUnit(currPos, field, unit);
 							canPutInCell = false;
 						}
 						if (canPutInCell == true) {
-							getCell(currPos)->setUnit(unit->getCurrField(), unit);
+							setCellUnit(currPos, unit->getCurrField(), unit);
 						}
 					} else if (canPutInCell == true) {
 						if (!forcePut) {
@@ -1414,6 +1363,10 @@ namespace Game {
 		if (canPutInCell == true) {
 			unit->setPos(pos, false, threaded);
 		}
+
+		if (ut->isMobile() == false || unit->getType()->isMobile() == false) {
+			notifyStaticCellsChanged(pos, ut->getSize());
+		}
 	}
 
 	//removes a unit from cells
@@ -1458,7 +1411,7 @@ namespace Game {
 
 					// Only clear the cell if its the unit we expect to clear out of it
 					if (getCell(currPos)->getUnit(currentField) == unit) {
-						getCell(currPos)->setUnit(currentField, NULL);
+						setCellUnit(currPos, currentField, NULL);
 					}
 				} else if (ut->hasCellMap() == true &&
 					ut->getAllowEmptyCellMap() == true &&
@@ -1472,6 +1425,197 @@ namespace Game {
 				}
 			}
 		}
+		if (ut->isMobile() == false || unit->getType()->isMobile() == false) {
+			notifyStaticCellsChanged(pos, ut->getSize());
+		}
+	}
+
+	// ==================== unit buckets ====================
+
+	void Map::initUnitBuckets() {
+		unitBucketsW = (w + unitBucketSize - 1) / unitBucketSize;
+		unitBucketsH = (h + unitBucketSize - 1) / unitBucketSize;
+		unitBucketCounts.assign(unitBucketsW * unitBucketsH * (unitBucketTeamSlots + 1), 0);
+	}
+
+	// The counts are kept per team, a faction switching teams moves all of
+	// its unit cells to another slot so they are counted again from the cells
+	void Map::rebuildUnitBuckets() {
+		unitBucketCounts.assign(unitBucketsW * unitBucketsH * (unitBucketTeamSlots + 1), 0);
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				Cell *cell = getCell(x, y);
+				int *counts = &unitBucketCounts[((y / unitBucketSize) * unitBucketsW + (x / unitBucketSize)) * (unitBucketTeamSlots + 1)];
+				for (int field = 0; field < ACTUAL_FIELD_COUNT; ++field) {
+					Unit *unit = cell->getUnit(static_cast<Field>(field));
+					if (unit != NULL) {
+						int team = unit->getTeam();
+						if (team >= 0 && team < unitBucketTeamSlots) {
+							counts[team]++;
+						}
+						counts[unitBucketTeamSlots]++;
+					}
+				}
+			}
+		}
+	}
+
+	// Every unit placed in or removed from a cell goes through here so the
+	// bucket counts always match the cells. Teams out of range only count
+	// in the total, which makes them look like enemies to everyone.
+	void Map::setCellUnit(const Vec2i &pos, Field field, Unit *unit) {
+		Cell *cell = getCell(pos);
+		Unit *current = cell->getUnit(field);
+		if (current != unit) {
+			int *counts = &unitBucketCounts[((pos.y / unitBucketSize) * unitBucketsW + (pos.x / unitBucketSize)) * (unitBucketTeamSlots + 1)];
+			if (current != NULL) {
+				int team = current->getTeam();
+				if (team >= 0 && team < unitBucketTeamSlots) {
+					counts[team]--;
+				}
+				counts[unitBucketTeamSlots]--;
+			}
+			if (unit != NULL) {
+				int team = unit->getTeam();
+				if (team >= 0 && team < unitBucketTeamSlots) {
+					counts[team]++;
+				}
+				counts[unitBucketTeamSlots]++;
+			}
+		}
+		cell->setUnit(field, unit);
+	}
+
+	// ==================== resource buckets ====================
+
+	void Map::initResourceBuckets() {
+		resourceBucketTypes.clear();
+		for (int index = 0; index < getSurfaceCellArraySize(); ++index) {
+			Resource *r = surfaceCells[index].getResource();
+			if (r != NULL && getResourceBucketTypeIndex(r->getType()) < 0) {
+				resourceBucketTypes.push_back(r->getType());
+			}
+		}
+
+		int typeCount = (int) resourceBucketTypes.size();
+		resourceBucketCounts.assign(unitBucketsW * unitBucketsH * typeCount, 0);
+		for (int sy = 0; sy < surfaceH; ++sy) {
+			for (int sx = 0; sx < surfaceW; ++sx) {
+				Resource *r = getSurfaceCell(sx, sy)->getResource();
+				if (r != NULL) {
+					int x = sx * cellScale;
+					int y = sy * cellScale;
+					resourceBucketCounts[((y / unitBucketSize) * unitBucketsW + (x / unitBucketSize)) * typeCount + getResourceBucketTypeIndex(r->getType())]++;
+				}
+			}
+		}
+	}
+
+	int Map::getResourceBucketTypeIndex(const ResourceType *rt) const {
+		for (unsigned int index = 0; index < resourceBucketTypes.size(); ++index) {
+			if (resourceBucketTypes[index] == rt) {
+				return index;
+			}
+		}
+		return -1;
+	}
+
+	// Resources that run out go through here so the buckets stay in step
+	void Map::deleteResource(const Vec2i &surfacePos) {
+		SurfaceCell *sc = getSurfaceCell(surfacePos);
+		Resource *r = sc->getResource();
+		if (r != NULL) {
+			int typeIndex = getResourceBucketTypeIndex(r->getType());
+			if (typeIndex >= 0) {
+				int x = surfacePos.x * cellScale;
+				int y = surfacePos.y * cellScale;
+				resourceBucketCounts[((y / unitBucketSize) * unitBucketsW + (x / unitBucketSize)) * resourceBucketTypes.size() + typeIndex]--;
+			}
+		}
+		sc->deleteResource();
+	}
+
+	string Map::getUnitBucketStats() const {
+		int bucketCount = unitBucketsW * unitBucketsH;
+		int occupiedCount = 0;
+		int cellCount = 0;
+		for (int index = 0; index < bucketCount; ++index) {
+			int total = unitBucketCounts[index * (unitBucketTeamSlots + 1) + unitBucketTeamSlots];
+			if (total > 0) {
+				occupiedCount++;
+				cellCount += total;
+			}
+		}
+
+		char szBuf[8096] = "";
+		snprintf(szBuf, 8096, "buckets [%d] occupied [%d] unit cells [%d]", bucketCount, occupiedCount, cellCount);
+		return szBuf;
+	}
+
+	// ==================== visibility ====================
+
+	void Map::addVisibleCells(int teamIndex, const vector<SurfaceCell *> &cellList) {
+		for (unsigned int index = 0; index < cellList.size(); ++index) {
+			SurfaceCell *sc = cellList[index];
+			sc->incVisibleCount(teamIndex);
+			if (sc->isVisible(teamIndex) == false) {
+				sc->setVisible(teamIndex, true);
+			}
+		}
+	}
+
+	// Cells stay visible until the next hideUnseenCells, just like they
+	// used to stay visible until the next full fog of war reset
+	void Map::removeVisibleCells(int teamIndex, const vector<SurfaceCell *> &cellList) {
+		for (unsigned int index = 0; index < cellList.size(); ++index) {
+			SurfaceCell *sc = cellList[index];
+			if (sc->decVisibleCount(teamIndex) == true) {
+				unseenCells.push_back(make_pair(sc, teamIndex));
+			}
+		}
+	}
+
+	void Map::hideUnseenCells(bool fogOfWar) {
+		if (fogOfWar == true) {
+			for (unsigned int index = 0; index < unseenCells.size(); ++index) {
+				SurfaceCell *sc = unseenCells[index].first;
+				int teamIndex = unseenCells[index].second;
+				if (sc->getVisibleCount(teamIndex) == 0) {
+					sc->setVisible(teamIndex, false);
+				}
+			}
+		}
+		unseenCells.clear();
+	}
+
+	void Map::clearVisibleCounts() {
+		for (int index = 0; index < getSurfaceCellArraySize(); ++index) {
+			for (int teamIndex = 0; teamIndex < GameConstants::maxPlayers + GameConstants::specialFactions; ++teamIndex) {
+				surfaceCells[index].clearVisibleCount(teamIndex);
+			}
+		}
+		unseenCells.clear();
+	}
+
+	// ==================== observers ====================
+
+	void Map::addObserver(MapObserver *observer) {
+		if (std::find(observers.begin(), observers.end(), observer) == observers.end()) {
+			observers.push_back(observer);
+		}
+	}
+
+	void Map::removeObserver(MapObserver *observer) {
+		vector<MapObserver *>::iterator iterFind = std::find(observers.begin(), observers.end(), observer);
+		if (iterFind != observers.end()) {
+			observers.erase(iterFind);
+		}
+	}
+
+	void Map::notifyStaticCellsChanged(const Vec2i &pos, int size) {
+		for (unsigned int index = 0; index < observers.size(); ++index) {
+			observers[index]->staticCellsChanged(pos, size);
+		}
 	}
 
 	// ==================== misc ====================
@@ -1847,6 +1991,7 @@ namespace Game {
 			SurfaceCell &surfaceCell = surfaceCells[i];
 			surfaceCell.loadGame(mapNode, i, world);
 		}
+		initResourceBuckets();
 
 		int surfaceCellIndexExplored = 0;
 		int surfaceCellIndexVisible = 0;
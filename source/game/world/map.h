@@ -152,6 +152,7 @@ namespace Game {
 		//visibility
 		bool visible[GameConstants::maxPlayers + GameConstants::specialFactions];
 		bool explored[GameConstants::maxPlayers + GameConstants::specialFactions];
+		uint16 visibleCount[GameConstants::maxPlayers + GameConstants::specialFactions];
 
 		//cache
 		bool nearSubmerged;
@@ -203,6 +204,9 @@ namespace Game {
 		inline bool isExplored(int teamIndex) const {
 			return explored[teamIndex];
 		}
+		inline int getVisibleCount(int teamIndex) const {
+			return visibleCount[teamIndex];
+		}
 		string isVisibleString() const;
 		string isExploredString() const;
 
@@ -234,6 +238,19 @@ namespace Game {
 		}
 		void setExplored(int teamIndex, bool explored);
 		void setVisible(int teamIndex, bool visible);
+		inline void incVisibleCount(int teamIndex) {
+			visibleCount[teamIndex]++;
+		}
+		//returns true when no unit of the team sees the cell anymore
+		inline bool decVisibleCount(int teamIndex) {
+			if (visibleCount[teamIndex] > 0) {
+				visibleCount[teamIndex]--;
+			}
+			return visibleCount[teamIndex] == 0;
+		}
+		inline void clearVisibleCount(int teamIndex) {
+			visibleCount[teamIndex] = 0;
+		}
 		inline void setNearSubmerged(bool nearSubmerged) {
 			this->nearSubmerged = nearSubmerged;
 		}
@@ -264,21 +281,29 @@ namespace Game {
 	///	Represents the game map (and loads it from a gbm file)
 	// =====================================================
 
-	class FastAINodeCache {
+	// =====================================================
+	// 	class MapObserver
+	//
+	///	Gets notified when the static occupancy of cells changes,
+	///	that is buildings placed / removed or tileset objects removed
+	// =====================================================
+
+	class MapObserver {
 	public:
-		explicit FastAINodeCache(Unit *unit) {
-			this->unit = unit;
+		virtual ~MapObserver() {
 		}
-		Unit *unit;
-		std::map<Vec2i, std::map<Vec2i, bool> > cachedCanMoveSoonList;
+		virtual void staticCellsChanged(const Vec2i &pos, int size) = 0;
 	};
 
 	class Map {
 	public:
 		static const int cellScale;	//number of cells per surfaceCell
 		static const int mapScale;	//horizontal scale of surface
+		static const int unitBucketSize;	//cells per side of a unit bucket
 
 	private:
+		static const int unitBucketTeamSlots;
+
 		string title;
 		float waterLevel;
 		float heightFactor;
@@ -298,6 +323,13 @@ namespace Game {
 		Checksum checksumValue;
 		float maxMapHeight;
 		string mapFile;
+		vector<MapObserver *> observers;
+		int unitBucketsW;
+		int unitBucketsH;
+		vector<int> unitBucketCounts;
+		vector<const ResourceType *> resourceBucketTypes;
+		vector<int> resourceBucketCounts;
+		vector<pair<SurfaceCell *, int> > unseenCells;
 
 	private:
 		Map(Map&);
@@ -415,6 +447,49 @@ namespace Game {
 		inline bool isInsideSurface(const Vec2i &sPos) const {
 			return isInsideSurface(sPos.x, sPos.y);
 		}
+
+		//unit buckets, the number of cells holding a unit per team in each
+		//square of unitBucketSize cells so range scans can skip empty squares
+		inline bool hasUnitsInBucket(int x, int y, int excludedTeam = -1) const {
+			int stride = unitBucketTeamSlots + 1;
+			const int *counts = &unitBucketCounts[((y / unitBucketSize) * unitBucketsW + (x / unitBucketSize)) * stride];
+			int result = counts[unitBucketTeamSlots];
+			if (excludedTeam >= 0 && excludedTeam < unitBucketTeamSlots) {
+				result -= counts[excludedTeam];
+			}
+			return result > 0;
+		}
+		inline static int getUnitBucketLastCoord(int coord) {
+			return (coord / unitBucketSize) * unitBucketSize + unitBucketSize - 1;
+		}
+		string getUnitBucketStats() const;
+		void rebuildUnitBuckets();
+
+		//resource buckets, the number of resource surface cells of each type
+		//in the same squares, only resources that exist when the map is set
+		//up are indexed as none appear later
+		int getResourceBucketTypeIndex(const ResourceType *rt) const;
+		inline int getResourceBucketTypeCount() const {
+			return (int) resourceBucketTypes.size();
+		}
+		inline const ResourceType * getResourceBucketType(int typeIndex) const {
+			return resourceBucketTypes[typeIndex];
+		}
+		inline bool hasResourcesInBucket(int x, int y, int typeIndex) const {
+			return typeIndex >= 0 &&
+				resourceBucketCounts[((y / unitBucketSize) * unitBucketsW + (x / unitBucketSize)) * resourceBucketTypes.size() + typeIndex] > 0;
+		}
+		inline static int getUnitBucketFirstCoord(int coord) {
+			return (coord / unitBucketSize) * unitBucketSize;
+		}
+		void deleteResource(const Vec2i &surfacePos);
+
+		//visible cells, each unit adds its sight once and takes it back when
+		//it moves or dies, cells nobody sees anymore wait for hideUnseenCells
+		void addVisibleCells(int teamIndex, const vector<SurfaceCell *> &cellList);
+		void removeVisibleCells(int teamIndex, const vector<SurfaceCell *> &cellList);
+		void hideUnseenCells(bool fogOfWar);
+		void clearVisibleCounts();
 		bool isResourceNear(int frameIndex, const Vec2i &pos, const ResourceType *rt, Vec2i &resourcePos, int size, Unit *unit = NULL, bool fallbackToPeersHarvestingSameResource = false, Vec2i *resourceClickPos = NULL) const;
 
 		//free cells
@@ -427,14 +502,23 @@ namespace Game {
 		bool isAproxFreeCells(const Vec2i &pos, int size, Field field) const;
 		bool isAproxFreeCells(const Vec2i &pos, int size, Field field, int teamIndex) const;
 		bool canMorph(const Vec2i &pos, const Unit *currentUnit, const UnitType *targetUnitType) const;
+
+		//static free cells, ignores mobile units which will move away sooner or later
+		bool isStaticFreeCell(const Vec2i &pos, Field field) const;
+		bool isStaticFreeCells(const Vec2i &pos, int size, Field field) const;
 		//bool canOccupy(const Vec2i &pos, Field field, const UnitType *ut, CardinalDir facing);
 
 		//unit placement
-		bool aproxCanMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2, std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<int, std::map<Field, bool> > > > > *lookupCache = NULL) const;
-		bool canMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2, std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<Field, bool> > > > *lookupCache = NULL) const;
+		bool aproxCanMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2) const;
+		bool canMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2) const;
 		void putUnitCells(Unit *unit, const Vec2i &pos, bool ignoreSkill = false, bool threaded = false, bool forcePut = false);
 		void clearUnitCells(Unit *unit, const Vec2i &pos, bool ignoreSkill = false);
 
+		//observers
+		void addObserver(MapObserver *observer);
+		void removeObserver(MapObserver *observer);
+		void notifyStaticCellsChanged(const Vec2i &pos, int size);
+
 		Vec2i computeRefPos(const Selection *selection) const;
 		Vec2i computeDestPos(const Vec2i &refUnitPos, const Vec2i &unitPos,
 			const Vec2i &commandPos) const;
@@ -703,6 +787,9 @@ namespace Game {
 		void computeNearSubmerged();
 		void computeCellColors();
 		void putUnitCellsPrivate(Unit *unit, const Vec2i &pos, const UnitType *ut, bool isMorph, bool threaded, bool forcePut = false);
+		void initUnitBuckets();
+		void initResourceBuckets();
+		void setCellUnit(const Vec2i &pos, Field field, Unit *unit);
 	};
 
 
@@ -20,6 +20,7 @@
 #include "minimap.h"
 
 #include <cassert>
+#include <climits>
 
 #include "world.h"
 #include "vec.h"
@@ -49,6 +50,7 @@ namespace Game {
 		gameSettings = NULL;
 		tex = NULL;
 		fowTex = NULL;
+		setFowDirtyAll();
 	}
 
 	void Minimap::init(int w, int h, const World *world, bool fogOfWar) {
@@ -119,6 +121,7 @@ namespace Game {
 
 		if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
+		setFowDirtyAll();
 		computeTexture(world);
 	}
 
@@ -147,6 +150,9 @@ namespace Game {
 
 			if (fowPixmap1->getPixelf(sPos.x, sPos.y) < alpha) {
 				fowPixmap1->setPixel(sPos.x, sPos.y, alpha);
+				if (fowPixmap0->getPixelf(sPos.x, sPos.y) != alpha) {
+					setFowChanged(sPos.x, sPos.y);
+				}
 			}
 
 			if (fowPixmap1Copy != NULL && isIncrementalUpdate == true) {
@@ -168,6 +174,8 @@ namespace Game {
 	void Minimap::restoreFowTexAlphaSurface() {
 		if (fowPixmap1 != NULL && fowPixmap1_default != NULL) {
 			fowPixmap1->copy(fowPixmap1_default);
+			fowChangedMin = Vec2i(0, 0);
+			fowChangedMax = Vec2i(INT_MAX, INT_MAX);
 		}
 		if (fowPixmap1Copy != NULL && fowPixmap1Copy_default != NULL) {
 			fowPixmap1Copy->copy(fowPixmap1Copy_default);
@@ -194,9 +202,14 @@ namespace Game {
 		if (fowPixmap1 != NULL && fowPixmap1Copy != NULL) {
 			fowPixmap1->copy(fowPixmap1Copy);
 		}
+		setFowDirtyAll();
 	}
 
+	// The pixels where the pixmaps differ are collected while fowPixmap1 is
+	// rewritten, updateFowTex then doesn't have to look for them
 	void Minimap::resetFowTex() {
+		fowChangedMin = Vec2i(INT_MAX, INT_MAX);
+		fowChangedMax = Vec2i(-1, -1);
 		if (fowTex && fowPixmap0 && fowPixmap1) {
 			Pixmap2D *tmpPixmap = fowPixmap0;
 			fowPixmap0 = fowPixmap1;
@@ -221,6 +234,9 @@ namespace Game {
 							fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p0);
 						} else {
 							fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p1);
+							if (p0 != p1) {
+								setFowChanged(indexPixelWidth, indexPixelHeight);
+							}
 						}
 					} else if ((fogOfWar && overridefogOfWarValue) ||
 						(gameSettings->getFlagTypes1() & ft1_show_map_resources) == ft1_show_map_resources) {
@@ -230,27 +246,42 @@ namespace Game {
 						float p1 = fowPixmap1->getPixelf(indexPixelWidth, indexPixelHeight);
 
 						if (p1 > exploredAlpha) {
-							fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, exploredAlpha);
+							p1 = exploredAlpha;
+							fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p1);
 						}
 						if (p0 > p1) {
 							fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p0);
+						} else if (p0 != p1) {
+							setFowChanged(indexPixelWidth, indexPixelHeight);
 						}
 					} else {
 						//printf("Line: %d\n",__LINE__);
 						fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, 1.f);
+						if (fowPixmap0->getPixelf(indexPixelWidth, indexPixelHeight) != 1.f) {
+							setFowChanged(indexPixelWidth, indexPixelHeight);
+						}
 					}
 				}
 			}
 		}
 	}
 
+	// Outside the dirty rectangle fowTex already matches both pixmaps, so
+	// only the pixels changed by the last fog of war update are blended
 	void Minimap::updateFowTex(float t) {
 		if (fowTex && fowPixmap0 && fowPixmap1) {
-			for (int indexPixelWidth = 0;
-				indexPixelWidth < fowPixmap0->getW();
+			fowDirtyMin.x = min(fowDirtyMin.x, fowChangedMin.x);
+			fowDirtyMin.y = min(fowDirtyMin.y, fowChangedMin.y);
+			fowDirtyMax.x = max(fowDirtyMax.x, fowChangedMax.x);
+			fowDirtyMax.y = max(fowDirtyMax.y, fowChangedMax.y);
+
+			int maxX = min(fowDirtyMax.x, fowPixmap0->getW() - 1);
+			int maxY = min(fowDirtyMax.y, fowPixmap0->getH() - 1);
+			for (int indexPixelWidth = max(fowDirtyMin.x, 0);
+				indexPixelWidth <= maxX;
 				++indexPixelWidth) {
-				for (int indexPixelHeight = 0;
-					indexPixelHeight < fowPixmap0->getH();
+				for (int indexPixelHeight = max(fowDirtyMin.y, 0);
+					indexPixelHeight <= maxY;
 					++indexPixelHeight) {
 					float p1 = fowPixmap1->getPixelf(indexPixelWidth, indexPixelHeight);
 					float p2 = fowTex->getPixmap()->getPixelf(indexPixelWidth, indexPixelHeight);
@@ -260,11 +291,22 @@ namespace Game {
 					}
 				}
 			}
+
+			// pixels where both pixmaps agree are final now
+			fowDirtyMin = fowChangedMin;
+			fowDirtyMax = fowChangedMax;
 		}
 	}
 
 	// ==================== PRIVATE ====================
 
+	void Minimap::setFowDirtyAll() {
+		fowDirtyMin = Vec2i(0, 0);
+		fowDirtyMax = Vec2i(INT_MAX, INT_MAX);
+		fowChangedMin = fowDirtyMin;
+		fowChangedMax = fowDirtyMax;
+	}
+
 	void Minimap::computeTexture(const World *world) {
 
 		Vec4f color;
@@ -326,6 +368,7 @@ namespace Game {
 				fowPixmap1->getPixels()[pixelIndex] = fowPixmap1Node->getAttribute("pixel")->getIntValue();
 			}
 		}
+		setFowDirtyAll();
 	}
 
 } //end namespace
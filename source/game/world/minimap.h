@@ -67,6 +67,14 @@ namespace Game {
 		bool fogOfWar;
 		const GameSettings *gameSettings;
 
+		//pixels of fowTex updateFowTex has to visit, fowChanged* bound the
+		//pixels where fowPixmap0 and fowPixmap1 differ, grown as fowPixmap1
+		//is written
+		Vec2i fowDirtyMin;
+		Vec2i fowDirtyMax;
+		Vec2i fowChangedMin;
+		Vec2i fowChangedMax;
+
 	private:
 		static const float exploredAlpha;
 
@@ -98,6 +106,13 @@ namespace Game {
 
 	private:
 		void computeTexture(const World *world);
+		void setFowDirtyAll();
+		inline void setFowChanged(int x, int y) {
+			fowChangedMin.x = min(fowChangedMin.x, x);
+			fowChangedMin.y = min(fowChangedMin.y, y);
+			fowChangedMax.x = max(fowChangedMax.x, x);
+			fowChangedMax.y = max(fowChangedMax.y, y);
+		}
 	};
 
 } //end namespace
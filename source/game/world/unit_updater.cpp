@@ -43,16 +43,16 @@ using namespace Shared::Graphics;
 using namespace Shared::Util;
 
 namespace Game {
+	// setting read for every unit update
+	static ConfigBool disableWaterSoundsConfig("DisableWaterSounds", "false");
+
 	// =====================================================
 	// 	class UnitUpdater
 	// =====================================================
 
-	time_t UnitRangeCellsLookupItem::lastDebug = 0;
-
 	// ===================== PUBLIC ========================
 
-	UnitUpdater::UnitUpdater() : mutexAttackWarnings(new Mutex(CODE_AT_LINE)),
-		mutexUnitRangeCellsLookupItemCache(new Mutex(CODE_AT_LINE)) {
+	UnitUpdater::UnitUpdater() : mutexAttackWarnings(new Mutex(CODE_AT_LINE)) {
 		this->game = NULL;
 		this->gui = NULL;
 		this->gameCamera = NULL;
@@ -61,7 +61,6 @@ namespace Game {
 		this->console = NULL;
 		this->scriptManager = NULL;
 		this->pathFinder = NULL;
-		//UnitRangeCellsLookupItemCacheTimerCount = 0;
 		attackWarnRange = 0;
 	}
 
@@ -76,12 +75,12 @@ namespace Game {
 		this->scriptManager = game->getScriptManager();
 		this->pathFinder = NULL;
 		attackWarnRange = Config::getInstance().getFloat("AttackWarnRange", "50.0");
-		//UnitRangeCellsLookupItemCacheTimerCount = 0;
 
 		switch (this->game->getGameSettings()->getPathFinderType()) {
 			case pfBasic:
 				pathFinder = new PathFinder();
 				pathFinder->init(map);
+				map->addObserver(pathFinder);
 				break;
 			default:
 				throw game_runtime_error("detected unsupported pathfinder type!");
@@ -101,8 +100,9 @@ namespace Game {
 	}
 
 	UnitUpdater::~UnitUpdater() {
-		//UnitRangeCellsLookupItemCache.clear();
-
+		if (map != NULL && pathFinder != NULL) {
+			map->removeObserver(pathFinder);
+		}
 		delete pathFinder;
 		pathFinder = NULL;
 
@@ -117,9 +117,6 @@ namespace Game {
 
 		delete mutexAttackWarnings;
 		mutexAttackWarnings = NULL;
-
-		delete mutexUnitRangeCellsLookupItemCache;
-		mutexUnitRangeCellsLookupItemCache = NULL;
 	}
 
 	// ==================== progress skills ====================
@@ -319,7 +316,7 @@ namespace Game {
 
 				//play water sound
 				if (map->getCell(unit->getPos())->getHeight() < map->getWaterLevel() && SkillType::toActualField(unit->getCurrField()) == fLand) {
-					if (Config::getInstance().getBool("DisableWaterSounds", "false") == false) {
+					if (disableWaterSoundsConfig.get() == false) {
 						soundRenderer.playFx(
 							CoreData::getInstance().getWaterSound(),
 							unit->getCurrMidHeightVector(),
@@ -629,10 +626,14 @@ namespace Game {
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance, "In [%s::%s Line: %d] took msecs: %lld\n", __FILE__, __FUNCTION__, __LINE__, chrono.getMillis());
 
 
+			// every unit of a group move heads for the same position, so they
+			// can share one flow field instead of searching separately
+			bool useFlowField = (command->getUnit() == NULL && command->getUnitCommandGroupId() >= 0);
+
 			TravelState tsValue = tsImpossible;
 			switch (this->game->getGameSettings()->getPathFinderType()) {
 				case pfBasic:
-					tsValue = pathFinder->findPath(unit, pos, NULL, frameIndex);
+					tsValue = pathFinder->findPath(unit, pos, NULL, frameIndex, useFlowField);
 					break;
 				default:
 					throw game_runtime_error("detected unsupported pathfinder type!");
@@ -1824,11 +1825,12 @@ namespace Game {
 									//if resource exausted, then delete it and stop
 									if (sc->decAmount(1)) {
 										//const ResourceType *rt = r->getType();
-										sc->deleteResource();
+										map->deleteResource(Map::toSurfCoords(unitTargetPos));
 										world->removeResourceTargetFromCache(unitTargetPos);
 
 										switch (this->game->getGameSettings()->getPathFinderType()) {
 											case pfBasic:
+												map->notifyStaticCellsChanged(Map::toUnitCoords(Map::toSurfCoords(unitTargetPos)), Map::cellScale);
 												break;
 											default:
 												throw game_runtime_error("detected unsupported pathfinder type!");
@@ -2778,19 +2780,51 @@ namespace Game {
 	bool UnitUpdater::searchForResource(Unit *unit, const HarvestCommandType *hct) {
 		Vec2i pos = unit->getCurrCommand()->getPos();
 
+		// resource bucket types this command can harvest
+		vector<int> typeIndexes;
+		for (int typeIndex = 0; typeIndex < map->getResourceBucketTypeCount(); ++typeIndex) {
+			if (hct->canHarvest(map->getResourceBucketType(typeIndex))) {
+				typeIndexes.push_back(typeIndex);
+			}
+		}
+		if (typeIndexes.empty() == true) {
+			return false;
+		}
+
+		// Every cell closer than radius was already rejected, so only the
+		// ring at radius is looked at, in the same x then y order as a scan
+		// of the whole square. Squares without a harvestable resource are
+		// skipped as a whole.
 		for (int radius = 0; radius < maxResSearchRadius; radius++) {
 			for (int i = pos.x - radius; i <= pos.x + radius; ++i) {
-				for (int j = pos.y - radius; j <= pos.y + radius; ++j) {
-					if (map->isInside(i, j)) {
-						Resource *r = map->getSurfaceCell(Map::toSurfCoords(Vec2i(i, j)))->getResource();
-						if (r != NULL) {
-							if (hct->canHarvest(r->getType())) {
-								const Vec2i newPos = Vec2i(i, j);
-								if (unit->isBadHarvestPos(newPos) == false) {
-									unit->getCurrCommand()->setPos(newPos);
-
-									return true;
-								}
+				bool edgeColumn = (i == pos.x - radius || i == pos.x + radius);
+				int step = (edgeColumn == true || radius == 0 ? 1 : radius * 2);
+				for (int j = pos.y - radius; j <= pos.y + radius; j += step) {
+					if (map->isInside(i, j) == false) {
+						continue;
+					}
+					bool bucketHasResources = false;
+					for (unsigned int index = 0; index < typeIndexes.size(); ++index) {
+						if (map->hasResourcesInBucket(i, j, typeIndexes[index]) == true) {
+							bucketHasResources = true;
+							break;
+						}
+					}
+					if (bucketHasResources == false) {
+						if (edgeColumn == true) {
+							j = min(Map::getUnitBucketLastCoord(j), pos.y + radius);
+						}
+						continue;
+					}
+
+					Resource *r = map->getSurfaceCell(Map::toSurfCoords(Vec2i(i, j)))->getResource();
+					if (r != NULL) {
+						if (hct->canHarvest(r->getType())) {
+							const Vec2i newPos = Vec2i(i, j);
+							if (unit->isBadHarvestPos(newPos) == false) {
+								unit->getCurrCommand()->setPos(newPos);
+
+								return true;
 							}
 						}
 					}
@@ -2816,31 +2850,32 @@ namespace Game {
 		return unitOnRange(unit, range, rangedPtr, ast, evalMode);
 	}
 
-	bool UnitUpdater::findCachedCellsEnemies(Vec2i center, int range, int size, vector<Unit*> &enemies,
-		const AttackSkillType *ast, const Unit *unit,
-		const Unit *commandTarget) {
-		bool result = false;
-		MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache, string(__FILE__) + "_" + intToStr(__LINE__));
-		std::map<Vec2i, std::map<int, std::map<int, UnitRangeCellsLookupItem > > >::iterator iterFind = UnitRangeCellsLookupItemCache.find(center);
-
-		if (iterFind != UnitRangeCellsLookupItemCache.end()) {
-			std::map<int, std::map<int, UnitRangeCellsLookupItem > >::iterator iterFind3 = iterFind->second.find(size);
-			if (iterFind3 != iterFind->second.end()) {
-				std::map<int, UnitRangeCellsLookupItem>::iterator iterFind4 = iterFind3->second.find(range);
-				if (iterFind4 != iterFind3->second.end()) {
-					result = true;
-
-					std::vector<Cell *> &cellList = iterFind4->second.rangeCellList;
-					for (int idx = 0; idx < (int) cellList.size(); ++idx) {
-						Cell *cell = cellList[idx];
+	// Cells around center within range in the same x then y order as a plain
+	// scan, squares of the map without a unit of another team than
+	// excludedTeam are skipped as a whole
+	void UnitUpdater::findCellsInRange(const Unit *unit, const Vec2i &center, int range, int excludedTeam, vector<Cell *> &cells) const {
+		int size = unit->getType()->getSize();
+		Vec2f floatCenter = unit->getFloatCenteredPos();
 
-						findEnemiesForCell(ast, cell, unit, commandTarget, enemies);
-					}
+		for (int i = center.x - range; i < center.x + range + size; ++i) {
+			for (int j = center.y - range; j < center.y + range + size; ++j) {
+				if (map->isInside(i, j) == false) {
+					continue;
+				}
+				if (map->hasUnitsInBucket(i, j, excludedTeam) == false) {
+					j = Map::getUnitBucketLastCoord(j);
+					continue;
+				}
+				//cells inside map and in range
+#ifdef USE_STREFLOP
+				if (streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float) i, (float) j)))) <= (range + 1)) {
+#else
+				if (floor(floatCenter.dist(Vec2f((float) i, (float) j))) <= (range + 1)) {
+#endif
+					cells.push_back(map->getCell(i, j));
 				}
 			}
 		}
-
-		return result;
 	}
 
 	void UnitUpdater::findEnemiesForCell(const AttackSkillType *ast, Cell *cell, const Unit *unit,
@@ -2873,6 +2908,11 @@ namespace Game {
 			for (int i = pos.x - sightRange; i < pos.x + size + sightRange; ++i) {
 				for (int j = pos.y - sightRange; j < pos.y + size + sightRange; ++j) {
 					Vec2i testPos(i, j);
+					if (map->isInside(testPos) &&
+						map->hasUnitsInBucket(i, j, faction->getTeam()) == false) {
+						j = Map::getUnitBucketLastCoord(j);
+						continue;
+					}
 					if (map->isInside(testPos) &&
 						map->isInsideSurface(map->toSurfCoords(testPos))) {
 						Cell *cell = map->getCell(testPos);
@@ -2914,41 +2954,13 @@ namespace Game {
 			if (commandTarget != NULL && commandTarget->isDead()) {
 				commandTarget = NULL;
 			}
-			//aux vars
-			int size = unit->getType()->getSize();
-			Vec2i center = unit->getPos();
-			Vec2f floatCenter = unit->getFloatCenteredPos();
-
-			//bool foundInCache = true;
-			if (findCachedCellsEnemies(center, range, size, enemies, ast,
-				unit, commandTarget) == false) {
-
-				//foundInCache = false;
-				//nearby cells
-				UnitRangeCellsLookupItem cacheItem;
-				for (int i = center.x - range; i < center.x + range + size; ++i) {
-					for (int j = center.y - range; j < center.y + range + size; ++j) {
-						//cells inside map and in range
-#ifdef USE_STREFLOP
-						if (map->isInside(i, j) && streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float) i, (float) j)))) <= (range + 1)) {
-#else
-						if (map->isInside(i, j) && floor(floatCenter.dist(Vec2f((float) i, (float) j))) <= (range + 1)) {
-#endif
-							Cell *cell = map->getCell(i, j);
-							findEnemiesForCell(ast, cell, unit, commandTarget, enemies);
-
-							cacheItem.rangeCellList.push_back(cell);
-						}
-					}
-				}
-
-
-				// Ok update our caches with the latest info
-				if (cacheItem.rangeCellList.empty() == false) {
-					MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache, string(__FILE__) + "_" + intToStr(__LINE__));
-
-					UnitRangeCellsLookupItemCache[center][size][range] = cacheItem;
-				}
+			//nearby cells, only the command target or units of other teams
+			//can be picked
+			vector<Cell *> cells;
+			findCellsInRange(unit, unit->getPos(), range,
+				(commandTarget == NULL ? unit->getTeam() : -1), cells);
+			for (unsigned int index = 0; index < cells.size(); ++index) {
+				findEnemiesForCell(ast, cells[index], unit, commandTarget, enemies);
 			}
 
 			//attack enemies that can attack first
@@ -3143,40 +3155,11 @@ namespace Game {
 			//		commandTarget = NULL;
 			//	}
 
-			//aux vars
-			int size = unit->getType()->getSize();
-			Vec2i center = unit->getPosNotThreadSafe();
-			Vec2f floatCenter = unit->getFloatCenteredPos();
-
-			//bool foundInCache = true;
-			if (findCachedCellsEnemies(center, range, size, enemies, ast,
-				unit, commandTarget) == false) {
-
-				//foundInCache = false;
-				//nearby cells
-				UnitRangeCellsLookupItem cacheItem;
-				for (int i = center.x - range; i < center.x + range + size; ++i) {
-					for (int j = center.y - range; j < center.y + range + size; ++j) {
-						//cells inside map and in range
-#ifdef USE_STREFLOP
-						if (map->isInside(i, j) && streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float) i, (float) j)))) <= (range + 1)) {
-#else
-						if (map->isInside(i, j) && floor(floatCenter.dist(Vec2f((float) i, (float) j))) <= (range + 1)) {
-#endif
-							Cell *cell = map->getCell(i, j);
-							findEnemiesForCell(ast, cell, unit, commandTarget, enemies);
-
-							cacheItem.rangeCellList.push_back(cell);
-						}
-					}
-				}
-
-				// Ok update our caches with the latest info
-				if (cacheItem.rangeCellList.empty() == false) {
-					MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache, string(__FILE__) + "_" + intToStr(__LINE__));
-
-					UnitRangeCellsLookupItemCache[center][size][range] = cacheItem;
-				}
+			//nearby cells
+			vector<Cell *> cells;
+			findCellsInRange(unit, unit->getPosNotThreadSafe(), range, unit->getTeam(), cells);
+			for (unsigned int index = 0; index < cells.size(); ++index) {
+				findEnemiesForCell(ast, cells[index], unit, commandTarget, enemies);
 			}
 
 		} catch (const exception &ex) {
@@ -3242,63 +3225,14 @@ namespace Game {
 		int range = radius;
 		vector<Unit*> units;
 
-		//aux vars
-		int size = unit->getType()->getSize();
-		Vec2i center = unit->getPosNotThreadSafe();
-		Vec2f floatCenter = unit->getFloatCenteredPos();
-
 		//nearby cells
-		//UnitRangeCellsLookupItem cacheItem;
-		for (int i = center.x - range; i < center.x + range + size; ++i) {
-			for (int j = center.y - range; j < center.y + range + size; ++j) {
-				//cells inside map and in range
-#ifdef USE_STREFLOP
-				if (map->isInside(i, j) && streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float) i, (float) j)))) <= (range + 1)) {
-#else
-				if (map->isInside(i, j) && floor(floatCenter.dist(Vec2f((float) i, (float) j))) <= (range + 1)) {
-#endif
-					Cell *cell = map->getCell(i, j);
-					findUnitsForCell(cell, units);
-				}
-				}
-			}
-
-		return units;
-		}
-
-	string UnitUpdater::getUnitRangeCellsLookupItemCacheStats() {
-		string result = "";
-
-		int posCount = 0;
-		int sizeCount = 0;
-		int rangeCount = 0;
-		int rangeCountCellCount = 0;
-
-		MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache, string(__FILE__) + "_" + intToStr(__LINE__));
-		for (std::map<Vec2i, std::map<int, std::map<int, UnitRangeCellsLookupItem > > >::iterator iterMap1 = UnitRangeCellsLookupItemCache.begin();
-			iterMap1 != UnitRangeCellsLookupItemCache.end(); ++iterMap1) {
-			posCount++;
-
-			for (std::map<int, std::map<int, UnitRangeCellsLookupItem > >::iterator iterMap2 = iterMap1->second.begin();
-				iterMap2 != iterMap1->second.end(); ++iterMap2) {
-				sizeCount++;
-
-				for (std::map<int, UnitRangeCellsLookupItem>::iterator iterMap3 = iterMap2->second.begin();
-					iterMap3 != iterMap2->second.end(); ++iterMap3) {
-					rangeCount++;
-
-					rangeCountCellCount += (int) iterMap3->second.rangeCellList.size();
-				}
-			}
+		vector<Cell *> cells;
+		findCellsInRange(unit, unit->getPosNotThreadSafe(), range, -1, cells);
+		for (unsigned int index = 0; index < cells.size(); ++index) {
+			findUnitsForCell(cells[index], units);
 		}
 
-		uint64 totalBytes = rangeCountCellCount * sizeof(Cell *);
-		totalBytes /= 1000;
-
-		char szBuf[8096] = "";
-		snprintf(szBuf, 8096, "pos [%d] size [%d] range [%d][%d] total KB: %s", posCount, sizeCount, rangeCount, rangeCountCellCount, formatNumber(totalBytes).c_str());
-		result = szBuf;
-		return result;
+		return units;
 	}
 
 	void UnitUpdater::saveGame(XmlNode *rootNode) {
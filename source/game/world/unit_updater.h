@@ -51,15 +51,6 @@ namespace Game {
 	class ParticleDamager;
 	class Cell;
 
-	class UnitRangeCellsLookupItem {
-	public:
-
-		//int UnitRangeCellsLookupItemCacheTimerCountIndex;
-		std::vector<Cell *> rangeCellList;
-
-		static time_t lastDebug;
-	};
-
 	class AttackWarningData {
 	public:
 		Vec2f attackPosition;
@@ -89,15 +80,8 @@ namespace Game {
 		float attackWarnRange;
 		AttackWarnings attackWarnings;
 
-		Mutex *mutexUnitRangeCellsLookupItemCache;
-		std::map<Vec2i, std::map<int, std::map<int, UnitRangeCellsLookupItem > > > UnitRangeCellsLookupItemCache;
-		//std::map<int,ExploredCellsLookupKey> ExploredCellsLookupItemCacheTimer;
-		//int UnitRangeCellsLookupItemCacheTimerCount;
-
-		bool findCachedCellsEnemies(Vec2i center, int range,
-			int size, vector<Unit*> &enemies,
-			const AttackSkillType *ast, const Unit *unit,
-			const Unit *commandTarget);
+		void findCellsInRange(const Unit *unit, const Vec2i &center, int range,
+			int excludedTeam, vector<Cell *> &cells) const;
 		void findEnemiesForCell(const AttackSkillType *ast, Cell *cell, const Unit *unit,
 			const Unit *commandTarget, vector<Unit*> &enemies);
 
@@ -140,7 +124,6 @@ namespace Game {
 
 		vector<Unit*> findUnitsInRange(const Unit *unit, int radius);
 
-		string getUnitRangeCellsLookupItemCacheStats();
 
 		void saveGame(XmlNode *rootNode);
 		void loadGame(const XmlNode *rootNode);
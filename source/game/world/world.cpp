@@ -30,6 +30,7 @@
 #include "sound_renderer.h"
 #include "game_settings.h"
 #include "cache_manager.h"
+#include "xml_cache.h"
 #include <iostream>
 #include "sound.h"
 #include "sound_renderer.h"
@@ -50,6 +51,10 @@ namespace Game {
 	time_t ExploredCellsLookupItem::lastDebug = 0;
 	Game* World::currentGame = NULL;
 
+	// settings read every frame
+	static ConfigBool showPerfStatsConfig("ShowPerfStats", "false");
+	static ConfigBool newThreadManagerConfig("EnableNewThreadManager", "false");
+
 	// ===================== PUBLIC ========================
 
 	World::World() : mutexFactionNextUnitId(new Mutex(CODE_AT_LINE)) {
@@ -89,6 +94,7 @@ namespace Game {
 		loadWorldNode = NULL;
 		cacheFowAlphaTexture = false;
 		cacheFowAlphaTextureFogOfWarValue = false;
+		visibleCellCountsReady = false;
 
 		if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 	}
@@ -170,6 +176,7 @@ namespace Game {
 		fogOfWarSkillTypeValue = -1;
 		cacheFowAlphaTexture = false;
 		cacheFowAlphaTextureFogOfWarValue = false;
+		visibleCellCountsReady = false;
 
 		map.end();
 
@@ -209,6 +216,7 @@ namespace Game {
 		map.end();
 		cacheFowAlphaTexture = false;
 		cacheFowAlphaTextureFogOfWarValue = false;
+		visibleCellCountsReady = false;
 
 		//stats will be deleted by BattleEnd
 		if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
@@ -441,7 +449,18 @@ namespace Game {
 		Checksum tilsetChecksum;
 
 		if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
-		tilsetChecksum = tileset.loadTileset(pathList, tilesetName, checksum, loadedFileList);
+		bool useXmlTreeCache = beginXmlTreeCache(pathList, tilesetName);
+		try {
+			tilsetChecksum = tileset.loadTileset(pathList, tilesetName, checksum, loadedFileList);
+		} catch (...) {
+			if (useXmlTreeCache == true) {
+				XmlTreeCache::end(false);
+			}
+			throw;
+		}
+		if (useXmlTreeCache == true) {
+			XmlTreeCache::end(Logger::getInstance().getCancelLoading() == false);
+		}
 
 		if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 		timeFlow.init(&tileset);
@@ -472,8 +491,19 @@ namespace Game {
 		if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
 		techTree = new TechTree(pathList);
-		techtreeChecksum = techTree->loadTech(techName, factions,
-			checksum, loadedFileList, validationMode);
+		bool useXmlTreeCache = beginXmlTreeCache(pathList, techName);
+		try {
+			techtreeChecksum = techTree->loadTech(techName, factions,
+				checksum, loadedFileList, validationMode);
+		} catch (...) {
+			if (useXmlTreeCache == true) {
+				XmlTreeCache::end(false);
+			}
+			throw;
+		}
+		if (useXmlTreeCache == true) {
+			XmlTreeCache::end(Logger::getInstance().getCancelLoading() == false);
+		}
 		XmlTree xmlTree;
 		string currentPath = techTree->findPath(techName, pathList);
 		endPathWithSlash(currentPath);
@@ -487,6 +517,24 @@ namespace Game {
 		return techtreeChecksum;
 	}
 
+	// The parsed xml of the techtree or tileset called name is taken from
+	// a binary cache while the crc of its folder matches the cache
+	bool World::beginXmlTreeCache(const vector<string> &pathList, const string &name) {
+		if (Config::getInstance().getBool("EnableXmlTreeCache", "true") == false) {
+			return false;
+		}
+
+		vector<string> folders;
+		for (unsigned int idx = 0; idx < pathList.size(); ++idx) {
+			string currentPath = pathList[idx];
+			endPathWithSlash(currentPath);
+			folders.push_back(currentPath + name + "/");
+		}
+		uint32 folderCRC = getFolderTreeContentsCheckSumRecursively(pathList, string("/") + name + string("/*"), ".xml", NULL);
+		XmlTreeCache::begin(folders, folderCRC);
+		return true;
+	}
+
 	std::vector<std::string> World::validateFactionTypes() {
 		return techTree->validateFactionTypes();
 	}
@@ -588,7 +636,7 @@ namespace Game {
 	}
 
 	void World::updateAllFactionUnits() {
-		bool showPerfStats = Config::getInstance().getBool("ShowPerfStats", "false");
+		bool showPerfStats = showPerfStatsConfig.get();
 		Chrono chronoPerf;
 		if (showPerfStats) chronoPerf.start();
 		char perfBuf[8096] = "";
@@ -631,7 +679,7 @@ namespace Game {
 		Chrono chrono;
 		chrono.start();
 
-		const bool newThreadManager = Config::getInstance().getBool("EnableNewThreadManager", "false");
+		const bool newThreadManager = newThreadManagerConfig.get();
 		if (newThreadManager == true) {
 			masterController.signalSlaves(&frameCount);
 			bool slavesCompleted = masterController.waitTillSlavesTrigger(20000);
@@ -704,6 +752,7 @@ namespace Game {
 			std::map<SkillClass, int> mapSkillCount;
 			int unitCountStuck = 0;
 			int unitCountUpdated = 0;
+			int unitCountSleeping = 0;
 
 			int unitCount = faction->getUnitCount();
 			for (int j = 0; j < unitCount; ++j) {
@@ -712,6 +761,19 @@ namespace Game {
 					throw game_runtime_error("unit == NULL");
 				}
 
+				// dormant units are only due on their wake frame or once an
+				// event woke them
+				if (unit->isSleeping(frameCount) == true) {
+					// particle timing is visual only, so it can't keep a
+					// unit awake without the peers disagreeing on it
+					unit->updateTimedParticles();
+					unit->updateHighlight();
+					unitCountSleeping++;
+					totalUnitsChecked++;
+					continue;
+				}
+				unit->resumeFromSleep(frameCount);
+
 				CommandClass unitCommandClass = ccCount;
 				if (unit->getCurrCommand() != NULL) {
 					unitCommandClass = unit->getCurrCommand()->getCommandType()->getClass();
@@ -738,6 +800,7 @@ namespace Game {
 					mapCommandCount[unitCommandClass] = mapCommandCount[unitCommandClass] + 1;
 					mapSkillCount[unitSkillClass] = mapSkillCount[unitSkillClass] + 1;
 				}
+				unit->sleepIfDormant(frameCount);
 				totalUnitsChecked++;
 
 				if (showPerfStats && chronoPerfUnit.getMillis() >= 10) {
@@ -750,7 +813,7 @@ namespace Game {
 			totalUnitsProcessed += unitCountUpdated;
 
 			if (showPerfStats) {
-				sprintf(perfBuf, "In [%s::%s] Line: %d took msecs: " I64_SPECIFIER " faction: %d / %d unitCount = %d unitCountUpdated = %d unitCountStuck = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chronoPerf.getMillis(), i + 1, factionCount, unitCount, unitCountUpdated, unitCountStuck);
+				sprintf(perfBuf, "In [%s::%s] Line: %d took msecs: " I64_SPECIFIER " faction: %d / %d unitCount = %d unitCountUpdated = %d unitCountStuck = %d unitCountSleeping = %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chronoPerf.getMillis(), i + 1, factionCount, unitCount, unitCountUpdated, unitCountStuck, unitCountSleeping);
 				perfList.push_back(perfBuf);
 
 				for (std::map<CommandClass, int>::iterator iterMap = mapCommandCount.begin();
@@ -840,7 +903,7 @@ namespace Game {
 
 		if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__);
 
-		bool showPerfStats = Config::getInstance().getBool("ShowPerfStats", "false");
+		bool showPerfStats = showPerfStatsConfig.get();
 		Chrono chronoPerf;
 		char perfBuf[8096] = "";
 		std::vector<string> perfList;
@@ -978,7 +1041,7 @@ namespace Game {
 	}
 
 	void World::tick() {
-		bool showPerfStats = Config::getInstance().getBool("ShowPerfStats", "false");
+		bool showPerfStats = showPerfStatsConfig.get();
 		Chrono chronoPerf;
 		char perfBuf[8096] = "";
 		std::vector<string> perfList;
@@ -1966,6 +2029,7 @@ namespace Game {
 
 	//init basic cell state
 	void World::initCells(bool fogOfWar) {
+		visibleCellCountsReady = false;
 		if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
 		Logger::getInstance().add(Lang::getInstance().getString("LogScreenGameLoadingStateCells", ""), true);
@@ -2348,14 +2412,14 @@ namespace Game {
 	}
 
 	void World::exploreCells(int teamIndex, ExploredCellsLookupItem &exploredCellsCache) {
-		std::vector<SurfaceCell*> &cellList = exploredCellsCache.exploredCellList;
-		for (int idx2 = 0; idx2 < (int) cellList.size(); ++idx2) {
-			SurfaceCell* sc = cellList[idx2];
+		const std::vector<SurfaceCell*> &exploredCellList = exploredCellsCache.exploredCellList;
+		for (int idx2 = 0; idx2 < (int) exploredCellList.size(); ++idx2) {
+			SurfaceCell* sc = exploredCellList[idx2];
 			sc->setExplored(teamIndex, true);
 		}
-		cellList = exploredCellsCache.visibleCellList;
-		for (int idx2 = 0; idx2 < (int) cellList.size(); ++idx2) {
-			SurfaceCell* sc = cellList[idx2];
+		const std::vector<SurfaceCell*> &visibleCellList = exploredCellsCache.visibleCellList;
+		for (int idx2 = 0; idx2 < (int) visibleCellList.size(); ++idx2) {
+			SurfaceCell* sc = visibleCellList[idx2];
 			sc->setVisible(teamIndex, true);
 		}
 	}
@@ -2556,6 +2620,29 @@ namespace Game {
 
 		if (this->game) chronoGamePerformanceCounts.start();
 
+		// Visibility is kept up to date by the units as they move, so the cells
+		// are only reset when the counts have to be built from scratch
+		if (visibleCellCountsReady == false) {
+			map.clearVisibleCounts();
+			for (int factionIndex = 0; factionIndex < getFactionCount(); ++factionIndex) {
+				Faction *faction = getFaction(factionIndex);
+				for (int unitIndex = 0; unitIndex < faction->getUnitCount(); ++unitIndex) {
+					faction->getUnit(unitIndex)->clearVisibleCells(false);
+				}
+
+				// If fog of war enabled set cell visible to false and later set those close to units to true
+				if (fogOfWar) {
+					for (int indexSurfaceW = 0; indexSurfaceW < map.getSurfaceW(); ++indexSurfaceW) {
+						for (int indexSurfaceH = 0; indexSurfaceH < map.getSurfaceH(); ++indexSurfaceH) {
+							// set all cells to not visible
+							map.getSurfaceCell(indexSurfaceW, indexSurfaceH)->setVisible(faction->getTeam(), false);
+						}
+					}
+				}
+			}
+			visibleCellCountsReady = true;
+		}
+
 		// Once we have calculated fog of war texture alpha, they are cached so we
 		// restore the default texture in one shot for speed
 		if (fogOfWar && cacheFowAlphaTexture == true) {
@@ -2572,83 +2659,47 @@ namespace Game {
 				continue;
 			}
 			Faction *faction = getFaction(factionIndex);
-			//	for(int indexTeamFaction = 0;
-			//			indexTeamFaction < GameConstants::maxPlayers + GameConstants::specialFactions;
-			//			++indexTeamFaction) {
-
-					// If fog of war enabled set cell visible to false and later set those close to units to true
-			if (fogOfWar) {
-				for (int indexSurfaceW = 0; indexSurfaceW < map.getSurfaceW(); ++indexSurfaceW) {
-					for (int indexSurfaceH = 0; indexSurfaceH < map.getSurfaceH(); ++indexSurfaceH) {
-						// set all cells to not visible
-						map.getSurfaceCell(indexSurfaceW, indexSurfaceH)->setVisible(faction->getTeam(), false);
-					}
-				}
-			}
 
 			// Remove fog of war for factions NOT on my team which i can see
+			bool resetFowAlpha = false;
 			if (!fogOfWar || (faction->getTeam() != thisTeamIndex)) {
 				bool showWorldForFaction = showWorldForPlayer(factionIndex);
 				//printf("showWorldForFaction indexFaction = %d thisTeamIndex = %d showWorldForFaction = %d\n",indexFaction,thisTeamIndex,showWorldForFaction);
 				if (showWorldForFaction == true) {
 					resetFowAlphaFactionCount++;
 				}
-				for (int indexSurfaceW = 0; indexSurfaceW < map.getSurfaceW(); ++indexSurfaceW) {
-					for (int indexSurfaceH = 0; indexSurfaceH < map.getSurfaceH(); ++indexSurfaceH) {
-						// reset fog of ware texture alpha values
-						if (!fogOfWar || (cacheFowAlphaTexture == false &&
-							showWorldForFaction == true &&
-							resetFowAlphaFactionCount <= 1)) {
-							const Vec2i surfPos(indexSurfaceW, indexSurfaceH);
-
-							//compute max alpha
-							float maxAlpha = 0.0f;
-							if (surfPos.x > 1 && surfPos.y > 1 &&
-								surfPos.x < map.getSurfaceW() - 2 &&
-								surfPos.y < map.getSurfaceH() - 2) {
-								maxAlpha = 1.f;
-							} else if (surfPos.x > 0 && surfPos.y > 0 &&
-								surfPos.x < map.getSurfaceW() - 1 &&
-								surfPos.y < map.getSurfaceH() - 1) {
-								maxAlpha = 0.3f;
-							}
-
-							// compute alpha
-							float alpha = maxAlpha;
-							minimap.incFowTextureAlphaSurface(surfPos, alpha);
-						}
-					}
-				}
+				resetFowAlpha = (!fogOfWar || (cacheFowAlphaTexture == false &&
+					showWorldForFaction == true &&
+					resetFowAlphaFactionCount <= 1));
 			}
 			// Remove fog of war for factions on my team
 			else if (fogOfWar && (faction->getTeam() == thisTeamIndex)) {
 				bool showWorldForFaction = showWorldForPlayer(factionIndex);
 				//printf("#2 showWorldForFaction thisFactionIndex = %d thisTeamIndex = %d showWorldForFaction = %d\n",thisFactionIndex,thisTeamIndex,showWorldForFaction);
-				if (showWorldForFaction == true) {
-					for (int indexSurfaceW = 0; indexSurfaceW < map.getSurfaceW(); ++indexSurfaceW) {
-						for (int indexSurfaceH = 0; indexSurfaceH < map.getSurfaceH(); ++indexSurfaceH) {
-							// reset fog of ware texture alpha values
-							if (!fogOfWar || (cacheFowAlphaTexture == false &&
-								showWorldForFaction == true)) {
-								const Vec2i surfPos(indexSurfaceW, indexSurfaceH);
-
-								//compute max alpha
-								float maxAlpha = 0.0f;
-								if (surfPos.x > 1 && surfPos.y > 1 &&
-									surfPos.x < map.getSurfaceW() - 2 &&
-									surfPos.y < map.getSurfaceH() - 2) {
-									maxAlpha = 1.f;
-								} else if (surfPos.x > 0 && surfPos.y > 0 &&
-									surfPos.x < map.getSurfaceW() - 1 &&
-									surfPos.y < map.getSurfaceH() - 1) {
-									maxAlpha = 0.3f;
-								}
-
-								// compute alpha
-								float alpha = maxAlpha;
-								minimap.incFowTextureAlphaSurface(surfPos, alpha);
-							}
+				resetFowAlpha = (showWorldForFaction == true && cacheFowAlphaTexture == false);
+			}
+
+			// reset fog of war texture alpha values
+			if (resetFowAlpha == true) {
+				for (int indexSurfaceW = 0; indexSurfaceW < map.getSurfaceW(); ++indexSurfaceW) {
+					for (int indexSurfaceH = 0; indexSurfaceH < map.getSurfaceH(); ++indexSurfaceH) {
+						const Vec2i surfPos(indexSurfaceW, indexSurfaceH);
+
+						//compute max alpha
+						float maxAlpha = 0.0f;
+						if (surfPos.x > 1 && surfPos.y > 1 &&
+							surfPos.x < map.getSurfaceW() - 2 &&
+							surfPos.y < map.getSurfaceH() - 2) {
+							maxAlpha = 1.f;
+						} else if (surfPos.x > 0 && surfPos.y > 0 &&
+							surfPos.x < map.getSurfaceW() - 1 &&
+							surfPos.y < map.getSurfaceH() - 1) {
+							maxAlpha = 0.3f;
 						}
+
+						// compute alpha
+						float alpha = maxAlpha;
+						minimap.incFowTextureAlphaSurface(surfPos, alpha);
 					}
 				}
 			}
@@ -2671,6 +2722,17 @@ namespace Game {
 		//compute cells
 		if (this->game) chronoGamePerformanceCounts.start();
 
+		// exploration, only units which moved, died or changed their sight
+		// since the last call touch any cells
+		for (int factionIndex = 0; factionIndex < getFactionCount(); ++factionIndex) {
+			Faction *faction = getFaction(factionIndex);
+			int unitCount = faction->getUnitCount();
+			for (int unitIndex = 0; unitIndex < unitCount; ++unitIndex) {
+				faction->getUnit(unitIndex)->exploreCells();
+			}
+		}
+		map.hideUnseenCells(fogOfWar);
+
 		for (int factionIndex = 0; factionIndex < getFactionCount(); ++factionIndex) {
 			Faction *faction = getFaction(factionIndex);
 			bool cellVisibleForFaction = showWorldForPlayer(thisFactionIndex);
@@ -2679,8 +2741,6 @@ namespace Game {
 			int unitCount = faction->getUnitCount();
 			for (int unitIndex = 0; unitIndex < unitCount; ++unitIndex) {
 				Unit *unit = faction->getUnit(unitIndex);
-				// exploration
-				unit->exploreCells();
 
 				// fire particle visible
 				ParticleSystem *fire = unit->getFire();
@@ -150,6 +150,7 @@ namespace Game {
 
 		bool cacheFowAlphaTexture;
 		bool cacheFowAlphaTextureFogOfWarValue;
+		bool visibleCellCountsReady;
 
 		std::map<int, std::map<std::string, Resource > > TeamResources;
 
@@ -412,6 +413,8 @@ namespace Game {
 		void initUnits();
 		void initMap();
 
+		bool beginXmlTreeCache(const vector<string> &pathList, const string &name);
+
 		//misc
 		void tick();
 		void computeFow();
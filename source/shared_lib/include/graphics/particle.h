@@ -21,18 +21,21 @@
 #define _SHARED_GRAPHICS_PARTICLE_H_
 
 #include <list>
+#include <set>
 #include <cassert>
 #include "vec.h"
 #include "pixmap.h"
 #include "texture_manager.h"
 #include "randomgen.h"
 #include "xml_parser.h"
+#include "task_pool.h"
 #include "leak_dumper.h"
 #include "interpolation.h"
 
 using std::list;
 using Shared::Util::RandomGen;
 using Shared::Xml::XmlNode;
+using Shared::PlatformCommon::TaskPool;
 
 namespace Shared {
 	namespace Graphics {
@@ -208,9 +211,16 @@ namespace Shared {
 			virtual ParticleSystemType getParticleSystemType() const = 0;
 
 			//public
-			virtual void update();
+			void update();
 			virtual void render(ParticleRenderer *pr, ModelRenderer *mr);
 
+			//update() in two steps, updateSystem may reach other systems, the
+			//observer and the owner so it runs in order on the calling thread,
+			//it returns false if the particles must wait this frame.
+			//updateParticleStep only touches this system's own particles
+			virtual bool updateSystem();
+			void updateParticleStep();
+
 			//get
 			State getState() const {
 				return state;
@@ -308,11 +318,16 @@ namespace Shared {
 			//protected
 			Particle *createParticle();
 			void killParticle(Particle *p);
+			template<typename T> void updateParticleArray(T *system);
 
 			//virtual protected
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual void updateParticle(Particle *p);
-			virtual bool deathTest(Particle *p);
+			virtual void updateParticles();
+
+			//particle kernels, not virtual, each system calls its own from
+			//updateParticles so there is one virtual call per system a frame
+			void updateParticle(Particle *p);
+			bool deathTest(Particle *p);
 		};
 
 		// =====================================================
@@ -333,7 +348,8 @@ namespace Shared {
 
 			//virtual
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual void updateParticle(Particle *p);
+			virtual void updateParticles();
+			void updateParticle(Particle *p);
 
 			//set params
 			void setRadius(float radius);
@@ -481,8 +497,9 @@ namespace Shared {
 
 			//virtual
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual void updateParticle(Particle *p);
-			virtual void update();
+			virtual void updateParticles();
+			void updateParticle(Particle *p);
+			virtual bool updateSystem();
 			virtual bool getVisible() const;
 			virtual void fade();
 			virtual void render(ParticleRenderer *pr, ModelRenderer *mr);
@@ -608,7 +625,8 @@ namespace Shared {
 			virtual void render(ParticleRenderer *pr, ModelRenderer *mr);
 
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual bool deathTest(Particle *p);
+			virtual void updateParticles();
+			bool deathTest(Particle *p);
 
 			void setRadius(float radius);
 			void setWind(float windAngle, float windSpeed);
@@ -635,7 +653,8 @@ namespace Shared {
 			}
 
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual bool deathTest(Particle *p);
+			virtual void updateParticles();
+			bool deathTest(Particle *p);
 
 			void setRadius(float radius);
 			void setWind(float windAngle, float windSpeed);
@@ -727,9 +746,10 @@ namespace Shared {
 
 			void link(SplashParticleSystem *particleSystem);
 
-			virtual void update();
+			virtual bool updateSystem();
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual void updateParticle(Particle *p);
+			virtual void updateParticles();
+			void updateParticle(Particle *p);
 
 			void setTrajectory(Trajectory trajectory) {
 				this->trajectory = trajectory;
@@ -779,9 +799,10 @@ namespace Shared {
 			SplashParticleSystem(int particleCount = 1000);
 			virtual ~SplashParticleSystem();
 
-			virtual void update();
+			virtual bool updateSystem();
 			virtual void initParticle(Particle *p, int particleIndex);
-			virtual void updateParticle(Particle *p);
+			virtual void updateParticles();
+			void updateParticle(Particle *p);
 
 			virtual void initParticleSystem();
 
@@ -816,10 +837,25 @@ namespace Shared {
 		class ParticleManager {
 		private:
 			vector<ParticleSystem *> particleSystems;
+			//updates the particles of the systems on several threads if set
+			TaskPool *taskPool;
+			//systems being updated, only filled while update() runs
+			vector<ParticleSystem *> shownList;
+			vector<ParticleSystem *> particleStepList;
+			//systems removed while update() runs, taken out of the lists
+			//above in one pass
+			std::set<ParticleSystem *> removedList;
+
+			static bool isParticleSystemShown(const ParticleSystem *ps);
+			void updateParticleSteps(const vector<ParticleSystem *> &updateList);
+			void deleteParticleSystems(const vector<ParticleSystem *> &deleteList);
+			void removeFromUpdateLists(ParticleSystem *ps);
+			void compactUpdateLists();
 
 		public:
 			ParticleManager();
 			~ParticleManager();
+			void setWorkerCount(int workerCount);
 			void update(int renderFps = -1);
 			void render(ParticleRenderer *pr, ModelRenderer *mr) const;
 			void manage(ParticleSystem *ps);
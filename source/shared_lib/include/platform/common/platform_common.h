@@ -52,6 +52,8 @@ using Shared::Util::Checksum;
 namespace Shared {
 	namespace PlatformCommon {
 
+		class TaskPool;
+
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
 #define CODE_AT_LINE __FILE__ ":" TOSTRING(__LINE__)
@@ -220,11 +222,11 @@ namespace Shared {
 
 		std::pair<string, string> getFolderTreeContentsCheckSumListCacheKey(vector<string> paths, const string &pathSearchString, const string &filterFileExt);
 		void clearFolderTreeContentsCheckSumList(vector<string> paths, const string &pathSearchString, const string &filterFileExt);
-		vector<std::pair<string, uint32> > getFolderTreeContentsCheckSumListRecursively(vector<string> paths, const string &pathSearchString, const string &filterFileExt, vector<std::pair<string, uint32> > *recursiveMap);
+		vector<std::pair<string, uint32> > getFolderTreeContentsCheckSumListRecursively(vector<string> paths, const string &pathSearchString, const string &filterFileExt, vector<std::pair<string, uint32> > *recursiveMap, TaskPool *pool = NULL);
 
 		std::pair<string, string> getFolderTreeContentsCheckSumListCacheKey(const string &path, const string &filterFileExt);
 		void clearFolderTreeContentsCheckSumList(const string &path, const string &filterFileExt);
-		vector<std::pair<string, uint32> > getFolderTreeContentsCheckSumListRecursively(const string &path, const string &filterFileExt, vector<std::pair<string, uint32> > *recursiveMap);
+		vector<std::pair<string, uint32> > getFolderTreeContentsCheckSumListRecursively(const string &path, const string &filterFileExt, vector<std::pair<string, uint32> > *recursiveMap, TaskPool *pool = NULL);
 
 		void createDirectoryPaths(string  Path);
 		string extractFileFromDirectoryPath(string filename);
@@ -29,6 +29,7 @@ namespace Shared {
 	const std::string GameBuildDateString = GAME_BUILD_DATE;
 	const std::string G3DViewerVersionString = G3D_VIEWER_VERSION;
 	const std::string MapEditorVersionString = MAP_EDITOR_VERSION;
+	const std::string NetworkProtocolVersionString = NETWORK_PROTOCOL_VERSION;
 } //end namespace
 
 #endif
@@ -0,0 +1,131 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _SHARED_PLATFORMCOMMON_TASKPOOL_H_
+#define _SHARED_PLATFORMCOMMON_TASKPOOL_H_
+
+#include "base_thread.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include "leak_dumper.h"
+
+using namespace std;
+
+namespace Shared {
+	namespace PlatformCommon {
+
+		// =====================================================
+		//	class TaskPoolTask
+		// =====================================================
+		//
+		// This interface describes the methods a pool task must implement,
+		// workerIndex is in [0, TaskPool::getThreadCount()) and is unique
+		// among the tasks running at the same time
+		//
+		class TaskPoolTask {
+		public:
+			virtual void runTask(int workerIndex) = 0;
+
+			virtual ~TaskPoolTask() {
+			}
+		};
+
+		class TaskPool;
+
+		// =====================================================
+		//	class TaskPoolWorker
+		// =====================================================
+
+		class TaskPoolWorker : public BaseThread {
+		protected:
+			TaskPool *pool;
+			int workerIndex;
+			Semaphore semTaskSignalled;
+
+			virtual void setQuitStatus(bool value);
+
+		public:
+			TaskPoolWorker(TaskPool *pool, int workerIndex);
+			virtual ~TaskPoolWorker();
+
+			virtual void execute();
+			virtual bool canShutdown(bool deleteSelfIfShutdownDelayed = false);
+
+			void signalTasks();
+		};
+
+		// =====================================================
+		//	class TaskPool
+		//
+		///	Fixed set of worker threads, each owning a task queue. A
+		///	worker takes tasks from the front of its own queue and when
+		///	it runs dry steals from the back of the others, so uneven
+		///	tasks don't leave threads idle. The thread calling run()
+		///	works as the last worker until every task is done.
+		// =====================================================
+
+		class TaskPool {
+		private:
+			class TaskQueue {
+			public:
+				TaskQueue();
+				~TaskQueue();
+
+				Mutex *mutex;
+				std::deque<TaskPoolTask *> tasks;
+			};
+
+			vector<TaskPoolWorker *> workers;
+			vector<TaskQueue *> queues;
+
+			Mutex *mutexPending;
+			int pendingCount;
+			string pendingError;
+			Semaphore semTasksDone;
+
+			int64 stolenCount;
+
+		public:
+			explicit TaskPool(int workerCount = -1);
+			~TaskPool();
+
+			int getThreadCount() const {
+				return (int) queues.size();
+			}
+			int64 getStolenCount();
+
+			void run(const vector<TaskPoolTask *> &tasks);
+			bool runNextTask(int workerIndex);
+
+			static int getDefaultWorkerCount();
+
+		private:
+			TaskPool(const TaskPool &obj);
+			TaskPool & operator=(const TaskPool &obj);
+
+			TaskPoolTask * popTask(int workerIndex);
+			TaskPoolTask * stealTask(int workerIndex);
+			void taskDone(const string &error);
+		};
+
+	}
+} //end namespace
+
+#endif
@@ -163,12 +163,22 @@ namespace Shared {
 			Mutex *inSocketDestructorSynchAccessor;
 			bool inSocketDestructor;
 
+			// sends queued between beginSendBatch and endSendBatch, the
+			// buffer keeps its capacity from one batch to the next
+			Mutex *sendBatchAccessor;
+			int sendBatchDepth;
+			std::vector<char> sendBatchBuffer;
+
 			bool isSocketBlocking;
 			time_t lastSocketError;
 
 			static string host_name;
 			static std::vector<string> intfTypes;
 
+			static Mutex closedSocketCountAccessor;
+			static uint32 closedSocketCount;
+			static void (*socketClosedCallback)(const Socket *socket);
+
 		public:
 			Socket(PLATFORM_SOCKET sock);
 			Socket();
@@ -201,6 +211,13 @@ namespace Shared {
 			static bool hasDataToReadWithWait(PLATFORM_SOCKET socket, int waitMicroseconds);
 			bool hasDataToReadWithWait(int waitMicroseconds);
 
+			// Changes whenever a socket is closed, so pollers can tell a
+			// reused descriptor from the one they registered
+			static uint32 getClosedSocketCount();
+			// Called from disconnectSocket, also when the socket is deleted,
+			// so state kept per socket elsewhere can be dropped
+			static void setSocketClosedCallback(void (*callback)(const Socket *socket));
+
 			virtual void disconnectSocket();
 
 			PLATFORM_SOCKET getSocketId() const {
@@ -209,6 +226,12 @@ namespace Shared {
 
 			int getDataToRead(bool wantImmediateReply = false);
 			int send(const void *data, int dataSize);
+			// Coalesce everything sent until the matching endSendBatch into
+			// one send, batches may nest. Only the outermost endSendBatch
+			// sends, it returns false if that failed and disconnects the
+			// socket, so senders of nested batches see it as closed.
+			void beginSendBatch();
+			bool endSendBatch();
 			int receive(void *data, int dataSize, bool tryReceiveUntilDataSizeMet);
 			int peek(void *data, int dataSize, bool mustGetData = true, int *pLastSocketError = NULL);
 
@@ -240,6 +263,41 @@ namespace Shared {
 			static void getLocalIPAddressListForPlatform(std::vector<std::string> &ipList);
 		};
 
+		// =====================================================
+		//	class SocketEventPoller
+		//
+		///	Read readiness for a set of sockets that mostly stays the
+		///	same between calls. On Linux the sockets stay registered
+		///	with epoll, so a check costs one call however many sockets
+		///	there are. Elsewhere, or when epoll is unavailable, it falls
+		///	back to Socket::hasDataToRead (select).
+		// =====================================================
+		class SocketEventPoller {
+		private:
+			int epollHandle;
+			std::map<PLATFORM_SOCKET, bool> registeredSockets;
+			uint32 registeredClosedSocketCount;
+
+			void registerSockets(const std::map<PLATFORM_SOCKET, bool> &socketList);
+			void unregisterAll();
+
+		public:
+			SocketEventPoller();
+			~SocketEventPoller();
+
+			bool isUsingEpoll() const {
+				return epollHandle >= 0;
+			}
+
+			// Same contract as Socket::hasDataToRead: every socket in the list
+			// is flagged with whether it is readable
+			bool hasDataToRead(std::map<PLATFORM_SOCKET, bool> &socketTriggeredList, int waitMilliseconds = 0);
+
+		private:
+			SocketEventPoller(const SocketEventPoller &obj);
+			SocketEventPoller & operator=(const SocketEventPoller &obj);
+		};
+
 		class SafeSocketBlockToggleWrapper {
 		protected:
 			Socket *socket;
@@ -37,6 +37,8 @@ const char  *GAME_ARGS[] = {
 	"--autostart-lastgame",
 	"--load-saved-game",
 	"--auto-test",
+	"--benchmark",
+	"--replay-seek",
 	"--connect",
 	"--connecthost",
 	"--starthost",
@@ -121,6 +123,8 @@ enum GAME_ARG_TYPE {
 	GAME_ARG_AUTOSTART_LASTGAME,
 	GAME_ARG_AUTOSTART_LAST_SAVED_GAME,
 	GAME_ARG_AUTO_TEST,
+	GAME_ARG_BENCHMARK,
+	GAME_ARG_REPLAY_SEEK,
 	GAME_ARG_CONNECT,
 	GAME_ARG_CLIENT,
 	GAME_ARG_SERVER,
@@ -245,6 +249,26 @@ GAME_ARGS[GAME_ARG_AUTOSTART_LAST_SAVED_GAME]);
           (or is empty) then auto test continues to cycle.",
 GAME_ARGS[GAME_ARG_AUTO_TEST]);
 
+	printf("\n\n\
+  %s=x,y,z\n\
+    Run a headless benchmark of the game simulation.\n\
+      x - the # of world frames to simulate at maximum speed.\n\
+      y - the game settings file to play (for example lastGameSettings.mgg).\n\
+      z - optional file to write the per frame performance counts and\n\
+          the final faction CRC's to, as json if it ends with .json and\n\
+          as csv otherwise.",
+GAME_ARGS[GAME_ARG_BENCHMARK]);
+
+	printf("\n\n\
+  %s=x\n\
+    When a saved game is loaded with its replay, resume the replay at\n\
+    x seconds of game time instead of at the saved point. The game jumps\n\
+    to the nearest earlier replay keyframe, simulates up to x without\n\
+    rendering and then plays the rest of the recorded commands at game\n\
+    speed. Use together with %s.",
+GAME_ARGS[GAME_ARG_REPLAY_SEEK],
+GAME_ARGS[GAME_ARG_AUTOSTART_LAST_SAVED_GAME]);
+
 	printf("\n\n\
   %s=x:y\n\
     Auto connect to host server at IP or hostname x using port y.\n\
@@ -711,6 +735,7 @@ int mainSetup(int argc, char **argv) {
 		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_VERSION])) == true ||
 		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_SHOW_INI_SETTINGS])) == true ||
 		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_MASTERSERVER_MODE])) == true ||
+		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_BENCHMARK])) == true ||
 		hasCommandArgument(argc, argv, string(GAME_ARGS[GAME_ARG_MASTERSERVER_STATUS]))) {
 		// Use this for masterserver mode for timers like Chrono
 		if (SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
@@ -22,6 +22,8 @@
 
 #include <string>
 #include <map>
+#include <vector>
+#include <cstring>
 #include "data_types.h"
 #include "thread.h"
 #include "leak_dumper.h"
@@ -30,13 +32,21 @@ using std::string;
 using namespace Shared::Platform;
 
 namespace Shared {
+	namespace PlatformCommon {
+		class TaskPool;
+	}
+
 	namespace Util {
 
+		class FileChecksumTask;
+
 		// =====================================================
 		//	class Checksum
 		// =====================================================
 
 		class Checksum {
+			friend class FileChecksumTask;
+
 		private:
 			uint32	sum;
 			int32	r;
@@ -66,10 +76,79 @@ namespace Shared {
 			uint32 addInt64(const int64 &value);
 			void addFile(const string &path);
 
+			static void addFilesToCache(const std::vector<string> &paths, Shared::PlatformCommon::TaskPool *pool = NULL);
 			static void removeFileFromCache(const string file);
 			static void clearFileCache();
 		};
 
+		// =====================================================
+		//	class Checksum64
+		//
+		///	Fast 64 bit hash of game state that is rehashed every
+		///	frame. It consumes whole words instead of single bytes,
+		///	with the xxHash64 round and avalanche constants.
+		// =====================================================
+
+		class Checksum64 {
+		private:
+			static const uint64 prime1 = 11400714785074694791ULL;
+			static const uint64 prime2 = 14029467366897019727ULL;
+			static const uint64 prime3 = 1609587929392839161ULL;
+			static const uint64 prime4 = 9650029242287828579ULL;
+			static const uint64 prime5 = 2870177450012600261ULL;
+
+			uint64 sum;
+
+			static uint64 rotateLeft(uint64 value, int bits) {
+				return (value << bits) | (value >> (64 - bits));
+			}
+
+		public:
+			Checksum64() {
+				sum = prime5;
+			}
+
+			void addUInt64(uint64 value) {
+				uint64 round = rotateLeft(value * prime2, 31) * prime1;
+				sum = rotateLeft(sum ^ round, 27) * prime1 + prime4;
+			}
+			void addInt64(int64 value) {
+				addUInt64((uint64) value);
+			}
+			void addInt(int32 value) {
+				addUInt64((uint64) (uint32) value);
+			}
+			void addString(const string &value) {
+				addUInt64(value.size());
+				size_t index = 0;
+				for (; index + sizeof(uint64) <= value.size(); index += sizeof(uint64)) {
+					uint64 word = 0;
+					memcpy(&word, value.data() + index, sizeof(word));
+					addUInt64(word);
+				}
+				if (index < value.size()) {
+					uint64 word = 0;
+					memcpy(&word, value.data() + index, value.size() - index);
+					addUInt64(word);
+				}
+			}
+
+			uint64 getSum() const {
+				uint64 result = sum;
+				result ^= result >> 33;
+				result *= prime2;
+				result ^= result >> 29;
+				result *= prime3;
+				result ^= result >> 32;
+				return result;
+			}
+
+			// For the places that carry a 32 bit checksum
+			static uint32 fold(uint64 value) {
+				return (uint32) (value ^ (value >> 32));
+			}
+		};
+
 	}
 } //end namespace
 
@@ -59,6 +59,9 @@ namespace Shared {
 			}
 
 			std::string getLastCaller() const;
+			const std::vector<std::string> & getLastCallerList() const {
+				return lastCaller;
+			}
 			void clearLastCaller();
 			void addLastCaller(std::string text);
 			void setDisableLastCallerTracking(bool value) {
@@ -3,3 +3,5 @@
 #define GAME_BUILD_DATE "0406"
 #define G3D_VIEWER_VERSION "1.0"
 #define MAP_EDITOR_VERSION "1.0"
+//Bump whenever network messages or synch checksums change
+#define NETWORK_PROTOCOL_VERSION "3"
@@ -0,0 +1,66 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _SHARED_XML_XMLBINARY_H_
+#define _SHARED_XML_XMLBINARY_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include "xml_parser.h"
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Platform;
+
+namespace Shared {
+	namespace Xml {
+
+		// =====================================================
+		//	class XmlIoBinary
+		//
+		///	Writes an XmlNode tree as a versioned binary stream, where
+		///	every tag and attribute name is stored once in a dictionary
+		///	and the whole stream is optionally compressed. Such files are
+		///	recognized by XmlIoRapid::load and XmlIo::load, so XmlTree
+		///	loads either kind with both engines.
+		// =====================================================
+
+		class XmlIoBinary {
+		private:
+			typedef std::map<const string *, uint32> NameIndex;
+
+			static void writeNode(const XmlNode *node, NameIndex &names, vector<const string *> &nameList, string &out);
+			static XmlNode * readNode(const vector<string> &nameList, const char *data, uint32 &offset, uint32 end,
+				const std::map<string, string> &mapTagReplacementValues, bool skipUpdatePathClimbingParts);
+
+		public:
+			static bool isBinaryData(const char *data, int64 size);
+
+			static XmlNode * load(const char *data, int64 size, const std::map<string, string> &mapTagReplacementValues, bool skipUpdatePathClimbingParts = false);
+			static XmlNode * loadFile(const string &path, const std::map<string, string> &mapTagReplacementValues, bool skipUpdatePathClimbingParts = false);
+			static string saveToMemory(const XmlNode *node, int compressionLevel = 5);
+			static void save(const string &path, const XmlNode *node, int compressionLevel = 5);
+		};
+
+	}
+} //end namespace
+
+#endif
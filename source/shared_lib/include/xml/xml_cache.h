@@ -0,0 +1,82 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#ifndef _SHARED_XML_XMLCACHE_H_
+#define _SHARED_XML_XMLCACHE_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include "xml_parser.h"
+#include "thread.h"
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Platform;
+
+namespace Shared {
+	namespace Xml {
+
+		// =====================================================
+		//	class XmlTreeCache
+		//
+		///	Binary copy of every xml file parsed below a set of folders
+		///	(a techtree or a tileset), stored in the CRC cache folder. The
+		///	trees are kept before tag replacement so the same file serves
+		///	any replacement values. A cache whose CRC no longer matches the
+		///	folder contents is ignored and written again from the xml.
+		// =====================================================
+
+		class XmlTreeCache {
+		private:
+			static Mutex mutex;
+
+			static bool active;
+			static bool recording;
+			static string cacheFile;
+			static uint32 contentCRC;
+			static vector<string> folderList;
+
+			// offset and size of each tree in the loaded cache file
+			static vector<char> buffer;
+			static std::map<string, pair<uint32, uint32> > treeIndex;
+			// encoded trees parsed while no valid cache file existed
+			static std::map<string, string> recordedTrees;
+
+			static bool readCacheFile();
+			static bool isCachedPath(const string &path);
+
+			static void writeNode(const xml_node<> *node, string &out);
+			static XmlNode * readNode(uint32 &offset, uint32 end, const std::map<string, string> &mapTagReplacementValues, bool skipUpdatePathClimbingParts);
+
+		public:
+			static string getCacheFileName(const vector<string> &folders);
+
+			static void begin(const vector<string> &folders, uint32 crc);
+			static void end(bool save);
+
+			static XmlNode * loadTree(const string &path, const std::map<string, string> &mapTagReplacementValues, bool skipUpdatePathClimbingParts);
+			static void recordTree(const string &path, const xml_node<> *rootNode);
+		};
+
+	}
+} //end namespace
+
+#endif
@@ -73,6 +73,8 @@ namespace Shared {
 		class XmlTree;
 		class XmlNode;
 		class XmlAttribute;
+		class XmlTreeCache;
+		class XmlIoBinary;
 
 #if defined(WANT_XERCES)
 		// =====================================================
@@ -161,6 +163,7 @@ namespace Shared {
 			void init(const string &name);
 			void load(const string &path, const std::map<string, string> &mapTagReplacementValues, bool noValidation = false, bool skipStackCheck = false, bool skipStackTrace = false);
 			void save(const string &path);
+			void saveBinary(const string &path, int compressionLevel = 5);
 
 			XmlNode *getRootNode() const {
 				return rootNode;
@@ -173,12 +176,15 @@ namespace Shared {
 
 		class XmlNode {
 		private:
-			string name;
+			const string *name;
 			string text;
 			vector<XmlNode*> children;
 			vector<XmlAttribute*> attributes;
 			mutable const XmlNode* superNode;
 
+			friend class XmlTreeCache;
+			friend class XmlIoBinary;
+
 		private:
 			XmlNode(XmlNode&);
 			void operator =(XmlNode&);
@@ -204,7 +210,7 @@ namespace Shared {
 			}
 
 			const string &getName() const {
-				return name;
+				return *name;
 			}
 			size_t getChildCount() const {
 				return children.size();
@@ -242,10 +248,11 @@ namespace Shared {
 		class XmlAttribute {
 		private:
 			string value;
-			string name;
+			const string *name;
 			bool skipRestrictionCheck;
 			bool usesCommondata;
-			std::map<string, string> mapTagReplacementValues;
+
+			friend class XmlIoBinary;
 
 		private:
 			XmlAttribute(XmlAttribute&);
@@ -263,8 +270,8 @@ namespace Shared {
 			XmlAttribute(const string &name, const string &value, const std::map<string, string> &mapTagReplacementValues);
 
 		public:
-			const string getName() const {
-				return name;
+			const string &getName() const {
+				return *name;
 			}
 			const string getValue(string prefixValue = "", bool trimValueWithStartingSlash = false) const;
 
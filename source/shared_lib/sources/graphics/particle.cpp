@@ -205,28 +205,25 @@ namespace Shared {
 
 		// =============== VIRTUAL ======================
 
-		//updates all living particles and creates new ones
 		void ParticleSystem::update() {
+			if (updateSystem() == true) {
+				updateParticleStep();
+			}
+		}
+
+		bool ParticleSystem::updateSystem() {
+			return true;
+		}
+
+		//updates all living particles and creates new ones
+		void ParticleSystem::updateParticleStep() {
 			if (aliveParticleCount > (int) particles.size()) {
 				throw game_runtime_error("aliveParticleCount >= particles.size()");
 			}
 			if (particleSystemStartDelay > 0) {
 				particleSystemStartDelay--;
 			} else if (state != sPause) {
-				for (int i = 0; i < aliveParticleCount; ++i) {
-					updateParticle(&particles[i]);
-
-					if (deathTest(&particles[i])) {
-
-						//kill the particle
-						killParticle(&particles[i]);
-
-						//maintain alive particles at front of the array
-						if (aliveParticleCount > 0) {
-							particles[i] = particles[aliveParticleCount];
-						}
-					}
-				}
+				updateParticles();
 
 				if (state != ParticleSystem::sFade) {
 					emissionState = emissionState + emissionRate;
@@ -620,6 +617,33 @@ namespace Shared {
 			p->energy = maxParticleEnergy + random.randRange(-varParticleEnergy, varParticleEnergy);
 		}
 
+		// runs the kernels of system type T over the living particles, a dead
+		// particle is swapped with the last living one which is then updated
+		// in its place so the alive particles stay at the front of the array.
+		// Particles stay an array of structs: split into per field arrays the
+		// fire, unit, projectile and splash kernels ran 5-25% slower, most of
+		// their time is truncateDecimal which does not vectorize, and only the
+		// plain integrator used by rain and snow got faster, at -O3 only, for
+		// the one weather system a game has
+		template<typename T>
+		void ParticleSystem::updateParticleArray(T *system) {
+			for (int i = 0; i < aliveParticleCount;) {
+				Particle *p = &particles[i];
+				system->updateParticle(p);
+
+				if (system->deathTest(p)) {
+					killParticle(p);
+					*p = particles[aliveParticleCount];
+				} else {
+					++i;
+				}
+			}
+		}
+
+		void ParticleSystem::updateParticles() {
+			updateParticleArray(this);
+		}
+
 		void ParticleSystem::updateParticle(Particle *p) {
 			p->lastPos = p->pos;
 			p->pos = p->pos + p->speed;
@@ -702,6 +726,10 @@ namespace Shared {
 
 		}
 
+		void FireParticleSystem::updateParticles() {
+			updateParticleArray(this);
+		}
+
 		void FireParticleSystem::updateParticle(Particle *p) {
 			p->lastPos = p->pos;
 			p->pos = p->pos + p->speed;
@@ -1232,10 +1260,10 @@ namespace Shared {
 			p->speedUpConstant = Vec3f(speedUpConstant)*p->speed;
 		}
 
-		void UnitParticleSystem::update() {
+		bool UnitParticleSystem::updateSystem() {
 			// delay and timeline are only applicable for child particles
 			if (parent && delay > 0 && delay--) {
-				return;
+				return false;
 			}
 			if (parent && lifetime > 0 && !--lifetime) {
 				fade();
@@ -1256,7 +1284,11 @@ namespace Shared {
 
 				oldPosition = pos;
 			}
-			ParticleSystem::update();
+			return true;
+		}
+
+		void UnitParticleSystem::updateParticles() {
+			updateParticleArray(this);
 		}
 
 		void UnitParticleSystem::updateParticle(Particle *p) {
@@ -1578,6 +1610,10 @@ namespace Shared {
 			p->speed.z = truncateDecimal<float>(p->speed.z, 6);
 		}
 
+		void RainParticleSystem::updateParticles() {
+			updateParticleArray(this);
+		}
+
 		bool RainParticleSystem::deathTest(Particle *p) {
 			return p->pos.y < 0;
 		}
@@ -1657,6 +1693,10 @@ namespace Shared {
 			p->speed.z = truncateDecimal<float>(p->speed.z, 6);
 		}
 
+		void SnowParticleSystem::updateParticles() {
+			updateParticleArray(this);
+		}
+
 		bool SnowParticleSystem::deathTest(Particle *p) {
 			return p->pos.y < 0;
 		}
@@ -1786,7 +1826,7 @@ namespace Shared {
 			nextParticleSystem->prevParticleSystem = this;
 		}
 
-		void ProjectileParticleSystem::update() {
+		bool ProjectileParticleSystem::updateSystem() {
 			//printf("Projectile particle system updating...\n");
 			if (state == sPlay) {
 
@@ -1897,8 +1937,7 @@ namespace Shared {
 					}
 				}
 			}
-
-			ParticleSystem::update();
+			return true;
 		}
 
 		void ProjectileParticleSystem::rotateChildren() {
@@ -1940,6 +1979,10 @@ namespace Shared {
 			updateParticle(p);
 		}
 
+		void ProjectileParticleSystem::updateParticles() {
+			updateParticleArray(this);
+		}
+
 		void ProjectileParticleSystem::updateParticle(Particle *p) {
 			float energyRatio = clamp(static_cast<float> (p->energy) / maxParticleEnergy, 0.f, 1.f);
 			energyRatio = truncateDecimal<float>(energyRatio, 6);
@@ -2200,8 +2243,7 @@ namespace Shared {
 			startEmissionRate = emissionRate;
 		}
 
-		void SplashParticleSystem::update() {
-			ParticleSystem::update();
+		bool SplashParticleSystem::updateSystem() {
 			if (state != sPause) {
 				emissionRate -= emissionRateFade;
 				emissionRate = truncateDecimal<float>(emissionRate, 6);
@@ -2222,6 +2264,7 @@ namespace Shared {
 					fade();
 				}
 			}
+			return true;
 		}
 
 		void SplashParticleSystem::initParticle(Particle *p, int particleIndex) {
@@ -2257,6 +2300,10 @@ namespace Shared {
 			p->speedUpConstant = Vec3f(speedUpConstant)*p->speed;
 		}
 
+		void SplashParticleSystem::updateParticles() {
+			updateParticleArray(this);
+		}
+
 		void SplashParticleSystem::updateParticle(Particle *p) {
 			float energyRatio = clamp(static_cast<float> (p->energy) / maxParticleEnergy, 0.f, 1.f);
 
@@ -2364,11 +2411,51 @@ namespace Shared {
 		//  ParticleManager
 		// ===========================================================================
 
+		// =====================================================
+		//	class ParticleStepTask
+		// =====================================================
+
+		// a run of systems whose particles one worker updates
+		class ParticleStepTask : public TaskPoolTask {
+		public:
+			ParticleStepTask(const vector<ParticleSystem *> *updateList, int first, int last) {
+				this->updateList = updateList;
+				this->first = first;
+				this->last = last;
+			}
+			virtual void runTask(int workerIndex) {
+				for (int i = first; i < last; ++i) {
+					(*updateList)[i]->updateParticleStep();
+				}
+			}
+
+			const vector<ParticleSystem *> *updateList;
+			int first;
+			int last;
+		};
+
+		// below this many particles a frame the threads cost more than they save
+		static const int minThreadedParticleCount = 2048;
+		static const int minParticleBatchSize = 256;
+		static const int particleBatchesPerThread = 4;
+
 		ParticleManager::ParticleManager() {
+			taskPool = NULL;
 		}
 
 		ParticleManager::~ParticleManager() {
 			end();
+			delete taskPool;
+			taskPool = NULL;
+		}
+
+		// -1 uses a thread per core, 0 updates the particles on the caller only
+		void ParticleManager::setWorkerCount(int workerCount) {
+			delete taskPool;
+			taskPool = NULL;
+			if (workerCount != 0) {
+				taskPool = new TaskPool(workerCount);
+			}
 		}
 
 		void ParticleManager::render(ParticleRenderer *pr, ModelRenderer *mr) const {
@@ -2392,12 +2479,7 @@ namespace Shared {
 				if (ps != NULL) {
 					//currentParticleCount+= ps->getAliveParticleCount();
 
-					bool showParticle = true;
-					if (dynamic_cast<UnitParticleSystem *> (ps) != NULL ||
-						dynamic_cast<FireParticleSystem *> (ps) != NULL) {
-						showParticle = ps->getVisible() || (ps->getState() == ParticleSystem::sFade);
-					}
-					if (showParticle == true) {
+					if (isParticleSystemShown(ps) == true) {
 						//printf("Looking for [%d] current id [%d] i = %d\n",type,ps->getParticleSystemType(),i);
 
 						if (type == ParticleSystem::pst_All || type == ps->getParticleSystemType()) {
@@ -2412,6 +2494,17 @@ namespace Shared {
 			return result;
 		}
 
+		// unit and fire systems are skipped while hidden unless they fade out
+		bool ParticleManager::isParticleSystemShown(const ParticleSystem *ps) {
+			switch (ps->getParticleSystemType()) {
+				case ParticleSystem::pst_UnitParticleSystem:
+				case ParticleSystem::pst_FireParticleSystem:
+					return ps->getVisible() || (ps->getState() == ParticleSystem::sFade);
+				default:
+					return true;
+			}
+		}
+
 		void ParticleManager::update(int renderFps) {
 			Chrono chrono;
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) chrono.start();
@@ -2419,32 +2512,144 @@ namespace Shared {
 			size_t particleSystemCount = particleSystems.size();
 			int currentParticleCount = 0;
 
-			vector<ParticleSystem *> cleanupParticleSystemsList;
+			// The systems themselves go in order on this thread, a projectile
+			// moves its children and calls its observer which hits units. The
+			// observer and owners may add or remove systems meanwhile, removal
+			// marks them and they are taken out of the update lists after the
+			// loop. A removed system is no longer in particleSystems, so seeing
+			// a marked one here means a new system got its address and the
+			// lists are cleaned up before it goes in.
+			shownList.clear();
+			particleStepList.clear();
+			removedList.clear();
 			for (unsigned int i = 0; i < particleSystems.size(); i++) {
 				ParticleSystem *ps = particleSystems[i];
 				if (ps != NULL) {
 					currentParticleCount += ps->getAliveParticleCount();
 
-					bool showParticle = true;
-					if (dynamic_cast<UnitParticleSystem *> (ps) != NULL ||
-						dynamic_cast<FireParticleSystem *> (ps) != NULL) {
-						showParticle = ps->getVisible() || (ps->getState() == ParticleSystem::sFade);
+					if (removedList.empty() == false && removedList.find(ps) != removedList.end()) {
+						compactUpdateLists();
 					}
-					if (showParticle == true) {
-						ps->update();
-						if (ps->isEmpty() && ps->getState() == ParticleSystem::sFade) {
-							cleanupParticleSystemsList.push_back(ps);
+					if (isParticleSystemShown(ps) == true) {
+						shownList.push_back(ps);
+						if (ps->updateSystem() == true) {
+							particleStepList.push_back(ps);
 						}
 					}
 				}
 			}
-			//particleSystems.remove(NULL);
-			cleanupParticleSystems(cleanupParticleSystemsList);
+
+			compactUpdateLists();
+			updateParticleSteps(particleStepList);
+
+			vector<ParticleSystem *> cleanupParticleSystemsList;
+			for (unsigned int i = 0; i < shownList.size(); i++) {
+				ParticleSystem *ps = shownList[i];
+				if (ps->isEmpty() && ps->getState() == ParticleSystem::sFade) {
+					cleanupParticleSystemsList.push_back(ps);
+				}
+			}
+			shownList.clear();
+			particleStepList.clear();
+			deleteParticleSystems(cleanupParticleSystemsList);
 
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0)
 				SystemFlags::OutputDebug(SystemFlags::debugPerformance, "In [%s::%s] Line: %d took msecs: %lld, particleSystemCount = %d, currentParticleCount = %d\n", __FILE__, __FUNCTION__, __LINE__, chrono.getMillis(), particleSystemCount, currentParticleCount);
 		}
 
+		// Each task gets a run of systems with about the same number of
+		// particles. A system is never split, its particles and its random
+		// numbers have to go in order.
+		void ParticleManager::updateParticleSteps(const vector<ParticleSystem *> &updateList) {
+			int particleCount = 0;
+			for (unsigned int i = 0; i < updateList.size(); i++) {
+				particleCount += updateList[i]->getAliveParticleCount() + 1;
+			}
+
+			if (taskPool == NULL || particleCount < minThreadedParticleCount) {
+				for (unsigned int i = 0; i < updateList.size(); i++) {
+					updateList[i]->updateParticleStep();
+				}
+				return;
+			}
+
+			int batchSize = max(particleCount / (taskPool->getThreadCount() * particleBatchesPerThread), minParticleBatchSize);
+			vector<ParticleStepTask> tasks;
+			int first = 0;
+			int batchCount = 0;
+			for (int i = 0; i < (int) updateList.size(); i++) {
+				batchCount += updateList[i]->getAliveParticleCount() + 1;
+				if (batchCount >= batchSize || i == (int) updateList.size() - 1) {
+					tasks.push_back(ParticleStepTask(&updateList, first, i + 1));
+					first = i + 1;
+					batchCount = 0;
+				}
+			}
+
+			vector<TaskPoolTask *> taskList;
+			taskList.reserve(tasks.size());
+			for (unsigned int i = 0; i < tasks.size(); ++i) {
+				taskList.push_back(&tasks[i]);
+			}
+			taskPool->run(taskList);
+		}
+
+		// The list is in the same order as particleSystems, so they are taken
+		// out in one pass instead of a search and an erase for each.
+		void ParticleManager::deleteParticleSystems(const vector<ParticleSystem *> &deleteList) {
+			if (deleteList.empty() == true) {
+				return;
+			}
+
+			unsigned int deleteIndex = 0;
+			unsigned int keepCount = 0;
+			for (unsigned int i = 0; i < particleSystems.size(); i++) {
+				ParticleSystem *ps = particleSystems[i];
+				if (deleteIndex < deleteList.size() && ps == deleteList[deleteIndex]) {
+					deleteIndex++;
+				} else {
+					particleSystems[keepCount++] = ps;
+				}
+			}
+			particleSystems.resize(keepCount);
+
+			for (int i = (int) deleteList.size() - 1; i >= 0; i--) {
+				ParticleSystem *ps = deleteList[i];
+				ps->callParticleOwnerEnd(ps);
+				delete ps;
+			}
+		}
+
+		// outside update() the lists are empty and there is nothing to mark
+		void ParticleManager::removeFromUpdateLists(ParticleSystem *ps) {
+			if (shownList.empty() == false) {
+				removedList.insert(ps);
+			}
+		}
+
+		void ParticleManager::compactUpdateLists() {
+			if (removedList.empty() == true) {
+				return;
+			}
+
+			unsigned int keepCount = 0;
+			for (unsigned int i = 0; i < shownList.size(); i++) {
+				if (removedList.find(shownList[i]) == removedList.end()) {
+					shownList[keepCount++] = shownList[i];
+				}
+			}
+			shownList.resize(keepCount);
+
+			keepCount = 0;
+			for (unsigned int i = 0; i < particleStepList.size(); i++) {
+				if (removedList.find(particleStepList[i]) == removedList.end()) {
+					particleStepList[keepCount++] = particleStepList[i];
+				}
+			}
+			particleStepList.resize(keepCount);
+			removedList.clear();
+		}
+
 		bool ParticleManager::validateParticleSystemStillExists(ParticleSystem * particleSystem) const {
 			int index = findParticleSystems(particleSystem, this->particleSystems);
 			return (index >= 0);
@@ -2498,6 +2703,7 @@ namespace Shared {
 					ps->callParticleOwnerEnd(ps);
 				}
 
+				removeFromUpdateLists(ps);
 				delete ps;
 				this->particleSystems.erase(this->particleSystems.begin() + index);
 			}
@@ -2546,6 +2752,7 @@ namespace Shared {
 				if (ps != NULL) {
 					ps->callParticleOwnerEnd(ps);
 				}
+				removeFromUpdateLists(ps);
 				delete ps;
 				particleSystems.pop_back();
 			}
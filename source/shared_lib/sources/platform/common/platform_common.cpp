@@ -82,6 +82,7 @@
 #include "utf8.h"
 #include "byte_order.h"
 #include "shared_const.h"
+#include "task_pool.h"
 
 #if _BSD_SOURCE || _SVID_SOURCE || _XOPEN_SOURCE >= 500 || _XOPEN_SOURCE && _XOPEN_SOURCE_EXTENDED
 #include <unistd.h>
@@ -1192,7 +1193,7 @@ namespace Shared {
 			}
 		}
 
-		vector<std::pair<string, uint32> > getFolderTreeContentsCheckSumListRecursively(vector<string> paths, const string &pathSearchString, const string &filterFileExt, vector<std::pair<string, uint32> > *recursiveMap) {
+		vector<std::pair<string, uint32> > getFolderTreeContentsCheckSumListRecursively(vector<string> paths, const string &pathSearchString, const string &filterFileExt, vector<std::pair<string, uint32> > *recursiveMap, TaskPool *pool) {
 			std::pair<string, string> cacheKeys = getFolderTreeContentsCheckSumListCacheKey(paths, pathSearchString, filterFileExt);
 			string cacheLookupId = cacheKeys.first;
 			std::map<string, vector<std::pair<string, uint32> > > &crcTreeCache = CacheManager::getCachedItem< std::map<string, vector<std::pair<string, uint32> > > >(cacheLookupId);
@@ -1205,12 +1206,18 @@ namespace Shared {
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] scanning folders, NO CACHE found result for cacheKey [%s]\n", __FILE__, __FUNCTION__, __LINE__, cacheKey.c_str());
 			}
 
+			// one pool sums the files of every folder in the list
+			if (pool == NULL) {
+				TaskPool folderPool;
+				return getFolderTreeContentsCheckSumListRecursively(paths, pathSearchString, filterFileExt, recursiveMap, &folderPool);
+			}
+
 			bool topLevelCaller = (recursiveMap == NULL);
 
 			vector<std::pair<string, uint32> > checksumFiles = (recursiveMap == NULL ? vector<std::pair<string, uint32> >() : *recursiveMap);
 			for (unsigned int idx = 0; idx < paths.size(); ++idx) {
 				string path = paths[idx] + pathSearchString;
-				checksumFiles = getFolderTreeContentsCheckSumListRecursively(path, filterFileExt, &checksumFiles);
+				checksumFiles = getFolderTreeContentsCheckSumListRecursively(path, filterFileExt, &checksumFiles, pool);
 			}
 
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] checksumFiles.size() = %d\n", __FILE__, __FUNCTION__, __LINE__, checksumFiles.size());
@@ -1362,7 +1369,7 @@ namespace Shared {
 		}
 
 		//finds all filenames like path and gets the checksum of each file
-		vector<std::pair<string, uint32> > getFolderTreeContentsCheckSumListRecursively(const string &path, const string &filterFileExt, vector<std::pair<string, uint32> > *recursiveMap) {
+		vector<std::pair<string, uint32> > getFolderTreeContentsCheckSumListRecursively(const string &path, const string &filterFileExt, vector<std::pair<string, uint32> > *recursiveMap, TaskPool *pool) {
 			std::pair<string, string> cacheKeys = getFolderTreeContentsCheckSumListCacheKey(path, filterFileExt);
 			string cacheLookupId = cacheKeys.first;
 			std::map<string, vector<std::pair<string, uint32> > > &crcTreeCache = CacheManager::getCachedItem< std::map<string, vector<std::pair<string, uint32> > > >(cacheLookupId);
@@ -1373,6 +1380,12 @@ namespace Shared {
 				return crcTreeCache[cacheKey];
 			}
 
+			// one pool sums the files of every folder in the tree
+			if (pool == NULL) {
+				TaskPool folderPool;
+				return getFolderTreeContentsCheckSumListRecursively(path, filterFileExt, recursiveMap, &folderPool);
+			}
+
 			bool topLevelCaller = (recursiveMap == NULL);
 			vector<std::pair<string, uint32> > checksumFiles = (recursiveMap == NULL ? vector<std::pair<string, uint32> >() : *recursiveMap);
 
@@ -1397,6 +1410,7 @@ namespace Shared {
 			}
 #endif
 
+			vector<string> folderFiles;
 			for (int i = 0; i < (int) globbuf.gl_pathc; ++i) {
 				const char* p = globbuf.gl_pathv[i];
 
@@ -1409,16 +1423,22 @@ namespace Shared {
 					}
 
 					if (addFile) {
-						Checksum checksum;
-						checksum.addFile(p);
-
-						checksumFiles.push_back(std::pair<string, uint32>(p, checksum.getSum()));
+						folderFiles.push_back(p);
 					}
 				}
 			}
 
 			globfree(&globbuf);
 
+			// sum this folder's files concurrently, then list them in glob order
+			Checksum::addFilesToCache(folderFiles, pool);
+			for (unsigned int i = 0; i < folderFiles.size(); ++i) {
+				Checksum checksum;
+				checksum.addFile(folderFiles[i]);
+
+				checksumFiles.push_back(std::pair<string, uint32>(folderFiles[i], checksum.getSum()));
+			}
+
 			// Look recursively for sub-folders
 #if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
 			res = glob(mypath.c_str(), 0, 0, &globbuf);
@@ -1447,7 +1467,7 @@ namespace Shared {
 				string currentPath = p;
 				endPathWithSlash(currentPath);
 
-				checksumFiles = getFolderTreeContentsCheckSumListRecursively(currentPath + "*", filterFileExt, &checksumFiles);
+				checksumFiles = getFolderTreeContentsCheckSumListRecursively(currentPath + "*", filterFileExt, &checksumFiles, pool);
 			}
 
 			globfree(&globbuf);
@@ -0,0 +1,257 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#include "task_pool.h"
+#include <SDL_cpuinfo.h>
+#include <algorithm>
+#include "util.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "conversion.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Util;
+
+namespace Shared {
+	namespace PlatformCommon {
+
+		// =====================================================
+		//	class TaskPoolWorker
+		// =====================================================
+
+		TaskPoolWorker::TaskPoolWorker(TaskPool *pool, int workerIndex) : BaseThread() {
+			uniqueID = "TaskPoolWorker";
+			this->pool = pool;
+			this->workerIndex = workerIndex;
+		}
+
+		TaskPoolWorker::~TaskPoolWorker() {
+			this->pool = NULL;
+		}
+
+		void TaskPoolWorker::setQuitStatus(bool value) {
+			BaseThread::setQuitStatus(value);
+			if (value == true) {
+				semTaskSignalled.signal();
+			}
+		}
+
+		void TaskPoolWorker::signalTasks() {
+			semTaskSignalled.signal();
+		}
+
+		bool TaskPoolWorker::canShutdown(bool deleteSelfIfShutdownDelayed) {
+			bool ret = (getExecutingTask() == false);
+			if (ret == false && deleteSelfIfShutdownDelayed == true) {
+				setDeleteSelfOnExecutionDone(deleteSelfIfShutdownDelayed);
+				deleteSelfIfRequired();
+				signalQuit();
+			}
+			return ret;
+		}
+
+		void TaskPoolWorker::execute() {
+			RunningStatusSafeWrapper runningStatus(this);
+			try {
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] worker %d\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, workerIndex);
+
+				for (; this->pool != NULL;) {
+					semTaskSignalled.waitTillSignalled();
+					if (getQuitStatus() == true) {
+						break;
+					}
+
+					ExecutingTaskSafeWrapper safeExecutingTaskMutex(this);
+					for (; pool->runNextTask(workerIndex) == true;) {
+					}
+				}
+
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] worker %d END\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, workerIndex);
+			} catch (const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, ex.what());
+				throw game_runtime_error(ex.what());
+			}
+		}
+
+		// =====================================================
+		//	class TaskPool
+		// =====================================================
+
+		TaskPool::TaskQueue::TaskQueue() : mutex(new Mutex(CODE_AT_LINE)) {
+		}
+
+		TaskPool::TaskQueue::~TaskQueue() {
+			delete mutex;
+			mutex = NULL;
+		}
+
+		TaskPool::TaskPool(int workerCount) : mutexPending(new Mutex(CODE_AT_LINE)) {
+			pendingCount = 0;
+			stolenCount = 0;
+
+			if (workerCount < 0) {
+				workerCount = getDefaultWorkerCount();
+			}
+
+			// the last queue belongs to the thread calling run()
+			for (int index = 0; index <= workerCount; ++index) {
+				queues.push_back(new TaskQueue());
+			}
+			for (int index = 0; index < workerCount; ++index) {
+				TaskPoolWorker *worker = new TaskPoolWorker(this, index);
+				worker->setUniqueID(worker->getUniqueID() + "_" + intToStr(index));
+				worker->start();
+				workers.push_back(worker);
+			}
+		}
+
+		TaskPool::~TaskPool() {
+			for (unsigned int index = 0; index < workers.size(); ++index) {
+				workers[index]->signalQuit();
+			}
+			for (unsigned int index = 0; index < workers.size(); ++index) {
+				if (workers[index]->shutdownAndWait() == true) {
+					delete workers[index];
+				}
+			}
+			workers.clear();
+
+			for (unsigned int index = 0; index < queues.size(); ++index) {
+				delete queues[index];
+			}
+			queues.clear();
+
+			delete mutexPending;
+			mutexPending = NULL;
+		}
+
+		// One worker less than the processor count, the thread calling
+		// run() takes the remaining one
+		int TaskPool::getDefaultWorkerCount() {
+			return max(SDL_GetCPUCount() - 1, 1);
+		}
+
+		int64 TaskPool::getStolenCount() {
+			MutexSafeWrapper safeMutex(mutexPending, string(__FILE__) + "_" + intToStr(__LINE__));
+			return stolenCount;
+		}
+
+		// Tasks are dealt out round robin in the given order, so callers
+		// should pass the most expensive tasks first. Returns once all of
+		// them have run, the first error thrown by a task is rethrown here.
+		void TaskPool::run(const vector<TaskPoolTask *> &tasks) {
+			if (tasks.empty() == true) {
+				return;
+			}
+
+			MutexSafeWrapper safeMutex(mutexPending, string(__FILE__) + "_" + intToStr(__LINE__));
+			pendingCount = (int) tasks.size();
+			pendingError = "";
+			safeMutex.ReleaseLock();
+
+			int queueCount = getThreadCount();
+			for (unsigned int index = 0; index < tasks.size(); ++index) {
+				TaskQueue *queue = queues[index % queueCount];
+				MutexSafeWrapper safeMutexQueue(queue->mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+				queue->tasks.push_back(tasks[index]);
+			}
+			for (unsigned int index = 0; index < workers.size(); ++index) {
+				workers[index]->signalTasks();
+			}
+
+			for (; runNextTask(queueCount - 1) == true;) {
+			}
+			semTasksDone.waitTillSignalled();
+
+			safeMutex.Lock();
+			string error = pendingError;
+			safeMutex.ReleaseLock();
+
+			if (error != "") {
+				throw game_runtime_error(error);
+			}
+		}
+
+		bool TaskPool::runNextTask(int workerIndex) {
+			TaskPoolTask *task = popTask(workerIndex);
+			if (task == NULL) {
+				task = stealTask(workerIndex);
+			}
+			if (task == NULL) {
+				return false;
+			}
+
+			string error;
+			try {
+				task->runTask(workerIndex);
+			} catch (const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, ex.what());
+				error = ex.what();
+			} catch (...) {
+				error = "Unknown error in task pool task";
+			}
+			taskDone(error);
+			return true;
+		}
+
+		// ==================== PRIVATE ====================
+
+		TaskPoolTask * TaskPool::popTask(int workerIndex) {
+			TaskQueue *queue = queues[workerIndex];
+			MutexSafeWrapper safeMutex(queue->mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (queue->tasks.empty() == true) {
+				return NULL;
+			}
+			TaskPoolTask *task = queue->tasks.front();
+			queue->tasks.pop_front();
+			return task;
+		}
+
+		TaskPoolTask * TaskPool::stealTask(int workerIndex) {
+			int queueCount = getThreadCount();
+			for (int offset = 1; offset < queueCount; ++offset) {
+				TaskQueue *queue = queues[(workerIndex + offset) % queueCount];
+				MutexSafeWrapper safeMutex(queue->mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+				if (queue->tasks.empty() == false) {
+					TaskPoolTask *task = queue->tasks.back();
+					queue->tasks.pop_back();
+					safeMutex.ReleaseLock();
+
+					MutexSafeWrapper safeMutexPending(mutexPending, string(__FILE__) + "_" + intToStr(__LINE__));
+					stolenCount++;
+					return task;
+				}
+			}
+			return NULL;
+		}
+
+		void TaskPool::taskDone(const string &error) {
+			MutexSafeWrapper safeMutex(mutexPending, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (error != "" && pendingError == "") {
+				pendingError = error;
+			}
+			pendingCount--;
+			if (pendingCount == 0) {
+				semTasksDone.signal();
+			}
+		}
+
+	}
+} //end namespace
@@ -24,6 +24,9 @@
 #include <cstdlib>
 #include <stdexcept>
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
 #if defined(HAVE_SYS_IOCTL_H) || defined(__linux__)
 #define BSD_COMP /* needed for FIONREAD on Solaris2 */
 #include <sys/ioctl.h>
@@ -84,6 +87,9 @@ namespace Shared {
 		int Socket::DEFAULT_SOCKET_RECVBUF_SIZE = -1;
 		string Socket::host_name = "";
 		std::vector<string> Socket::intfTypes;
+		Mutex Socket::closedSocketCountAccessor;
+		uint32 Socket::closedSocketCount = 0;
+		void (*Socket::socketClosedCallback)(const Socket *socket) = NULL;
 
 		int Socket::broadcast_portno = 61357;
 		int ServerSocket::ftpServerPort = 61358;
@@ -857,6 +863,8 @@ namespace Shared {
 			dataSynchAccessorRead = new Mutex(CODE_AT_LINE);
 			dataSynchAccessorWrite = new Mutex(CODE_AT_LINE);
 			inSocketDestructorSynchAccessor = new Mutex(CODE_AT_LINE);
+			sendBatchAccessor = new Mutex(CODE_AT_LINE);
+			sendBatchDepth = 0;
 			lastSocketError = 0;
 
 			MutexSafeWrapper safeMutexSocketDestructorFlag(inSocketDestructorSynchAccessor, CODE_AT_LINE);
@@ -880,6 +888,8 @@ namespace Shared {
 			dataSynchAccessorRead = new Mutex(CODE_AT_LINE);
 			dataSynchAccessorWrite = new Mutex(CODE_AT_LINE);
 			inSocketDestructorSynchAccessor = new Mutex(CODE_AT_LINE);
+			sendBatchAccessor = new Mutex(CODE_AT_LINE);
+			sendBatchDepth = 0;
 			lastSocketError = 0;
 			lastDebugEvent = 0;
 			lastThreadedPing = 0;
@@ -1025,6 +1035,8 @@ namespace Shared {
 			dataSynchAccessorWrite = NULL;
 			delete inSocketDestructorSynchAccessor;
 			inSocketDestructorSynchAccessor = NULL;
+			delete sendBatchAccessor;
+			sendBatchAccessor = NULL;
 		}
 
 		void Socket::disconnectSocket() {
@@ -1047,11 +1059,20 @@ namespace Shared {
 					::closesocket(sock);
 					sock = INVALID_SOCKET;
 #endif
+					MutexSafeWrapper safeMutexClosed(&closedSocketCountAccessor, CODE_AT_LINE);
+					closedSocketCount++;
 				}
 				safeMutex.ReleaseLock();
 				safeMutex1.ReleaseLock();
 			}
 
+			MutexSafeWrapper safeMutexClosed(&closedSocketCountAccessor, CODE_AT_LINE);
+			void (*callback)(const Socket *socket) = socketClosedCallback;
+			safeMutexClosed.ReleaseLock();
+			if (callback != NULL) {
+				callback(this);
+			}
+
 			if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] END closing socket = %d...\n", __FILE__, __FUNCTION__, sock);
 		}
 
@@ -1114,6 +1135,16 @@ namespace Shared {
 			return bResult;
 		}
 
+		uint32 Socket::getClosedSocketCount() {
+			MutexSafeWrapper safeMutex(&closedSocketCountAccessor, CODE_AT_LINE);
+			return closedSocketCount;
+		}
+
+		void Socket::setSocketClosedCallback(void (*callback)(const Socket *socket)) {
+			MutexSafeWrapper safeMutex(&closedSocketCountAccessor, CODE_AT_LINE);
+			socketClosedCallback = callback;
+		}
+
 		bool Socket::hasDataToRead() {
 			MutexSafeWrapper safeMutex(dataSynchAccessorRead, CODE_AT_LINE);
 			return Socket::hasDataToRead(sock);
@@ -1255,9 +1286,49 @@ namespace Shared {
 			return static_cast<int>(size);
 		}
 
+		void Socket::beginSendBatch() {
+			MutexSafeWrapper safeMutex(sendBatchAccessor, CODE_AT_LINE);
+			sendBatchDepth++;
+		}
+
+		bool Socket::endSendBatch() {
+			MutexSafeWrapper safeMutex(sendBatchAccessor, CODE_AT_LINE);
+			if (sendBatchDepth <= 0) {
+				return true;
+			}
+			sendBatchDepth--;
+			if (sendBatchDepth > 0 || sendBatchBuffer.empty() == true) {
+				return true;
+			}
+
+			// the batch mutex stays locked through the send, so nothing sent
+			// after the batch was closed can go out before it
+			int pendingSize = (int) sendBatchBuffer.size();
+			int bytesSent = send(&sendBatchBuffer[0], pendingSize);
+			sendBatchBuffer.clear();
+
+			if (bytesSent != pendingSize) {
+				// part of the batch may be out already, the message stream
+				// can't be picked up again after that
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s Line: %d] send batch failed, bytesSent = %d pendingSize = %d\n", __FILE__, __FUNCTION__, __LINE__, bytesSent, pendingSize);
+				disconnectSocket();
+				return false;
+			}
+			return true;
+		}
+
 		int Socket::send(const void *data, int dataSize) {
 			const int MAX_SEND_WAIT_SECONDS = 3;
 
+			// held for the whole send, so a send can't slip in while a
+			// batch is being flushed
+			MutexSafeWrapper safeMutexBatch(sendBatchAccessor, CODE_AT_LINE);
+			if (dataSize > 0 && sendBatchDepth > 0) {
+				const char *bytes = (const char *) data;
+				sendBatchBuffer.insert(sendBatchBuffer.end(), bytes, bytes + dataSize);
+				return dataSize;
+			}
+
 			int bytesSent = 0;
 			if (isSocketValid() == true) {
 				errno = 0;
@@ -1922,6 +1993,127 @@ namespace Shared {
 			throw game_runtime_error(msg);
 		}
 
+		// ===============================================
+		//	class SocketEventPoller
+		// ===============================================
+
+		SocketEventPoller::SocketEventPoller() {
+			epollHandle = -1;
+			registeredClosedSocketCount = Socket::getClosedSocketCount();
+#if defined(__linux__)
+			epollHandle = epoll_create1(EPOLL_CLOEXEC);
+			if (epollHandle < 0) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] epoll unavailable, using select: %s\n", __FILE__, __FUNCTION__, __LINE__, Socket::getLastSocketErrorFormattedText().c_str());
+			}
+#endif
+		}
+
+		SocketEventPoller::~SocketEventPoller() {
+#if defined(__linux__)
+			if (epollHandle >= 0) {
+				::close(epollHandle);
+				epollHandle = -1;
+			}
+#endif
+		}
+
+		bool SocketEventPoller::hasDataToRead(std::map<PLATFORM_SOCKET, bool> &socketTriggeredList, int waitMilliseconds) {
+#if defined(__linux__)
+			if (epollHandle >= 0) {
+				registerSockets(socketTriggeredList);
+
+				for (std::map<PLATFORM_SOCKET, bool>::iterator itermap = socketTriggeredList.begin();
+					itermap != socketTriggeredList.end(); ++itermap) {
+					itermap->second = false;
+				}
+				if (registeredSockets.empty() == true) {
+					return false;
+				}
+
+				std::vector<struct epoll_event> events(registeredSockets.size());
+				int retval = epoll_wait(epollHandle, &events[0], (int) events.size(), max(waitMilliseconds, 0));
+				if (retval < 0) {
+					if (errno != EINTR) {
+						if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] Line: %d, ERROR POLLING SOCKET DATA retval = %d error = %s\n", __FILE__, __FUNCTION__, __LINE__, retval, Socket::getLastSocketErrorFormattedText().c_str());
+						printf("In [%s::%s] Line: %d, ERROR POLLING SOCKET DATA retval = %d error = %s\n", __FILE__, __FUNCTION__, __LINE__, retval, Socket::getLastSocketErrorFormattedText().c_str());
+					}
+					return false;
+				}
+
+				// hang ups and errors count as readable, the read reports them
+				bool bResult = false;
+				for (int index = 0; index < retval; ++index) {
+					std::map<PLATFORM_SOCKET, bool>::iterator iterFind = socketTriggeredList.find(events[index].data.fd);
+					if (iterFind != socketTriggeredList.end()) {
+						iterFind->second = true;
+						bResult = true;
+					}
+				}
+				return bResult;
+			}
+#endif
+			if (waitMilliseconds > 0 && socketTriggeredList.size() == 1) {
+				std::map<PLATFORM_SOCKET, bool>::iterator iterSocket = socketTriggeredList.begin();
+				iterSocket->second = Socket::hasDataToReadWithWait(iterSocket->first, waitMilliseconds * 1000);
+				return iterSocket->second;
+			}
+			return Socket::hasDataToRead(socketTriggeredList);
+		}
+
+		// Brings the epoll set in line with the given sockets. Registrations
+		// are level triggered: a slot reads one message at a time, so a
+		// socket has to keep reporting while data is left in it. A closed
+		// descriptor drops out of epoll by itself and its number may come
+		// back for a new socket, so after any close everything is added again.
+		void SocketEventPoller::registerSockets(const std::map<PLATFORM_SOCKET, bool> &socketList) {
+#if defined(__linux__)
+			uint32 closedSocketCount = Socket::getClosedSocketCount();
+			if (closedSocketCount != registeredClosedSocketCount) {
+				unregisterAll();
+				registeredClosedSocketCount = closedSocketCount;
+			}
+
+			for (std::map<PLATFORM_SOCKET, bool>::iterator itermap = registeredSockets.begin();
+				itermap != registeredSockets.end();) {
+				if (socketList.find(itermap->first) == socketList.end()) {
+					epoll_ctl(epollHandle, EPOLL_CTL_DEL, itermap->first, NULL);
+					registeredSockets.erase(itermap++);
+				} else {
+					++itermap;
+				}
+			}
+
+			for (std::map<PLATFORM_SOCKET, bool>::const_iterator itermap = socketList.begin();
+				itermap != socketList.end(); ++itermap) {
+				PLATFORM_SOCKET socket = itermap->first;
+				if (registeredSockets.find(socket) != registeredSockets.end() ||
+					Socket::isSocketValid(&socket) == false) {
+					continue;
+				}
+
+				struct epoll_event event;
+				memset(&event, 0, sizeof(event));
+				event.events = EPOLLIN | EPOLLRDHUP;
+				event.data.fd = socket;
+				if (epoll_ctl(epollHandle, EPOLL_CTL_ADD, socket, &event) == 0 || errno == EEXIST) {
+					registeredSockets[socket] = true;
+				} else if (SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) {
+					SystemFlags::OutputDebug(SystemFlags::debugNetwork, "In [%s::%s] Line: %d, could not register socket = %d error = %s\n", __FILE__, __FUNCTION__, __LINE__, socket, Socket::getLastSocketErrorFormattedText().c_str());
+				}
+			}
+#endif
+		}
+
+		void SocketEventPoller::unregisterAll() {
+#if defined(__linux__)
+			for (std::map<PLATFORM_SOCKET, bool>::iterator itermap = registeredSockets.begin();
+				itermap != registeredSockets.end(); ++itermap) {
+				epoll_ctl(epollHandle, EPOLL_CTL_DEL, itermap->first, NULL);
+			}
+#endif
+			registeredSockets.clear();
+		}
+
 		// ===============================================
 		//	class ClientSocket
 		// ===============================================
@@ -29,10 +29,16 @@
 
 #include <sys/stat.h> // for open()
 
+#ifndef WIN32
+#include <sys/mman.h> // for mmap()
+#include <unistd.h> // for close()
+#endif
+
 #include "util.h"
 #include "platform_common.h"
 #include "conversion.h"
 #include "platform_util.h"
+#include "task_pool.h"
 #include "leak_dumper.h"
 
 using namespace std;
@@ -85,6 +91,124 @@ namespace Shared {
 			0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 		};
 
+		// crc_tables_sliced[k][b] is the CRC of byte b followed by k zero
+		// bytes, which lets addBytes fold 8 input bytes per step
+		// (slicing-by-8) with the same result as the byte loop.
+		static uint32 crc_tables_sliced[8][256];
+
+		static bool initSlicedCRCTables() {
+			for (unsigned int i = 0; i < 256; ++i) {
+				crc_tables_sliced[0][i] = crc_table[i];
+			}
+			for (unsigned int k = 1; k < 8; ++k) {
+				for (unsigned int i = 0; i < 256; ++i) {
+					uint32 crc = crc_tables_sliced[k - 1][i];
+					crc_tables_sliced[k][i] = (crc >> 8) ^ crc_table[crc & 0xff];
+				}
+			}
+			return true;
+		}
+		static bool slicedCRCTablesReady = initSlicedCRCTables();
+
+		// Read only view of a whole file, mapped where the platform allows
+		// and read into memory otherwise
+		class ChecksumFileView {
+		private:
+			const unsigned char *data;
+			size_t size;
+			bool mapped;
+			std::vector<unsigned char> buffer;
+
+		public:
+			ChecksumFileView() : data(NULL), size(0), mapped(false) {
+			}
+			~ChecksumFileView() {
+#ifndef WIN32
+				if (mapped == true) {
+					munmap((void *) data, size);
+				}
+#endif
+			}
+
+			bool open(const string &path) {
+#ifndef WIN32
+				int fd = ::open(path.c_str(), O_RDONLY);
+				if (fd < 0) {
+					return false;
+				}
+				struct stat st;
+				if (fstat(fd, &st) != 0) {
+					::close(fd);
+					return false;
+				}
+				size = (size_t) st.st_size;
+				if (size > 0) {
+					void *view = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (view != MAP_FAILED) {
+						madvise(view, size, MADV_SEQUENTIAL);
+						data = (const unsigned char *) view;
+						mapped = true;
+					} else {
+						buffer.resize(size);
+						size_t total = 0;
+						while (total < size) {
+							ssize_t readBytes = read(fd, &buffer[total], size - total);
+							if (readBytes <= 0) {
+								break;
+							}
+							total += (size_t) readBytes;
+						}
+						size = total;
+						data = (size > 0 ? &buffer[0] : NULL);
+					}
+				}
+				::close(fd);
+				return true;
+#else
+#if !defined(__MINGW32__)
+				FILE *fp = _wfopen(utf8_decode(path).c_str(), L"rb");
+#else
+				FILE *fp = fopen(path.c_str(), "rb");
+#endif
+				if (fp == NULL) {
+					return false;
+				}
+				fseek(fp, 0, SEEK_END);
+				long fileSize = ftell(fp);
+				fseek(fp, 0, SEEK_SET);
+				if (fileSize > 0) {
+					buffer.resize((size_t) fileSize);
+					size = fread(&buffer[0], 1, buffer.size(), fp);
+					data = (size > 0 ? &buffer[0] : NULL);
+				}
+				fclose(fp);
+				return true;
+#endif
+			}
+
+			const unsigned char * getData() const {
+				return data;
+			}
+			size_t getSize() const {
+				return size;
+			}
+		};
+
+		// Checksum of one file, run on the pool by Checksum::addFilesToCache
+		class FileChecksumTask : public TaskPoolTask {
+		public:
+			explicit FileChecksumTask(const string &path) : path(path), crc(0) {
+			}
+			virtual void runTask(int workerIndex) {
+				Checksum fileResult;
+				fileResult.addFileToSum(path);
+				crc = fileResult.getSum();
+			}
+
+			string path;
+			uint32 crc;
+		};
+
 		Checksum::Checksum() {
 			sum = 0;
 			r = 55665;
@@ -110,11 +234,27 @@ namespace Shared {
 
 		uint32 Checksum::addBytes(const void *_data, size_t _size) {
 			const unsigned char *rVal = reinterpret_cast<const unsigned char *>(_data);
-			sum = ~sum;
+			uint32 crc = ~sum;
+			if (slicedCRCTablesReady == true) {
+				for (; _size >= 8; _size -= 8, rVal += 8) {
+					uint32 one = crc ^ ((uint32) rVal[0] | ((uint32) rVal[1] << 8) |
+						((uint32) rVal[2] << 16) | ((uint32) rVal[3] << 24));
+					uint32 two = (uint32) rVal[4] | ((uint32) rVal[5] << 8) |
+						((uint32) rVal[6] << 16) | ((uint32) rVal[7] << 24);
+					crc = crc_tables_sliced[7][one & 0xff] ^
+						crc_tables_sliced[6][(one >> 8) & 0xff] ^
+						crc_tables_sliced[5][(one >> 16) & 0xff] ^
+						crc_tables_sliced[4][one >> 24] ^
+						crc_tables_sliced[3][two & 0xff] ^
+						crc_tables_sliced[2][(two >> 8) & 0xff] ^
+						crc_tables_sliced[1][(two >> 16) & 0xff] ^
+						crc_tables_sliced[0][two >> 24];
+				}
+			}
 			while (_size--) {
-				sum = (sum >> 8) ^ crc_table[*rVal++ ^ (sum & 0xff)];
+				crc = (crc >> 8) ^ crc_table[*rVal++ ^ (crc & 0xff)];
 			}
-			sum = ~sum;
+			sum = ~crc;
 
 			return sum;
 		}
@@ -172,9 +312,7 @@ namespace Shared {
 		}
 
 		void Checksum::addString(const string &value) {
-			for (unsigned int i = 0; i < value.size(); ++i) {
-				addByte(value[i]);
-			}
+			addBytes(value.data(), value.size());
 		}
 
 		void Checksum::addFile(const string &path) {
@@ -291,79 +429,51 @@ namespace Shared {
 				fclose(file);
 			*/
 
-#if defined(WIN32) && !defined(__MINGW32__)
-			wstring wstr = utf8_decode(path);
-			FILE *fp = _wfopen(wstr.c_str(), L"rb");
-			ifstream ifs(fp);
-#else
-			ifstream ifs(path.c_str());
-#endif
-
-			if (ifs) {
+			ChecksumFileView fileView;
+			if (fileView.open(path) == true) {
 				fileExists = true;
 				addString(lastFile(path));
 
 				bool isXMLFile = (EndsWith(path, ".xml") == true);
+				const unsigned char *buf = fileView.getData();
+				const std::size_t bufSize = fileView.getSize();
 
-				// Determine the file length
-				ifs.seekg(0, ios::end);
-				std::streamoff size = ifs.tellg();
-				ifs.seekg(0, ios::beg);
-
-				unsigned int bufSize = (unsigned int) size / sizeof(char);
-				// Create a vector to store the data
-				std::vector<char> buf(bufSize);
-				// Load the data
-				ifs.read((char*) &buf[0], buf.size());
-
-				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] buf.size() = %d, path [%s], isXMLFile = %d\n", __FILE__, __FUNCTION__, __LINE__, buf.size(), path.c_str(), isXMLFile);
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] bufSize = %d, path [%s], isXMLFile = %d\n", __FILE__, __FUNCTION__, __LINE__, bufSize, path.c_str(), isXMLFile);
 
 				if (isXMLFile == true) {
+					// Ignore comments and spaces in XML files as they are
+					// ONLY for formatting. The bytes kept between them are
+					// summed a run at a time.
 					bool inCommentTag = false;
-					for (std::size_t i = 0; i < buf.size(); ++i) {
-						// Ignore Spaces in XML files as they are
-						// ONLY for formatting
-						//if(isXMLFile == true) {
+					std::size_t runStart = 0;
+					for (std::size_t i = 0; i < bufSize; ++i) {
+						bool skip = true;
 						if (inCommentTag == true) {
 							if (buf[i] == '>' && i >= 3 && buf[i - 1] == '-' && buf[i - 2] == '-') {
 								inCommentTag = false;
-								//printf("TURNING OFF comment TAG, i = %d [%c]",i,buf[i]);
-								if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] i = %d\n", __FILE__, __FUNCTION__, __LINE__, i);
-							} else {
-								//printf("SKIPPING XML comment character, i = %d [%c]",i,buf[i]);
-								if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] i = %d\n", __FILE__, __FUNCTION__, __LINE__, i);
 							}
-							continue;
-						}
-						//else if(buf[i] == '-' && i >= 4 && buf[i-1] == '-' && buf[i-2] == '!' && buf[i-3] == '<') {
-						else if (buf[i] == '<' && i + 4 < bufSize && buf[i + 1] == '!' && buf[i + 2] == '-' && buf[i + 3] == '-') {
+						} else if (buf[i] == '<' && i + 4 < bufSize && buf[i + 1] == '!' && buf[i + 2] == '-' && buf[i + 3] == '-') {
 							inCommentTag = true;
-							//printf("TURNING ON comment TAG, i = %d [%c]",i,buf[i]);
-							if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] i = %d\n", __FILE__, __FUNCTION__, __LINE__, i);
-							continue;
-						} else if (buf[i] == ' ' || buf[i] == '\t' || buf[i] == '\n' || buf[i] == '\r') {
-							//printf("SKIPPING special character, i = %d [%c]",i,buf[i]);
-							if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] i = %d\n", __FILE__, __FUNCTION__, __LINE__, i);
-							continue;
+						} else if (buf[i] != ' ' && buf[i] != '\t' && buf[i] != '\n' && buf[i] != '\r') {
+							skip = false;
 						}
-						//}
-						uint32 cipher = addByte(buf[i]);
 
-						if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] %d / %d, cipher = %u\n", __FILE__, __FUNCTION__, __LINE__, i, buf.size(), cipher);
+						if (skip == true) {
+							if (i > runStart) {
+								addBytes(buf + runStart, i - runStart);
+							}
+							runStart = i + 1;
+						}
 					}
-				} else {
-					uint32 cipher = addBytes(&buf[0], buf.size());
-					if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] %d, cipher = %u\n", __FILE__, __FUNCTION__, __LINE__, buf.size(), cipher);
+					if (bufSize > runStart) {
+						addBytes(buf + runStart, bufSize - runStart);
+					}
+				} else if (bufSize > 0) {
+					addBytes(buf, bufSize);
 				}
 
-				// Close the file
-				ifs.close();
-			}
-#if defined(WIN32) && !defined(__MINGW32__)
-			if (fp) {
-				fclose(fp);
+				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] %d, cipher = %u\n", __FILE__, __FUNCTION__, __LINE__, bufSize, sum);
 			}
-#endif
 
 			return fileExists;
 		}
@@ -373,23 +483,20 @@ namespace Shared {
 			if (fileList.size() > 0) {
 				if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] fileList.size() = %d\n", __FILE__, __FUNCTION__, __LINE__, fileList.size());
 
-				Checksum newResult;
+				std::vector<string> paths;
+				paths.reserve(fileList.size());
+				for (std::map<string, uint32>::iterator iterMap = fileList.begin();
+					iterMap != fileList.end(); ++iterMap) {
+					paths.push_back(iterMap->first);
+				}
+				addFilesToCache(paths);
 
+				// combined in file name order, whichever thread summed the files
+				Checksum newResult;
 				{
-
+					MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
 					for (std::map<string, uint32>::iterator iterMap = fileList.begin();
 						iterMap != fileList.end(); ++iterMap) {
-
-						MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
-						if (Checksum::fileListCache.find(iterMap->first) == Checksum::fileListCache.end()) {
-							Checksum fileResult;
-							//bool fileAddedOk = fileResult.addFileToSum(iterMap->first);
-							fileResult.addFileToSum(iterMap->first);
-							Checksum::fileListCache[iterMap->first] = fileResult.getSum();
-							//printf("fileAddedOk = %d for file [%s] CRC [%d]\n",fileAddedOk,iterMap->first.c_str(),Checksum::fileListCache[iterMap->first]);
-						} else {
-							//printf("Getting checksum from CACHE for file [%s] CRC [%d]\n",iterMap->first.c_str(),Checksum::fileListCache[iterMap->first]);
-						}
 						newResult.addSum(Checksum::fileListCache[iterMap->first]);
 					}
 				}
@@ -422,6 +529,51 @@ namespace Shared {
 			return (uint32) fileList.size();
 		}
 
+		// Sums every file not yet in the cache, on a task pool when there
+		// are enough of them to be worth the threads. Callers summing many
+		// small batches pass their own pool so its threads are reused.
+		void Checksum::addFilesToCache(const std::vector<string> &paths, TaskPool *pool) {
+			std::vector<FileChecksumTask> tasks;
+			{
+				MutexSafeWrapper safeMutex(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
+				for (unsigned int index = 0; index < paths.size(); ++index) {
+					if (paths[index] != "" && Checksum::fileListCache.find(paths[index]) == Checksum::fileListCache.end()) {
+						tasks.push_back(FileChecksumTask(paths[index]));
+					}
+				}
+			}
+			if (tasks.empty() == true) {
+				return;
+			}
+
+			const int minFilesPerThread = 4;
+			int workerCount = min((pool != NULL ? pool->getThreadCount() - 1 : TaskPool::getDefaultWorkerCount()), (int) tasks.size() / minFilesPerThread);
+			if (workerCount > 0) {
+				std::vector<TaskPoolTask *> taskList;
+				taskList.reserve(tasks.size());
+				for (unsigned int index = 0; index < tasks.size(); ++index) {
+					taskList.push_back(&tasks[index]);
+				}
+				if (pool != NULL) {
+					pool->run(taskList);
+				} else {
+					TaskPool ownPool(workerCount);
+					ownPool.run(taskList);
+				}
+			} else {
+				for (unsigned int index = 0; index < tasks.size(); ++index) {
+					tasks[index].runTask(0);
+				}
+			}
+
+			if (SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem, "In [%s::%s Line: %d] summed %d files with %d extra threads\n", __FILE__, __FUNCTION__, __LINE__, (int) tasks.size(), workerCount);
+
+			MutexSafeWrapper safeMutex(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
+			for (unsigned int index = 0; index < tasks.size(); ++index) {
+				Checksum::fileListCache[tasks[index].path] = tasks[index].crc;
+			}
+		}
+
 		void Checksum::removeFileFromCache(const string file) {
 			MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor, string(__FILE__) + "_" + intToStr(__LINE__));
 			if (Checksum::fileListCache.find(file) != Checksum::fileListCache.end()) {
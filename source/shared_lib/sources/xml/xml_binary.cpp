@@ -0,0 +1,294 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#include "xml_binary.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "conversion.h"
+#include "properties.h"
+#include "compression_utils.h"
+#include "util.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::PlatformCommon;
+using namespace Shared::CompressionUtil;
+using namespace Shared::Util;
+
+namespace Shared {
+	namespace Xml {
+
+		static const char binaryFileMagic[4] = { 'G', 'X', 'B', 'F' };
+		static const uint32 binaryFileVersion = 1;
+		// magic, version, compression level, raw size, stored size
+		static const uint32 binaryHeaderSize = sizeof(binaryFileMagic) + 4 * sizeof(uint32);
+
+		static void writeUInt(string &out, uint32 value) {
+			out.append((const char *) &value, sizeof(value));
+		}
+
+		static void writeString(string &out, const string &value) {
+			writeUInt(out, (uint32) value.size());
+			out.append(value);
+		}
+
+		static uint32 readUInt(const char *data, uint32 &offset, uint32 end) {
+			if (end - offset < sizeof(uint32)) {
+				throw game_runtime_error("Binary xml data is truncated");
+			}
+			uint32 value = 0;
+			memcpy(&value, data + offset, sizeof(value));
+			offset += sizeof(value);
+			return value;
+		}
+
+		static string readString(const char *data, uint32 &offset, uint32 end) {
+			uint32 length = readUInt(data, offset, end);
+			if (end - offset < length) {
+				throw game_runtime_error("Binary xml data is truncated");
+			}
+			string value(data + offset, length);
+			offset += length;
+			return value;
+		}
+
+		// =====================================================
+		//	class XmlIoBinary
+		// =====================================================
+
+		bool XmlIoBinary::isBinaryData(const char *data, int64 size) {
+			return data != NULL && size >= (int64) binaryHeaderSize &&
+				memcmp(data, binaryFileMagic, sizeof(binaryFileMagic)) == 0;
+		}
+
+		XmlNode * XmlIoBinary::load(const char *data, int64 size, const std::map<string, string> &mapTagReplacementValues, bool skipUpdatePathClimbingParts) {
+			if (isBinaryData(data, size) == false) {
+				throw game_runtime_error("Not a binary xml file");
+			}
+
+			uint32 offset = sizeof(binaryFileMagic);
+			uint32 headerEnd = binaryHeaderSize;
+			uint32 version = readUInt(data, offset, headerEnd);
+			uint32 compressionLevel = readUInt(data, offset, headerEnd);
+			uint32 rawSize = readUInt(data, offset, headerEnd);
+			uint32 storedSize = readUInt(data, offset, headerEnd);
+			if (version != binaryFileVersion) {
+				throw game_runtime_error("Unsupported binary xml version: " + uIntToStr(version));
+			}
+			if ((int64) storedSize > size - (int64) binaryHeaderSize) {
+				throw game_runtime_error("Binary xml data is truncated");
+			}
+
+			const char *payload = data + binaryHeaderSize;
+			std::pair<unsigned char *, unsigned long> extracted((unsigned char *) NULL, 0);
+			if (compressionLevel > 0) {
+				extracted = extractMemoryToMemory((unsigned char *) payload, storedSize, rawSize);
+				if (extracted.second != rawSize) {
+					delete[] extracted.first;
+					throw game_runtime_error("Binary xml data failed to decompress");
+				}
+				payload = (const char *) extracted.first;
+			} else if (storedSize != rawSize) {
+				throw game_runtime_error("Binary xml data has a bad size");
+			}
+
+			XmlNode *rootNode = NULL;
+			try {
+				uint32 payloadOffset = 0;
+				uint32 nameCount = readUInt(payload, payloadOffset, rawSize);
+				if (nameCount > rawSize) {
+					throw game_runtime_error("Binary xml data is corrupt");
+				}
+				vector<string> nameList;
+				nameList.reserve(nameCount);
+				for (unsigned int index = 0; index < nameCount; ++index) {
+					nameList.push_back(readString(payload, payloadOffset, rawSize));
+				}
+
+				rootNode = readNode(nameList, payload, payloadOffset, rawSize, mapTagReplacementValues, skipUpdatePathClimbingParts);
+			} catch (...) {
+				delete[] extracted.first;
+				throw;
+			}
+			delete[] extracted.first;
+			return rootNode;
+		}
+
+		string XmlIoBinary::saveToMemory(const XmlNode *node, int compressionLevel) {
+			if (node == NULL) {
+				throw game_runtime_error("node == NULL during save!");
+			}
+
+			NameIndex names;
+			vector<const string *> nameList;
+			string body;
+			writeNode(node, names, nameList, body);
+
+			string payload;
+			writeUInt(payload, (uint32) nameList.size());
+			for (unsigned int index = 0; index < nameList.size(); ++index) {
+				writeString(payload, *nameList[index]);
+			}
+			payload.append(body);
+			body.clear();
+
+			std::pair<unsigned char *, unsigned long> compressed((unsigned char *) NULL, 0);
+			const char *stored = payload.data();
+			unsigned long storedSize = (unsigned long) payload.size();
+			if (compressionLevel > 0) {
+				compressed = compressMemoryToMemory((unsigned char *) payload.data(), (unsigned long) payload.size(), compressionLevel);
+				stored = (const char *) compressed.first;
+				storedSize = compressed.second;
+			}
+
+			string out(binaryFileMagic, sizeof(binaryFileMagic));
+			writeUInt(out, binaryFileVersion);
+			writeUInt(out, (uint32) max(compressionLevel, 0));
+			writeUInt(out, (uint32) payload.size());
+			writeUInt(out, (uint32) storedSize);
+			out.append(stored, storedSize);
+			delete[] compressed.first;
+			return out;
+		}
+
+		// Returns NULL when the file is not binary xml, so the caller can hand
+		// it to its text parser
+		XmlNode * XmlIoBinary::loadFile(const string &path, const std::map<string, string> &mapTagReplacementValues, bool skipUpdatePathClimbingParts) {
+#if defined(WIN32) && !defined(__MINGW32__)
+			FILE *fp = _wfopen(utf8_decode(path).c_str(), L"rb");
+#else
+			FILE *fp = fopen(path.c_str(), "rb");
+#endif
+			if (fp == NULL) {
+				return NULL;
+			}
+
+			char header[binaryHeaderSize];
+			if (fread(header, 1, binaryHeaderSize, fp) != binaryHeaderSize ||
+				isBinaryData(header, binaryHeaderSize) == false) {
+				fclose(fp);
+				return NULL;
+			}
+
+			vector<char> buffer(header, header + binaryHeaderSize);
+			char readBuf[8192];
+			for (size_t readCount = fread(readBuf, 1, sizeof(readBuf), fp); readCount > 0;
+				readCount = fread(readBuf, 1, sizeof(readBuf), fp)) {
+				buffer.insert(buffer.end(), readBuf, readBuf + readCount);
+			}
+			fclose(fp);
+
+			try {
+				return load(&buffer.front(), (int64) buffer.size(), mapTagReplacementValues, skipUpdatePathClimbingParts);
+			} catch (const game_runtime_error &ex) {
+				throw game_runtime_error("Error loading XML: " + path + "\nMessage: " + ex.what());
+			}
+		}
+
+		void XmlIoBinary::save(const string &path, const XmlNode *node, int compressionLevel) {
+			string out = saveToMemory(node, compressionLevel);
+
+#if defined(WIN32) && !defined(__MINGW32__)
+			FILE *fp = _wfopen(utf8_decode(path).c_str(), L"wb");
+#else
+			FILE *fp = fopen(path.c_str(), "wb");
+#endif
+			if (fp == NULL) {
+				throw game_runtime_error("Can not open file: [" + path + "]");
+			}
+			bool written = (fwrite(out.data(), 1, out.size(), fp) == out.size());
+			fclose(fp);
+
+			if (written == false) {
+				throw game_runtime_error("Error writing file: [" + path + "]");
+			}
+		}
+
+		// ==================== PRIVATE ====================
+
+		void XmlIoBinary::writeNode(const XmlNode *node, NameIndex &names, vector<const string *> &nameList, string &out) {
+			// names are interned, so equal names share one pointer
+			NameIndex::iterator iterFind = names.find(node->name);
+			if (iterFind == names.end()) {
+				iterFind = names.insert(make_pair(node->name, (uint32) nameList.size())).first;
+				nameList.push_back(node->name);
+			}
+			writeUInt(out, iterFind->second);
+			writeUInt(out, (uint32) node->attributes.size());
+			writeUInt(out, (uint32) node->children.size());
+			writeString(out, node->text);
+
+			for (unsigned int index = 0; index < node->attributes.size(); ++index) {
+				const XmlAttribute *attribute = node->attributes[index];
+				iterFind = names.find(attribute->name);
+				if (iterFind == names.end()) {
+					iterFind = names.insert(make_pair(attribute->name, (uint32) nameList.size())).first;
+					nameList.push_back(attribute->name);
+				}
+				writeUInt(out, iterFind->second);
+				writeString(out, attribute->value);
+			}
+			for (unsigned int index = 0; index < node->children.size(); ++index) {
+				writeNode(node->children[index], names, nameList, out);
+			}
+		}
+
+		XmlNode * XmlIoBinary::readNode(const vector<string> &nameList, const char *data, uint32 &offset, uint32 end,
+			const std::map<string, string> &mapTagReplacementValues, bool skipUpdatePathClimbingParts) {
+			uint32 nameIndex = readUInt(data, offset, end);
+			uint32 attributeCount = readUInt(data, offset, end);
+			uint32 childCount = readUInt(data, offset, end);
+			if (nameIndex >= nameList.size() || attributeCount > end - offset || childCount > end - offset) {
+				throw game_runtime_error("Binary xml data is corrupt");
+			}
+
+			XmlNode *node = new XmlNode(nameList[nameIndex]);
+			try {
+				node->text = readString(data, offset, end);
+				if (childCount == 0) {
+					Properties::applyTagsToValue(node->text, &mapTagReplacementValues, skipUpdatePathClimbingParts);
+				}
+
+				node->attributes.reserve(attributeCount);
+				for (unsigned int index = 0; index < attributeCount; ++index) {
+					uint32 attributeNameIndex = readUInt(data, offset, end);
+					if (attributeNameIndex >= nameList.size()) {
+						throw game_runtime_error("Binary xml data is corrupt");
+					}
+					string value = readString(data, offset, end);
+					node->attributes.push_back(new XmlAttribute(nameList[attributeNameIndex], value, mapTagReplacementValues));
+				}
+
+				node->children.reserve(childCount);
+				for (unsigned int index = 0; index < childCount; ++index) {
+					node->children.push_back(readNode(nameList, data, offset, end, mapTagReplacementValues, skipUpdatePathClimbingParts));
+				}
+			} catch (...) {
+				delete node;
+				throw;
+			}
+			return node;
+		}
+
+	}
+} //end namespace
@@ -0,0 +1,338 @@
+// This file is part of Glest <https://github.com/Glest>
+//
+// Copyright (C) 2018  The Glest team
+//
+// Glest is a fork of MegaGlest <https://megaglest.org/>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>
+
+#include "xml_cache.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "conversion.h"
+#include "checksum.h"
+#include "properties.h"
+#include "util.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
+
+namespace Shared {
+	namespace Xml {
+
+		static const char cacheFileMagic[4] = { 'G', 'X', 'T', 'C' };
+		static const uint32 cacheFileVersion = 1;
+
+		static void writeUInt(string &out, uint32 value) {
+			out.append((const char *) &value, sizeof(value));
+		}
+
+		static void writeString(string &out, const char *value) {
+			uint32 length = (uint32) strlen(value);
+			writeUInt(out, length);
+			out.append(value, length);
+		}
+
+		static uint32 readUInt(const vector<char> &buffer, uint32 &offset, uint32 end) {
+			if (end - offset < sizeof(uint32)) {
+				throw game_runtime_error("Xml tree cache is corrupt");
+			}
+			uint32 value = 0;
+			memcpy(&value, &buffer[offset], sizeof(value));
+			offset += sizeof(value);
+			return value;
+		}
+
+		static string readString(const vector<char> &buffer, uint32 &offset, uint32 end) {
+			uint32 length = readUInt(buffer, offset, end);
+			if (end - offset < length) {
+				throw game_runtime_error("Xml tree cache is corrupt");
+			}
+			string value(length > 0 ? &buffer[offset] : "", length);
+			offset += length;
+			return value;
+		}
+
+		// =====================================================
+		//	class XmlTreeCache
+		// =====================================================
+
+		Mutex XmlTreeCache::mutex(CODE_AT_LINE);
+		bool XmlTreeCache::active = false;
+		bool XmlTreeCache::recording = false;
+		string XmlTreeCache::cacheFile;
+		uint32 XmlTreeCache::contentCRC = 0;
+		vector<string> XmlTreeCache::folderList;
+		vector<char> XmlTreeCache::buffer;
+		std::map<string, pair<uint32, uint32> > XmlTreeCache::treeIndex;
+		std::map<string, string> XmlTreeCache::recordedTrees;
+
+		string XmlTreeCache::getCacheFileName(const vector<string> &folders) {
+			Checksum checksum;
+			for (unsigned int index = 0; index < folders.size(); ++index) {
+				checksum.addString(folders[index]);
+			}
+			return getCRCCacheFilePath() + "XML_CACHE_" + uIntToStr(checksum.getSum());
+		}
+
+		// Files parsed below the folders until end() come from the cache
+		// when it was written for the same crc, otherwise they are recorded
+		void XmlTreeCache::begin(const vector<string> &folders, uint32 crc) {
+			MutexSafeWrapper safeMutex(&mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			active = true;
+			folderList = folders;
+			contentCRC = crc;
+			cacheFile = getCacheFileName(folders);
+			buffer.clear();
+			treeIndex.clear();
+			recordedTrees.clear();
+
+			recording = (readCacheFile() == false);
+			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("Xml tree cache [%s] crc %u %s\n", cacheFile.c_str(), crc, (recording ? "recording" : "loaded"));
+		}
+
+		void XmlTreeCache::end(bool save) {
+			MutexSafeWrapper safeMutex(&mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (active == true && recording == true && save == true && recordedTrees.empty() == false) {
+				string out(cacheFileMagic, sizeof(cacheFileMagic));
+				writeUInt(out, cacheFileVersion);
+				writeUInt(out, contentCRC);
+				writeUInt(out, (uint32) folderList.size());
+				for (unsigned int index = 0; index < folderList.size(); ++index) {
+					writeString(out, folderList[index].c_str());
+				}
+				writeUInt(out, (uint32) recordedTrees.size());
+				for (std::map<string, string>::const_iterator iterMap = recordedTrees.begin();
+					iterMap != recordedTrees.end(); ++iterMap) {
+					writeString(out, iterMap->first.c_str());
+					writeUInt(out, (uint32) iterMap->second.size());
+					out.append(iterMap->second);
+				}
+
+				string tempFile = cacheFile + ".tmp";
+#ifdef WIN32
+				FILE *fp = _wfopen(utf8_decode(tempFile).c_str(), L"wb");
+#else
+				FILE *fp = fopen(tempFile.c_str(), "wb");
+#endif
+				if (fp != NULL) {
+					bool written = (fwrite(out.data(), 1, out.size(), fp) == out.size());
+					fclose(fp);
+					if (written == true) {
+						removeFile(cacheFile);
+						renameFile(tempFile, cacheFile);
+					} else {
+						removeFile(tempFile);
+					}
+				}
+			}
+
+			active = false;
+			recording = false;
+			folderList.clear();
+			buffer.clear();
+			treeIndex.clear();
+			recordedTrees.clear();
+		}
+
+		// Returns NULL when the file has to be parsed from the xml
+		XmlNode * XmlTreeCache::loadTree(const string &path, const std::map<string, string> &mapTagReplacementValues, bool skipUpdatePathClimbingParts) {
+			MutexSafeWrapper safeMutex(&mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (active == false || recording == true) {
+				return NULL;
+			}
+
+			std::map<string, pair<uint32, uint32> >::const_iterator iterFind = treeIndex.find(path);
+			if (iterFind == treeIndex.end()) {
+				return NULL;
+			}
+
+			uint32 offset = iterFind->second.first;
+			uint32 end = offset + iterFind->second.second;
+			try {
+				return readNode(offset, end, mapTagReplacementValues, skipUpdatePathClimbingParts);
+			} catch (const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s] for [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, ex.what(), path.c_str());
+				treeIndex.erase(path);
+			}
+			return NULL;
+		}
+
+		void XmlTreeCache::recordTree(const string &path, const xml_node<> *rootNode) {
+			MutexSafeWrapper safeMutex(&mutex, string(__FILE__) + "_" + intToStr(__LINE__));
+			if (active == false || recording == false || rootNode == NULL || isCachedPath(path) == false) {
+				return;
+			}
+
+			string &out = recordedTrees[path];
+			out.clear();
+			writeNode(rootNode, out);
+		}
+
+		// ==================== PRIVATE ====================
+
+		bool XmlTreeCache::readCacheFile() {
+			if (fileExists(cacheFile) == false) {
+				return false;
+			}
+
+#ifdef WIN32
+			FILE *fp = _wfopen(utf8_decode(cacheFile).c_str(), L"rb");
+#else
+			FILE *fp = fopen(cacheFile.c_str(), "rb");
+#endif
+			if (fp == NULL) {
+				return false;
+			}
+
+			fseek(fp, 0, SEEK_END);
+			long fileSize = ftell(fp);
+			fseek(fp, 0, SEEK_SET);
+			if (fileSize <= (long) sizeof(cacheFileMagic)) {
+				fclose(fp);
+				return false;
+			}
+			buffer.resize(fileSize);
+			bool readOk = (fread(&buffer[0], 1, fileSize, fp) == (size_t) fileSize);
+			fclose(fp);
+
+			try {
+				if (readOk == false || memcmp(&buffer[0], cacheFileMagic, sizeof(cacheFileMagic)) != 0) {
+					throw game_runtime_error("Xml tree cache has a bad header");
+				}
+
+				uint32 end = (uint32) buffer.size();
+				uint32 offset = sizeof(cacheFileMagic);
+				if (readUInt(buffer, offset, end) != cacheFileVersion ||
+					readUInt(buffer, offset, end) != contentCRC) {
+					buffer.clear();
+					return false;
+				}
+
+				uint32 folderCount = readUInt(buffer, offset, end);
+				if (folderCount != folderList.size()) {
+					buffer.clear();
+					return false;
+				}
+				for (unsigned int index = 0; index < folderCount; ++index) {
+					if (readString(buffer, offset, end) != folderList[index]) {
+						buffer.clear();
+						return false;
+					}
+				}
+
+				uint32 treeCount = readUInt(buffer, offset, end);
+				for (unsigned int index = 0; index < treeCount; ++index) {
+					string path = readString(buffer, offset, end);
+					uint32 size = readUInt(buffer, offset, end);
+					if (end - offset < size) {
+						throw game_runtime_error("Xml tree cache is truncated");
+					}
+					treeIndex[path] = make_pair(offset, size);
+					offset += size;
+				}
+			} catch (const exception &ex) {
+				SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] Error [%s] for [%s]\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, ex.what(), cacheFile.c_str());
+				buffer.clear();
+				treeIndex.clear();
+				return false;
+			}
+			return true;
+		}
+
+		bool XmlTreeCache::isCachedPath(const string &path) {
+			for (unsigned int index = 0; index < folderList.size(); ++index) {
+				if (path.compare(0, folderList[index].size(), folderList[index]) == 0) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Same shape XmlNode builds from rapidxml: elements only, and the
+		// text of leaf elements, all of it before tag replacement
+		void XmlTreeCache::writeNode(const xml_node<> *node, string &out) {
+			uint32 childCount = 0;
+			for (const xml_node<> *currentNode = node->first_node();
+				currentNode; currentNode = currentNode->next_sibling()) {
+				if (currentNode->type() == node_element) {
+					childCount++;
+				}
+			}
+			uint32 attributeCount = 0;
+			for (const xml_attribute<> *attr = node->first_attribute();
+				attr; attr = attr->next_attribute()) {
+				attributeCount++;
+			}
+
+			writeString(out, (node->type() == node_document ? "document" : node->name()));
+			writeUInt(out, childCount);
+			writeUInt(out, attributeCount);
+			if (childCount == 0) {
+				writeString(out, (node->type() == node_element ? node->value() : ""));
+			}
+
+			for (const xml_attribute<> *attr = node->first_attribute();
+				attr; attr = attr->next_attribute()) {
+				writeString(out, attr->name());
+				writeString(out, attr->value());
+			}
+			for (const xml_node<> *currentNode = node->first_node();
+				currentNode; currentNode = currentNode->next_sibling()) {
+				if (currentNode->type() == node_element) {
+					writeNode(currentNode, out);
+				}
+			}
+		}
+
+		XmlNode * XmlTreeCache::readNode(uint32 &offset, uint32 end, const std::map<string, string> &mapTagReplacementValues, bool skipUpdatePathClimbingParts) {
+			XmlNode *node = new XmlNode(readString(buffer, offset, end));
+			try {
+				uint32 childCount = readUInt(buffer, offset, end);
+				uint32 attributeCount = readUInt(buffer, offset, end);
+				if (childCount > end - offset || attributeCount > end - offset) {
+					throw game_runtime_error("Xml tree cache is corrupt");
+				}
+				if (childCount == 0) {
+					string text = readString(buffer, offset, end);
+					Properties::applyTagsToValue(text, &mapTagReplacementValues, skipUpdatePathClimbingParts);
+					node->text = text;
+				}
+
+				node->attributes.reserve(attributeCount);
+				for (unsigned int index = 0; index < attributeCount; ++index) {
+					string name = readString(buffer, offset, end);
+					string value = readString(buffer, offset, end);
+					node->attributes.push_back(new XmlAttribute(name, value, mapTagReplacementValues));
+				}
+
+				node->children.reserve(childCount);
+				for (unsigned int index = 0; index < childCount; ++index) {
+					node->children.push_back(readNode(offset, end, mapTagReplacementValues, skipUpdatePathClimbingParts));
+				}
+			} catch (...) {
+				delete node;
+				throw;
+			}
+			return node;
+		}
+
+	}
+} //end namespace
@@ -19,11 +19,14 @@
 
 #include "data_types.h"
 #include "xml_parser.h"
+#include "xml_cache.h"
+#include "xml_binary.h"
 
 #include <fstream>
 #include <stdexcept>
 #include <vector>
 #include <algorithm>
+#include <set>
 
 #include "conversion.h"
 
@@ -230,6 +233,12 @@ namespace Shared {
 			try {
 				if (SystemFlags::VERBOSE_MODE_ENABLED) printf("XERCES_FULLVERSIONDOT [%s]\nnoValidation = %d\npath [%s]\n", XERCES_FULLVERSIONDOT, noValidation, path.c_str());
 
+				// written by XmlTree::saveBinary, Xerces can't parse it
+				XmlNode *binaryNode = XmlIoBinary::loadFile(path, mapTagReplacementValues);
+				if (binaryNode != NULL) {
+					return binaryNode;
+				}
+
 				DOMNode *domNode = loadDOMNode(path, noValidation);
 				XmlNode *rootNode = new XmlNode(domNode, mapTagReplacementValues);
 				releaseDOMParser();
@@ -347,6 +356,12 @@ namespace Shared {
 			if (SystemFlags::VERBOSE_MODE_ENABLED || showPerfStats) printf("Using RapidXml to load file [%s]\n", path.c_str());
 			//printf("Using RapidXml to load file [%s]\n",path.c_str());
 
+			XmlNode *cachedNode = XmlTreeCache::loadTree(path, mapTagReplacementValues, skipUpdatePathClimbingParts);
+			if (cachedNode != NULL) {
+				if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " I64_SPECIFIER " (from xml tree cache)\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
+				return cachedNode;
+			}
+
 			XmlNode *rootNode = NULL;
 			try {
 
@@ -395,18 +410,24 @@ namespace Shared {
 
 				if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
 
-				// This is required because rapidxml seems to choke when we load lua
-				// scenarios that have lua + xml style comments
-				replaceAllBetweenTokens(buffer, "<!--", "-->", "", true);
+				if (XmlIoBinary::isBinaryData(&buffer.front(), file_size) == true) {
+					// written by XmlTree::saveBinary
+					rootNode = XmlIoBinary::load(&buffer.front(), file_size, mapTagReplacementValues, skipUpdatePathClimbingParts);
+				} else {
+					// This is required because rapidxml seems to choke when we load lua
+					// scenarios that have lua + xml style comments
+					replaceAllBetweenTokens(buffer, "<!--", "-->", "", true);
 
-				if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
+					if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
 
-				xml_document<> doc;
-				doc.parse<parse_no_data_nodes | parse_validate_closing_tags>(&buffer.front());
+					xml_document<> doc;
+					doc.parse<parse_no_data_nodes | parse_validate_closing_tags>(&buffer.front());
 
-				if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
+					if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
 
-				rootNode = new XmlNode(doc.first_node(), mapTagReplacementValues, skipUpdatePathClimbingParts);
+					rootNode = new XmlNode(doc.first_node(), mapTagReplacementValues, skipUpdatePathClimbingParts);
+					XmlTreeCache::recordTree(path, doc.first_node());
+				}
 
 				if (showPerfStats) printf("In [%s::%s Line: %d] took msecs: " I64_SPECIFIER "\n", extractFileFromDirectoryPath(__FILE__).c_str(), __FUNCTION__, __LINE__, chrono.getMillis());
 
@@ -591,6 +612,10 @@ namespace Shared {
 			}
 		}
 
+		void XmlTree::saveBinary(const string &path, int compressionLevel) {
+			XmlIoBinary::save(path, rootNode, compressionLevel);
+		}
+
 		void XmlTree::clearRootNode() {
 			if (this->skipStackCheck == false) {
 				LoadStack &loadStack = CacheManager::getCachedItem<LoadStack>(loadStackCacheName);
@@ -617,6 +642,19 @@ namespace Shared {
 		//	class XmlNode
 		// =====================================================
 
+		// Tag and attribute names come from a small vocabulary which every
+		// node would otherwise carry its own copy of, so they are kept once
+		// for the whole process and nodes only point at them. This runs for
+		// every node and attribute, so the pool has its own lock instead of
+		// going through the CacheManager lookups.
+		static const string * internXmlName(const string &name) {
+			static std::set<string> namePool;
+			static Mutex namePoolMutex(CODE_AT_LINE);
+
+			MutexSafeWrapper safeMutex(&namePoolMutex);
+			return &(*namePool.insert(name).first);
+		}
+
 #if defined(WANT_XERCES)
 
 		XmlNode::XmlNode(DOMNode *node, const std::map<string, string> &mapTagReplacementValues) : superNode(NULL) {
@@ -627,11 +665,11 @@ namespace Shared {
 			//get name
 			char str[strSize] = "";
 			XMLString::transcode(node->getNodeName(), str, strSize - 1);
-			name = str;
+			name = internXmlName(str);
 
 			//check document
 			if (node->getNodeType() == DOMNode::DOCUMENT_NODE) {
-				name = "document";
+				name = internXmlName("document");
 			}
 
 			//check children
@@ -675,16 +713,31 @@ namespace Shared {
 			}
 
 			//get name
-			name = node->name();
-			children.reserve(1000);
-			attributes.reserve(1000);
+			name = internXmlName(node->name());
 
 			//check document
 			if (node->type() == node_document) {
-				name = "document";
+				name = internXmlName("document");
+			}
+
+			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("Found XML Node\nName [%s]\nValue [%s]\n", name->c_str(), node->value());
+
+			// size the lists exactly, techtrees hold many thousands of nodes
+			unsigned int childCount = 0;
+			for (xml_node<> *currentNode = node->first_node();
+				currentNode; currentNode = currentNode->next_sibling()) {
+				if (currentNode->type() == node_element) {
+					childCount++;
+				}
 			}
+			children.reserve(childCount);
 
-			if (SystemFlags::VERBOSE_MODE_ENABLED) printf("Found XML Node\nName [%s]\nValue [%s]\n", name.c_str(), node->value());
+			unsigned int attributeCount = 0;
+			for (xml_attribute<> *attr = node->first_attribute();
+				attr; attr = attr->next_attribute()) {
+				attributeCount++;
+			}
+			attributes.reserve(attributeCount);
 
 			//check children
 			for (xml_node<> *currentNode = node->first_node();
@@ -720,7 +773,7 @@ namespace Shared {
 		}
 
 		XmlNode::XmlNode(const string &name) : superNode(NULL) {
-			this->name = name;
+			this->name = internXmlName(name);
 		}
 
 		XmlNode::~XmlNode() {
@@ -801,7 +854,7 @@ namespace Shared {
 				return superNode->getChild(childName, i);
 			}
 			if (i >= children.size()) {
-				throw game_runtime_error("\"" + name + "\" node doesn't have " + uIntToStr(i + 1) + " children named \"" + childName + "\"\n\nTree: " + getTreeString(), true);
+				throw game_runtime_error("\"" + getName() + "\" node doesn't have " + uIntToStr(i + 1) + " children named \"" + childName + "\"\n\nTree: " + getTreeString(), true);
 			}
 
 			unsigned int count = 0;
@@ -833,7 +886,7 @@ namespace Shared {
 					return superNode->getChild(childName, childIndex);
 				}
 				if (childIndex >= children.size()) {
-					throw game_runtime_error("\"" + name + "\" node doesn't have " + intToStr(childIndex + 1) + " children named \"" + childName + "\"\n\nTree: " + getTreeString(), true);
+					throw game_runtime_error("\"" + getName() + "\" node doesn't have " + intToStr(childIndex + 1) + " children named \"" + childName + "\"\n\nTree: " + getTreeString(), true);
 				}
 
 				unsigned int count = 0;
@@ -901,7 +954,7 @@ namespace Shared {
 
 		DOMElement *XmlNode::buildElement(XERCES_CPP_NAMESPACE_QUALIFIER DOMDocument *document) const {
 			XMLCh str[strSize];
-			XMLString::transcode(name.c_str(), str, strSize - 1);
+			XMLString::transcode(name->c_str(), str, strSize - 1);
 
 			DOMElement *node = document->createElement(str);
 
@@ -925,7 +978,7 @@ namespace Shared {
 #endif
 
 		xml_node<>* XmlNode::buildElement(xml_document<> *document) const {
-			xml_node<>* node = document->allocate_node(node_element, document->allocate_string(name.c_str()));
+			xml_node<>* node = document->allocate_node(node_element, document->allocate_string(name->c_str()));
 
 			for (unsigned int i = 0; i < attributes.size(); ++i) {
 				node->append_attribute(
@@ -971,16 +1024,15 @@ namespace Shared {
 
 			skipRestrictionCheck = false;
 			usesCommondata = false;
-			this->mapTagReplacementValues = mapTagReplacementValues;
 			char str[strSize] = "";
 
 			XMLString::transcode(attribute->getNodeValue(), str, strSize - 1);
 			value = str;
 			usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-			skipRestrictionCheck = Properties::applyTagsToValue(this->value, &this->mapTagReplacementValues);
+			skipRestrictionCheck = Properties::applyTagsToValue(this->value, &mapTagReplacementValues);
 
 			XMLString::transcode(attribute->getNodeName(), str, strSize - 1);
-			name = str;
+			name = internXmlName(str);
 		}
 
 #endif
@@ -992,31 +1044,26 @@ namespace Shared {
 
 			skipRestrictionCheck = false;
 			usesCommondata = false;
-			if (mapTagReplacementValues.size() > 0) {
-				this->mapTagReplacementValues = mapTagReplacementValues;
-			}
 			//char str[strSize]				= "";
 
 			//XMLString::transcode(attribute->getNodeValue(), str, strSize-1);
 			value = attribute->value();
 			usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-			skipRestrictionCheck = Properties::applyTagsToValue(this->value, &this->mapTagReplacementValues);
+			// the tags are only needed here, so the table isn't copied per attribute
+			skipRestrictionCheck = Properties::applyTagsToValue(this->value, &mapTagReplacementValues);
 
 			//XMLString::transcode(attribute->getNodeName(), str, strSize-1);
-			name = attribute->name();
+			name = internXmlName(attribute->name());
 		}
 
 		XmlAttribute::XmlAttribute(const string &name, const string &value, const std::map<string, string> &mapTagReplacementValues) {
 			skipRestrictionCheck = false;
 			usesCommondata = false;
-			if (mapTagReplacementValues.size() > 0) {
-				this->mapTagReplacementValues = mapTagReplacementValues;
-			}
-			this->name = name;
+			this->name = internXmlName(name);
 			this->value = value;
 
 			usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-			skipRestrictionCheck = Properties::applyTagsToValue(this->value, &this->mapTagReplacementValues);
+			skipRestrictionCheck = Properties::applyTagsToValue(this->value, &mapTagReplacementValues);
 		}
 
 		bool XmlAttribute::getBoolValue() const {